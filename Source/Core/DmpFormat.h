@@ -0,0 +1,89 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// DmpFormat.h  –  DefleMask preset (.dmp), FM instruments for the Genesis
+//
+//   [0]  file version (9, 10 or 11 are read; 11 is written)
+//   [1]  system – version 11 only (0x02 Genesis, 0x42 Genesis ext. CH3)
+//   [.]  instrument mode (1 = FM)
+//   [.]  operator count – version 9 only (0 = 2 ops, 1 = 4 ops)
+//   FMS ("LFO"), FB, ALG, AMS ("LFO2")
+//   4 operators in slot order (OP1, OP3, OP2, OP4), 11 bytes each:
+//     MUL, TL, AR, DR, SL, RR, AM, RS, DT (0..6, 3 = none), D2R, SSG-EG
+//
+// Presets carry no name; the file name is used instead.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "PatchCodec.h"
+
+namespace DmpFormat {
+
+static constexpr uint8_t kVersion       = 11;
+static constexpr uint8_t kSystemGenesis = 0x02;
+static constexpr uint8_t kSystemGenExt3 = 0x42;
+static constexpr uint8_t kModeFM        = 1;
+
+inline bool decode(const uint8_t* data, size_t size, PatchData& out)
+{
+    if (data == nullptr || size < 1) return false;
+
+    const uint8_t version = data[0];
+    if (version < 9 || version > kVersion) return false;
+
+    size_t pos = 1;
+    if (version >= 11) {
+        if (size <= pos) return false;
+        const uint8_t system = data[pos++];
+        if (system != kSystemGenesis && system != kSystemGenExt3) return false;
+    }
+    if (size <= pos || data[pos++] != kModeFM) return false;
+    if (version == 9) {
+        if (size <= pos || data[pos++] != 1) return false;   // 2-op presets are not OPN2
+    }
+
+    if (size != pos + 4 + 4 * 11) return false;
+
+    out = PatchData();
+    out.patch.FMS = data[pos + 0] & 7;
+    out.patch.FB  = data[pos + 1] & 7;
+    out.patch.ALG = data[pos + 2] & 7;
+    out.patch.AMS = data[pos + 3] & 3;
+    pos += 4;
+
+    for (int slot = 0; slot < 4; ++slot, pos += 11) {
+        const uint8_t* p = data + pos;
+        auto& o = out.patch.op[PatchCodecs::kSlotToUi[slot]];
+        o.MUL = p[0] & 0x0F;
+        o.TL  = p[1] & 0x7F;
+        o.AR  = p[2] & 0x1F;
+        o.DR  = p[3] & 0x1F;
+        o.SL  = p[4] & 0x0F;
+        o.RR  = p[5] & 0x0F;
+        o.AM  = p[6] ? 1 : 0;
+        o.RS  = p[7] & 3;
+        o.DT  = PatchCodecs::dtFromCentred(p[8]);   // high nibble is DT2 (OPM only)
+        o.SR  = p[9] & 0x1F;
+        o.SSG = PatchCodecs::ssgFromRegister(p[10]);
+    }
+    return true;
+}
+
+inline std::vector<uint8_t> encode(const PatchData& in)
+{
+    std::vector<uint8_t> out = { kVersion, kSystemGenesis, kModeFM,
+                                 uint8_t(in.patch.FMS & 7), uint8_t(in.patch.FB & 7),
+                                 uint8_t(in.patch.ALG & 7), uint8_t(in.patch.AMS & 3) };
+    for (int slot = 0; slot < 4; ++slot) {
+        const auto& o = in.patch.op[PatchCodecs::kSlotToUi[slot]];
+        const uint8_t op[11] = {
+            uint8_t(o.MUL & 0x0F), uint8_t(o.TL & 0x7F), uint8_t(o.AR & 0x1F), uint8_t(o.DR & 0x1F),
+            uint8_t(o.SL & 0x0F),  uint8_t(o.RR & 0x0F), uint8_t(o.AM ? 1 : 0), uint8_t(o.RS & 3),
+            uint8_t(PatchCodecs::dtToCentred(o.DT)), uint8_t(o.SR & 0x1F),
+            uint8_t(PatchCodecs::ssgToRegister(o.SSG))
+        };
+        out.insert(out.end(), op, op + 11);
+    }
+    return out;
+}
+
+} // namespace DmpFormat
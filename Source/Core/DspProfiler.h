@@ -0,0 +1,191 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+ #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+ #include <x86intrin.h>
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+// DspProfiler.h  –  per-stage cycle counts for processBlock
+//
+// Built only with ARM2612_PROFILE=1 (CMake: -DARM2612_PROFILE=ON). Without
+// it the ARM2612_PROFILE_* macros expand to nothing and the engine has no
+// timing code at all.
+//
+// The audio thread adds raw tick counts per stage during a block and
+// endBlock() drops each stage's total into a log-scale histogram of atomic
+// counters – no locks, no allocation. Readers take a Snapshot and diff it
+// against the previous one to get percentiles for just that interval, so
+// the audio thread never sees a reset.
+//
+// Ticks are the CPU timestamp counter (x86 TSC, ARM generic timer) or
+// steady_clock elsewhere; readers calibrate ticks → seconds from the wall
+// clock since construction.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#ifndef ARM2612_PROFILE
+ #define ARM2612_PROFILE 0
+#endif
+
+class DspProfiler
+{
+public:
+    enum Stage { params, chip, resample, scope, total, numStages };
+
+    static const char* stageName(int s)
+    {
+        static constexpr const char* names[numStages] = { "Params", "Chip", "Resample", "Scope", "Total" };
+        return names[s];
+    }
+
+    static uint64_t ticks()
+    {
+       #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+       #elif defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+       #elif defined(__aarch64__)
+        uint64_t v;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+        return v;
+       #else
+        return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+       #endif
+    }
+
+    // 8 buckets per octave: bucket upper bounds grow by ~9 %
+    static constexpr int kSubBits    = 3;
+    static constexpr int kNumBuckets = 64 << kSubBits;
+
+    static int bucketOf(uint64_t t)
+    {
+        if (t < (1u << kSubBits)) return int(t);
+        int msb = 63;
+        while ((t >> msb) == 0) --msb;
+        const int sub = int(t >> (msb - kSubBits)) & ((1 << kSubBits) - 1);
+        return ((msb - kSubBits + 1) << kSubBits) + sub;
+    }
+
+    // Smallest tick count that falls in bucket b
+    static uint64_t bucketFloor(int b)
+    {
+        if (b < (1 << kSubBits)) return uint64_t(b);
+        const int octave = (b >> kSubBits) - 1 + kSubBits;
+        const int sub    = b & ((1 << kSubBits) - 1);
+        return (uint64_t(1) << octave) + (uint64_t(sub) << (octave - kSubBits));
+    }
+
+    DspProfiler()
+        : m_startTicks(ticks()), m_startTime(std::chrono::steady_clock::now()) {}
+
+    // ── Audio thread ─────────────────────────────────────────────────────────
+    void add(Stage s, uint64_t t) { m_block[s] += t; }
+
+    void endBlock(int numSamples, double sampleRate)
+    {
+        for (int s = 0; s < numStages; ++s) {
+            m_hist[s][bucketOf(m_block[s])].fetch_add(1, std::memory_order_relaxed);
+            uint64_t prev = m_max[s].load(std::memory_order_relaxed);
+            while (m_block[s] > prev && !m_max[s].compare_exchange_weak(prev, m_block[s], std::memory_order_relaxed)) {}
+            m_block[s] = 0;
+        }
+        m_blockSamples.store(numSamples, std::memory_order_relaxed);
+        m_sampleRate.store(sampleRate, std::memory_order_relaxed);
+    }
+
+    // ── Reader thread ────────────────────────────────────────────────────────
+    struct Snapshot {
+        std::array<std::array<uint32_t, kNumBuckets>, numStages> hist {};
+    };
+
+    struct StageStats {
+        uint64_t blocks = 0;
+        double   p50Us = 0.0, p99Us = 0.0, maxUs = 0.0;
+    };
+
+    struct Report {
+        StageStats stage[numStages];
+        double     blockUs = 0.0;     // real-time budget per block
+        double     loadP50 = 0.0;     // total / budget
+        double     loadP99 = 0.0;
+        double     loadMax = 0.0;
+    };
+
+    // Stats for the blocks since `previous` was taken; updates `previous`.
+    // The per-stage max is since the last call.
+    Report collect(Snapshot& previous)
+    {
+        Report r;
+        const double tps = ticksPerSecond();
+        if (tps <= 0.0) return r;
+        const double usPerTick = 1.0e6 / tps;
+
+        for (int s = 0; s < numStages; ++s) {
+            uint32_t diff[kNumBuckets];
+            uint64_t n = 0;
+            for (int b = 0; b < kNumBuckets; ++b) {
+                const uint32_t now = m_hist[s][b].load(std::memory_order_relaxed);
+                diff[b] = now - previous.hist[s][b];
+                previous.hist[s][b] = now;
+                n += diff[b];
+            }
+            auto& st = r.stage[s];
+            st.blocks = n;
+            st.maxUs  = double(m_max[s].exchange(0, std::memory_order_relaxed)) * usPerTick;
+            if (n == 0) continue;
+
+            auto percentile = [&](double p) {
+                const uint64_t rank = uint64_t(p * double(n - 1));
+                uint64_t seen = 0;
+                for (int b = 0; b < kNumBuckets; ++b)
+                    if ((seen += diff[b]) > rank) return double(bucketFloor(b)) * usPerTick;
+                return 0.0;
+            };
+            st.p50Us = percentile(0.50);
+            st.p99Us = percentile(0.99);
+        }
+
+        const double rate = m_sampleRate.load(std::memory_order_relaxed);
+        if (rate > 0.0) {
+            r.blockUs = 1.0e6 * m_blockSamples.load(std::memory_order_relaxed) / rate;
+            r.loadP50 = r.stage[total].p50Us / r.blockUs;
+            r.loadP99 = r.stage[total].p99Us / r.blockUs;
+            r.loadMax = r.stage[total].maxUs / r.blockUs;
+        }
+        return r;
+    }
+
+    double ticksPerSecond() const
+    {
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+        return secs > 0.0 ? double(ticks() - m_startTicks) / secs : 0.0;
+    }
+
+private:
+    uint64_t m_block[numStages] {};   // audio thread only
+
+    std::atomic<uint32_t> m_hist[numStages][kNumBuckets] {};
+    std::atomic<uint64_t> m_max[numStages] {};
+    std::atomic<int>      m_blockSamples { 0 };
+    std::atomic<double>   m_sampleRate   { 0.0 };
+
+    const uint64_t                              m_startTicks;
+    const std::chrono::steady_clock::time_point m_startTime;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Stage timing helpers – compiled out unless ARM2612_PROFILE
+// ─────────────────────────────────────────────────────────────────────────────
+#if ARM2612_PROFILE
+ #define ARM2612_PROFILE_BEGIN(var)              const uint64_t var = DspProfiler::ticks()
+ #define ARM2612_PROFILE_END(profiler, stage, var) (profiler).add(DspProfiler::stage, DspProfiler::ticks() - (var))
+#else
+ #define ARM2612_PROFILE_BEGIN(var)              ((void) 0)
+ #define ARM2612_PROFILE_END(profiler, stage, var) ((void) 0)
+#endif
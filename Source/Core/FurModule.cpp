@@ -0,0 +1,211 @@
+#include "FurModule.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "FurnaceFormat.h"
+
+#if ARM2612_HAVE_ZLIB
+ #include <zlib.h>
+#endif
+
+namespace {
+
+constexpr char     kMagic[]        = "-Furnace module-";
+constexpr size_t   kMagicSize      = sizeof(kMagic) - 1;
+constexpr size_t   kHeaderSize     = 32;
+constexpr uint16_t kFirstIns2      = 127;          // first format version with INS2 blocks
+constexpr uint32_t kMaxInstrument  = 1u << 20;     // larger INS2 blocks are skipped
+
+uint32_t readU32(const uint8_t* p)
+{
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+void writeU32(std::vector<uint8_t>& out, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) out.push_back(uint8_t(v >> (8 * i)));
+}
+
+bool isBlockId(const uint8_t* id)
+{
+    for (int i = 0; i < 4; ++i)
+        if (!((id[i] >= 'A' && id[i] <= 'Z') || (id[i] >= '0' && id[i] <= '9'))) return false;
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Sequential reader over the module: the input bytes as they are, or
+//  inflated on demand. Reads are all-or-nothing.
+// ─────────────────────────────────────────────────────────────────────────────
+class ModuleStream
+{
+public:
+    ModuleStream(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    ~ModuleStream()
+    {
+#if ARM2612_HAVE_ZLIB
+        if (m_inflating) inflateEnd(&m_zs);
+#endif
+    }
+
+    ModuleStream(const ModuleStream&)            = delete;
+    ModuleStream& operator=(const ModuleStream&) = delete;
+
+    // A zlib header: CM = 8 (deflate) and a valid check value
+    static bool isZlib(const uint8_t* data, size_t size)
+    {
+        return size >= 2 && (data[0] & 0x0F) == 8 && ((data[0] << 8) | data[1]) % 31 == 0;
+    }
+
+    bool startInflate()
+    {
+#if ARM2612_HAVE_ZLIB
+        m_zs          = z_stream {};
+        m_zs.next_in  = const_cast<Bytef*>(m_data);
+        m_zs.avail_in = uInt(std::min<size_t>(m_size, 0xFFFFFFFFu));
+        m_inflating   = inflateInit(&m_zs) == Z_OK;
+        return m_inflating;
+#else
+        return false;
+#endif
+    }
+
+    bool read(uint8_t* dst, size_t n)
+    {
+#if ARM2612_HAVE_ZLIB
+        if (m_inflating) {
+            m_zs.next_out  = dst;
+            m_zs.avail_out = uInt(n);
+            while (m_zs.avail_out > 0 && !m_end) {
+                const int rc = inflate(&m_zs, Z_NO_FLUSH);
+                if (rc != Z_OK) m_end = true;   // stream end, corrupt data or truncated input
+            }
+            return m_zs.avail_out == 0;
+        }
+#endif
+        if (m_size - m_pos < n) return false;
+        std::memcpy(dst, m_data + m_pos, n);
+        m_pos += n;
+        return true;
+    }
+
+    bool skip(size_t n)
+    {
+#if ARM2612_HAVE_ZLIB
+        if (m_inflating) {
+            while (n > 0) {
+                const size_t chunk = std::min(n, sizeof(m_window));
+                if (!read(m_window, chunk)) return false;
+                n -= chunk;
+            }
+            return true;
+        }
+#endif
+        if (m_size - m_pos < n) return false;
+        m_pos += n;
+        return true;
+    }
+
+private:
+    const uint8_t* m_data;
+    size_t         m_size;
+    size_t         m_pos = 0;
+#if ARM2612_HAVE_ZLIB
+    z_stream       m_zs {};
+    bool           m_inflating = false;
+    bool           m_end       = false;
+    uint8_t        m_window[16 * 1024];   // skipped bytes are inflated into this
+#endif
+};
+
+} // namespace
+
+namespace FurModule {
+
+int decode(const uint8_t* data, size_t size, const VoiceCallback& onVoice)
+{
+    if (data == nullptr || size < 2) return -1;
+
+    ModuleStream in(data, size);
+    const bool stored = size >= kMagicSize && std::memcmp(data, kMagic, kMagicSize) == 0;
+    if (!stored && !(ModuleStream::isZlib(data, size) && in.startInflate())) return -1;
+
+    uint8_t header[kHeaderSize];
+    if (!in.read(header, kHeaderSize) || std::memcmp(header, kMagic, kMagicSize) != 0) return -1;
+
+    const uint16_t version  = uint16_t(header[16] | header[17] << 8);
+    const uint32_t songInfo = readU32(header + 20);
+    if (version < kFirstIns2 || songInfo < kHeaderSize) return -1;
+    if (!in.skip(songInfo - kHeaderSize)) return -1;
+
+    // Block by block until the end of the module or anything that is not a
+    // block header. Only the current INS2 block is ever held in memory.
+    std::vector<uint8_t> block;
+    PatchData voice;
+    int voices = 0;
+    uint8_t blockHeader[8];
+    while (in.read(blockHeader, sizeof(blockHeader)) && isBlockId(blockHeader)) {
+        const uint32_t blockSize = readU32(blockHeader + 4);
+        if (std::memcmp(blockHeader, "INS2", 4) != 0 || blockSize > kMaxInstrument) {
+            if (!in.skip(blockSize)) break;
+            continue;
+        }
+
+        block.resize(sizeof(blockHeader) + blockSize);
+        std::memcpy(block.data(), blockHeader, sizeof(blockHeader));
+        if (!in.read(block.data() + sizeof(blockHeader), blockSize)) break;
+
+        // As with .fui, the block byte is not the octave offset
+        FurnaceFormat::Instrument ins;
+        if (!FurnaceFormat::parseIns2(block.data(), block.size(), ins)) continue;
+        voice = PatchData();
+        voice.name   = std::move(ins.name);
+        voice.patch  = FurnaceFormat::toPatch(ins);
+        voice.macros = std::move(ins.macroFeatures);
+
+        ++voices;
+        if (!onVoice(voice)) break;
+    }
+    return voices;
+}
+
+std::vector<uint8_t> writeSkeleton(const std::vector<PatchData>& voices, bool compressed)
+{
+    std::vector<uint8_t> out(kMagic, kMagic + kMagicSize);
+    out.push_back(uint8_t(FurnaceFormat::ENG_VER));
+    out.push_back(uint8_t(FurnaceFormat::ENG_VER >> 8));
+    out.insert(out.end(), 2, uint8_t(0));
+    writeU32(out, uint32_t(kHeaderSize));
+    out.insert(out.end(), 8, uint8_t(0));
+
+    out.insert(out.end(), { 'I', 'N', 'F', 'O' });
+    writeU32(out, 0);
+
+    // An INS2 block is a .fui with "INS2" and the block size for "FINS"
+    for (const auto& v : voices) {
+        auto ins = FurnaceFormat::fromPatch(v.patch, v.name);
+        ins.macroFeatures = v.macros;
+        const auto fui = FurnaceFormat::encodeFui(ins);
+        out.insert(out.end(), { 'I', 'N', 'S', '2' });
+        writeU32(out, uint32_t(fui.size() - 4));
+        out.insert(out.end(), fui.begin() + 4, fui.end());
+    }
+
+#if ARM2612_HAVE_ZLIB
+    if (compressed) {
+        uLongf packedSize = compressBound(uLong(out.size()));
+        std::vector<uint8_t> packed(packedSize);
+        if (compress2(packed.data(), &packedSize, out.data(), uLong(out.size()), Z_DEFAULT_COMPRESSION) == Z_OK) {
+            packed.resize(packedSize);
+            return packed;
+        }
+    }
+#else
+    (void) compressed;
+#endif
+    return out;
+}
+
+} // namespace FurModule
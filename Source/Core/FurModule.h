@@ -0,0 +1,42 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// FurModule.h  –  OPN2 FM instruments out of a Furnace module (.fur)
+//
+// A .fur is a zlib stream (or, rarely, stored uncompressed) holding:
+//
+//   [0]   16B  "-Furnace module-"
+//   [16]  2B   uint16 format version
+//   [18]  2B   reserved
+//   [20]  4B   uint32 offset of the song info block
+//   [24]  8B   reserved
+//   blocks, each a 4-character ID and a uint32 size, then the payload:
+//     INFO / INF2 (song info), SONG, ADIR, INS2, WAVE, SMP2, PATN, ...
+//
+// decode() inflates the module through a fixed window and walks the block
+// chain from the song info block on. Only INS2 blocks are kept, one at a
+// time; everything else – patterns and samples included – is inflated into
+// the window and dropped. INS2 blocks are parsed by FurnaceFormat::parseIns2
+// (the .fui feature blocks), and every FM (OPN) instrument is handed on as a
+// voice. Other instrument types are skipped.
+//
+// Modules older than format 127 store instruments as INST blocks and are not
+// read. Compressed modules need zlib (ARM2612_HAVE_ZLIB); without it only
+// uncompressed ones are read. No .fur writer – modules are read-only here.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "PatchCodec.h"
+
+namespace FurModule {
+
+// Every FM instrument, in module order. Returns the number of voices handed
+// on (0 for a module without FM instruments), or -1 if this is not a module
+// that can be read.
+int decode(const uint8_t* data, size_t size, const VoiceCallback& onVoice);
+
+// A module skeleton – header, empty INFO block, one INS2 block per voice –
+// that decode() reads back. Furnace does not open it; the codec tools use it
+// as input. compressed needs zlib and is ignored without it.
+std::vector<uint8_t> writeSkeleton(const std::vector<PatchData>& voices, bool compressed);
+
+} // namespace FurModule
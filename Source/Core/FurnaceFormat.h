@@ -37,10 +37,23 @@
 //     Byte+7: (dam&7)<<5 | (dt2&3)<<3 | (ws&7)
 //
 // ssgEnv bits 3..0: bit3=enable, bits2..0=mode
+//
+// Features "MA" (macros) and "O1".."O4" (operator macros) are kept verbatim
+// in Instrument::macroFeatures and written back unchanged; MacroProgram.h
+// compiles them for playback. All other features are skipped.
+//
+// Pure byte codec with no JUCE dependency; registered in PatchCodec.cpp,
+// file I/O lives in PatchFile.h. Instruments inside .fur modules use the
+// same feature blocks (parseIns2, read by FurModule.h).
 // ─────────────────────────────────────────────────────────────────────────────
 
-#include <juce_core/juce_core.h>
+#include <cstdint>
 #include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "BuiltInPatches.h"
 
 namespace FurnaceFormat {
 
@@ -55,10 +68,11 @@ struct Op {
 };
 
 struct Instrument {
-    juce::String name;
+    std::string name;
     uint8_t alg=0, fb=0, fms=0, ams=0, fms2=0, ams2=0;
     uint8_t ops=4, opllPreset=0, block=0;
     Op op[4];
+    std::vector<uint8_t> macroFeatures;   // MA / O1-O4 feature blocks, header included
 };
 
 // ─── tiny cursor ─────────────────────────────────────────────────────────────
@@ -72,27 +86,14 @@ struct Cur {
 };
 
 // ─────────────────────────────────────────────────────────────────────────────
-inline bool readFui(const juce::File& file, Instrument& ins)
+// Feature blocks from c up to "EN" or the end – shared by .fui files and the
+// INS2 blocks of .fur modules. Returns true if an FM block was found.
+inline bool parseFeatures(Cur c, uint16_t version, Instrument& ins)
 {
-    if (!file.existsAsFile()) return false;
-    juce::FileInputStream fs(file);
-    if (!fs.openedOk()) return false;
-    juce::MemoryOutputStream mb;
-    mb.writeFromInputStream(fs, file.getSize()+16);
-
-    const uint8_t* data = static_cast<const uint8_t*>(mb.getData());
-    size_t         size = mb.getDataSize();
-    if (size < 8 || memcmp(data,"FINS",4)!=0) return false;
-
-    Cur c { data+4, data+size };
-    uint16_t version = c.u16();
-    uint8_t  type    = c.u8();
-    /* reserved */     c.u8();
-    if (type != INS_FM) return false;
-
     bool gotFM = false;
 
     while (c.ok(2)) {
+        const uint8_t* feature = c.p;
         char id0=char(c.u8()), id1=char(c.u8());
         if (id0=='E'&&id1=='N') break;
         if (!c.ok(2)) break;
@@ -107,8 +108,7 @@ inline bool readFui(const juce::File& file, Instrument& ins)
             //   uint16 LE length, then UTF-8 bytes (no null terminator)
             uint16_t slen = c.u16();
             if (slen > 0 && c.ok(slen))
-                ins.name = juce::String::fromUTF8(
-                    reinterpret_cast<const char*>(c.p), slen);
+                ins.name.assign(reinterpret_cast<const char*>(c.p), slen);
         }
 
         // ── FM ──────────────────────────────────────────────────────────────
@@ -142,7 +142,7 @@ inline bool readFui(const juce::File& file, Instrument& ins)
             if (version >= 224) ins.block = c.u8()&15;
 
             // Operators – 8 bytes each
-            int n = juce::jlimit(0,4,opCount);
+            int n = std::clamp(opCount,0,4);
             for (int i=0; i<n; i++) {
                 if (fend-c.p < 8) break;
                 Op& op = ins.op[i];
@@ -187,38 +187,73 @@ inline bool readFui(const juce::File& file, Instrument& ins)
             gotFM = true;
         }
 
+        // ── MA, O1-O4 ───────────────────────────────────────────────────────
+        // Only whole blocks: a cut one would swallow what follows it when
+        // written back
+        else if ((id0=='M'&&id1=='A') || (id0=='O'&&id1>='1'&&id1<='4')) {
+            if (fend == fstart+flen)
+                ins.macroFeatures.insert(ins.macroFeatures.end(), feature, fend);
+        }
+
         c.seek(fend);
     }
     return gotFM;
 }
 
+inline bool parseFui(const uint8_t* data, size_t size, Instrument& ins)
+{
+    if (data == nullptr || size < 8 || memcmp(data,"FINS",4)!=0) return false;
+
+    Cur c { data+4, data+size };
+    uint16_t version = c.u16();
+    uint8_t  type    = c.u8();
+    /* reserved */     c.u8();
+    if (type != INS_FM) return false;
+
+    return parseFeatures(c, version, ins);
+}
+
+// An INS2 block from a .fur module: "INS2", uint32 block size, uint16
+// version, uint16 type, then the same feature blocks as a .fui
+inline bool parseIns2(const uint8_t* data, size_t size, Instrument& ins)
+{
+    if (data == nullptr || size < 12 || memcmp(data,"INS2",4)!=0) return false;
+
+    Cur c { data+8, data+size };
+    uint16_t version = c.u16();
+    uint16_t type    = c.u16();
+    if (type != INS_FM) return false;
+
+    return parseFeatures(c, version, ins);
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
-inline bool writeFui(const juce::File& file, const Instrument& ins)
+inline std::vector<uint8_t> encodeFui(const Instrument& ins)
 {
-    juce::MemoryOutputStream out;
-    auto w8  = [&](uint8_t  v){ out.writeByte(char(v)); };
-    auto w16 = [&](uint16_t v){ w8(v&0xFF); w8(uint8_t(v>>8)); };
+    std::vector<uint8_t> out;
+    auto w8    = [&](uint8_t  v){ out.push_back(v); };
+    auto w16   = [&](uint16_t v){ w8(v&0xFF); w8(uint8_t(v>>8)); };
+    auto write = [&](const char* s, size_t n){ out.insert(out.end(), s, s+n); };
 
     // Header
-    out.write("FINS",4);
+    write("FINS",4);
     w16(ENG_VER);
     w8(INS_FM);
     w8(0);
 
     // Feature NA – SafeWriter::writeString(name,false) = uint16 len + bytes
     {
-        auto utf8 = ins.name.toUTF8();
-        uint16_t slen = uint16_t(strlen(utf8));
-        out.write("NA",2); w16(uint16_t(slen+2));  // featLen includes the 2-byte length field
+        uint16_t slen = uint16_t(std::min<size_t>(ins.name.size(), 0xFFFD));
+        write("NA",2); w16(uint16_t(slen+2));  // featLen includes the 2-byte length field
         w16(slen);
-        out.write(utf8, slen);
+        write(ins.name.data(), slen);
     }
 
     // Feature FM
-    int opCount = juce::jlimit(0,4,int(ins.ops));
+    int opCount = std::clamp(int(ins.ops),0,4);
     // featLen = 5 header bytes + opCount*8 op bytes
     uint16_t fmLen = uint16_t(5 + opCount*8);
-    out.write("FM",2); w16(fmLen);
+    write("FM",2); w16(fmLen);
 
     // Byte 0: op enable + opCount
     uint8_t b0 = uint8_t(opCount & 15);
@@ -253,10 +288,76 @@ inline bool writeFui(const juce::File& file, const Instrument& ins)
         w8(uint8_t(((op.dam&7)<<5)|((op.dt2&3)<<3)|(op.ws&7)));
     }
 
+    // Macro features, as read
+    out.insert(out.end(), ins.macroFeatures.begin(), ins.macroFeatures.end());
+
     // End marker
-    out.write("EN",2);
+    write("EN",2);
 
-    return file.replaceWithData(out.getData(), out.getDataSize());
+    return out;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Instrument → YM2612Patch (UI units):
+//   Furnace stores operators in slot order [OP1, OP3, OP2, OP4]
+//   DT chip(0-7) → UI chip-3, clamped to -3..+3
+//   SSG bit3 = enable, bits2:0 = mode → 0 = off, 1-8 = modes 0-7
+// ─────────────────────────────────────────────────────────────────────────────
+inline YM2612Patch toPatch(const Instrument& ins)
+{
+    YM2612Patch patch {};
+    patch.ALG = ins.alg & 7;
+    patch.FB  = ins.fb  & 7;
+    patch.AMS = ins.ams & 3;
+    patch.FMS = ins.fms & 7;
+
+    const int slotMap[4] = { 0, 2, 1, 3 };  // UI op index → Furnace slot
+    for (int uiOp = 0; uiOp < 4; uiOp++) {
+        const Op& fop = ins.op[slotMap[uiOp]];
+        YM2612Operator& o = patch.op[uiOp];
+        o.TL  = fop.tl;
+        o.AR  = fop.ar;
+        o.DR  = fop.dr;
+        o.SR  = fop.d2r;
+        o.SL  = fop.sl;
+        o.RR  = fop.rr;
+        o.MUL = fop.mult;
+        o.RS  = fop.rs;
+        o.DT  = std::clamp((fop.dt & 7) - 3, -3, 3);
+        o.AM  = fop.am != 0 ? 1 : 0;
+        o.SSG = (fop.ssgEnv & 0x08) ? (fop.ssgEnv & 0x07) + 1 : 0;
+    }
+    return patch;
+}
+
+// YM2612Patch (UI units) → Instrument, the inverse of toPatch(). Fields the
+// plugin has no parameter for are written with Furnace's defaults.
+inline Instrument fromPatch(const YM2612Patch& patch, const std::string& name)
+{
+    Instrument ins;
+    ins.name = name;
+    ins.alg  = uint8_t(patch.ALG & 7);
+    ins.fb   = uint8_t(patch.FB  & 7);
+    ins.ams  = uint8_t(patch.AMS & 3);
+    ins.fms  = uint8_t(patch.FMS & 7);
+
+    const int slotMap[4] = { 0, 2, 1, 3 };  // UI op index → Furnace slot
+    for (int uiOp = 0; uiOp < 4; uiOp++) {
+        const YM2612Operator& o = patch.op[uiOp];
+        Op& fop = ins.op[slotMap[uiOp]];
+        fop.tl     = uint8_t(o.TL  & 127);
+        fop.ar     = uint8_t(o.AR  & 31);
+        fop.dr     = uint8_t(o.DR  & 31);
+        fop.d2r    = uint8_t(o.SR  & 31);
+        fop.sl     = uint8_t(o.SL  & 15);
+        fop.rr     = uint8_t(o.RR  & 15);
+        fop.mult   = uint8_t(o.MUL & 15);
+        fop.rs     = uint8_t(o.RS  & 3);
+        fop.dt     = uint8_t((std::clamp(o.DT, -3, 3) + 3) & 7);
+        fop.am     = o.AM != 0 ? 1 : 0;
+        fop.ssgEnv = o.SSG > 0 ? uint8_t(0x08 | ((o.SSG - 1) & 7)) : 0;
+    }
+    return ins;
 }
 
 } // namespace FurnaceFormat
@@ -0,0 +1,129 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// GybBank.h  –  GYBank binary bank (.gyb), versions 1 and 2
+//
+//   [0]    2 bytes  signature 26, 12
+//   [2]    1 byte   version
+//   [3]    1 byte   melody instrument count M
+//   [4]    1 byte   drum instrument count D
+//   [5]    GM map   128 melody + 128 drum entries, 1 byte each (v1) or
+//                   2 bytes each (v2)
+//   [.]    1 byte   LFO register 0x22 (v2 only), shared by the whole bank
+//   [.]    (M + D) instruments, 30 bytes (v1) or 32 bytes (v2):
+//            4 operators in slot order (OP1, OP3, OP2, OP4),
+//            registers 0x30, 0x40, 0x50, 0x60, 0x70, 0x80, 0x90
+//            register 0xB0 (FB << 3 | ALG), register 0xB4 (AMS << 4 | FMS)
+//            v2: transpose (int8 semitones), 1 byte padding
+//   [.]    (M + D) names, each a length byte and that many characters
+//   [.]    optional 4-byte checksum (not checked)
+//
+// Melody instruments come first, then drums. Instruments and names are read
+// with two cursors in step, so nothing is buffered. Version 3 banks (a
+// different, chunked layout) are not read. The writer emits version 2
+// without a checksum.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "PatchCodec.h"
+
+namespace GybBank {
+
+static constexpr uint8_t kSignature[2] = { 26, 12 };
+static constexpr int     kMaxPerKind   = 255;
+
+inline size_t instrumentSize(int version) { return version == 1 ? 30 : 32; }
+inline size_t mapSize(int version)        { return version == 1 ? 256 : 512; }
+
+inline int decode(const uint8_t* data, size_t size, const VoiceCallback& onVoice)
+{
+    if (data == nullptr || size < 5 || data[0] != kSignature[0] || data[1] != kSignature[1]) return -1;
+
+    const int version = data[2];
+    if (version != 1 && version != 2) return -1;
+
+    const int count = data[3] + data[4];
+    size_t pos = 5 + mapSize(version);
+    if (version == 2) ++pos;
+    if (size < pos) return -1;
+
+    int lfoEnable = 0, lfoFreq = 0;
+    if (version == 2) {
+        const uint8_t lfo = data[pos - 1];
+        lfoEnable = (lfo & 0x08) ? 1 : 0;
+        lfoFreq   = lfoEnable ? std::min(lfo & 7, 6) + 1 : 0;   // index 7 = chip 6
+    }
+
+    // Validate the whole layout before handing out the first voice, so a
+    // truncated bank is rejected rather than imported halfway
+    const size_t insBytes = instrumentSize(version) * size_t(count);
+    if (size - pos < insBytes) return -1;
+    size_t namePos = pos + insBytes;
+    for (int i = 0; i < count; ++i) {
+        if (namePos >= size || size - namePos - 1 < data[namePos]) return -1;
+        namePos += 1 + data[namePos];
+    }
+    if (size - namePos != 0 && size - namePos != 4) return -1;
+
+    PatchData voice;
+    namePos = pos + insBytes;
+    for (int i = 0; i < count; ++i) {
+        const uint8_t* p = data + pos + instrumentSize(version) * size_t(i);
+        voice = PatchData();
+        for (int slot = 0; slot < 4; ++slot)
+            PatchCodecs::opFromRegisters(p + slot * 7, voice.patch.op[PatchCodecs::kSlotToUi[slot]]);
+        voice.patch.ALG = p[28] & 7;
+        voice.patch.FB  = (p[28] >> 3) & 7;
+        voice.patch.AMS = (p[29] >> 4) & 3;
+        voice.patch.FMS = p[29] & 7;
+        if (version == 2)
+            voice.block = PatchCodecs::blockFromTranspose(int8_t(p[30]));
+        voice.lfoEnable = lfoEnable;
+        voice.lfoFreq   = lfoFreq;
+
+        const uint8_t length = data[namePos];
+        voice.name.assign(reinterpret_cast<const char*>(data + namePos + 1), length);
+        namePos += 1 + length;
+
+        if (!onVoice(voice)) return i + 1;
+    }
+    return count;
+}
+
+// Up to 255 voices go in as melody instruments, the next 255 as drums; the
+// bank's LFO is the first voice's
+inline std::vector<uint8_t> encode(const std::vector<PatchData>& voices)
+{
+    const int count  = int(std::min(voices.size(), size_t(2 * kMaxPerKind)));
+    const int melody = std::min(count, kMaxPerKind);
+    const int drums  = count - melody;
+
+    std::vector<uint8_t> out = { kSignature[0], kSignature[1], 2, uint8_t(melody), uint8_t(drums) };
+    for (int program = 0; program < 128; ++program) {
+        out.push_back(program < melody ? uint8_t(program) : 0xFF);
+        out.push_back(0);
+    }
+    out.insert(out.end(), 256, uint8_t(0xFF));   // no drum key mapping
+
+    const auto* first = voices.empty() ? nullptr : &voices.front();
+    out.push_back(first != nullptr && first->lfoFreq > 0 ? uint8_t(0x08 | ((first->lfoFreq - 1) & 7)) : 0);
+
+    for (int i = 0; i < count; ++i) {
+        const auto& d = voices[size_t(i)];
+        uint8_t ins[32] = {};
+        for (int slot = 0; slot < 4; ++slot)
+            PatchCodecs::opToRegisters(d.patch.op[PatchCodecs::kSlotToUi[slot]], ins + slot * 7);
+        ins[28] = uint8_t(((d.patch.FB & 7) << 3) | (d.patch.ALG & 7));
+        ins[29] = uint8_t(((d.patch.AMS & 3) << 4) | (d.patch.FMS & 7));
+        ins[30] = uint8_t(int8_t(std::clamp(d.block, -2, 2) * 12));
+        out.insert(out.end(), ins, ins + 32);
+    }
+    for (int i = 0; i < count; ++i) {
+        const auto& name = voices[size_t(i)].name;
+        const auto length = std::min(name.size(), size_t(255));
+        out.push_back(uint8_t(length));
+        out.insert(out.end(), name.begin(), name.begin() + std::ptrdiff_t(length));
+    }
+    return out;
+}
+
+} // namespace GybBank
@@ -0,0 +1,239 @@
+#include "MacroProgram.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "FurnaceFormat.h"
+#include "PatchCodec.h"
+
+namespace {
+
+using Target = MacroProgram::Target;
+
+// Furnace macro codes of the "MA" feature that the YM2612 can play
+bool globalTarget(int code, Target& target)
+{
+    switch (code) {
+        case 0:  target = Target::volume;    return true;
+        case 1:  target = Target::arp;       return true;
+        case 4:  target = Target::pitch;     return true;
+        case 8:  target = Target::algorithm; return true;
+        case 9:  target = Target::feedback;  return true;
+        case 10: target = Target::fms;       return true;
+        case 11: target = Target::ams;       return true;
+        default: return false;   // duty, wave, ex1-3, pan, phase reset, ...
+    }
+}
+
+// Furnace operator macro code → register field, same units as compilePatch
+struct OpField { int8_t reg, shift, mask; };
+constexpr OpField kOpFields[12] = {
+    { 3, 7, 0x01 },   //  0 AM    0x60 bit 7
+    { 2, 0, 0x1F },   //  1 AR    0x50
+    { 3, 0, 0x1F },   //  2 DR    0x60
+    { 0, 0, 0x0F },   //  3 MULT  0x30
+    { 5, 0, 0x0F },   //  4 RR    0x80
+    { 5, 4, 0x0F },   //  5 SL    0x80
+    { 1, 0, 0x7F },   //  6 TL    0x40
+    { -1, 0, 0 },     //  7 DT2   (OPM only)
+    { 2, 6, 0x03 },   //  8 RS    0x50
+    { 0, 4, 0x07 },   //  9 DT    0x30
+    { 4, 0, 0x1F },   // 10 D2R   0x70
+    { 6, 0, 0x0F },   // 11 SSG   0x90
+};
+
+// One "MA" / "Ox" feature body: uint16 header length, then per macro a
+// header (code, length, loop, release, mode, open/type/word size, delay,
+// speed) padded to the header length and its values; code 255 ends it.
+void readMacros(FurnaceFormat::Cur c, int op, MacroProgram& program)
+{
+    const int headerLength = c.u16();
+    if (headerLength < 8) return;
+
+    int16_t values[MacroProgram::kMaxSteps];
+    while (c.ok(1)) {
+        const uint8_t* headerEnd = c.p + headerLength;
+        const int code = c.u8();
+        if (code == 255 || !c.ok(7)) break;
+
+        MacroProgram::Macro m;
+        m.length  = c.u8();
+        m.loop    = c.u8();
+        m.release = c.u8();
+        const int mode = c.u8();
+        const int open = c.u8();
+        m.delay   = c.u8();
+        m.speed   = uint8_t(std::max<int>(1, c.u8()));
+        c.seek(headerEnd);
+
+        static constexpr int kWordBytes[4] = { 1, 1, 2, 4 };
+        const int wordSize = open >> 6;
+        const int bytes    = kWordBytes[wordSize];
+        if (!c.ok(size_t(m.length) * size_t(bytes))) break;
+
+        for (int i = 0; i < m.length; ++i) {
+            uint32_t raw = 0;
+            for (int b = 0; b < bytes; ++b) raw |= uint32_t(c.u8()) << (8 * b);
+            int32_t v = wordSize == 0 ? int32_t(raw)
+                      : wordSize == 1 ? int32_t(int8_t(raw))
+                      : wordSize == 2 ? int32_t(int16_t(raw))
+                      :                 int32_t(raw);
+            values[i] = int16_t(std::clamp(v, -16383, 16383));
+
+            // Fixed arp notes: bit 30 set, bit 31 clear (only fits 32-bit words)
+            if (op < 0 && code == 1 && (raw & 0xC0000000u) == 0x40000000u)
+                values[i] = int16_t(MacroProgram::kFixedNote | std::min<uint32_t>(raw & 0xFF, 0xFF));
+        }
+
+        const int type = (open >> 1) & 3;   // 0 sequence, 1 ADSR, 2 LFO
+        if (type != 0 || m.length == 0) continue;
+
+        if (op < 0) {
+            if (!globalTarget(code, m.target)) continue;
+            m.relative = (m.target == Target::pitch && (mode & 1) != 0);
+        } else {
+            if (code >= int(std::size(kOpFields)) || kOpFields[code].reg < 0) continue;
+            m.target = code == 9 ? Target::opDetune : Target::opField;
+            m.op     = uint8_t(op);
+            m.reg    = uint8_t(kOpFields[code].reg);
+            m.shift  = uint8_t(kOpFields[code].shift);
+            m.mask   = uint8_t(kOpFields[code].mask);
+        }
+        if (!program.add(m, values)) return;
+    }
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  MacroProgram
+// ─────────────────────────────────────────────────────────────────────────────
+int MacroProgram::compile(const uint8_t* features, size_t size)
+{
+    clear();
+    if (features == nullptr) return 0;
+
+    FurnaceFormat::Cur c { features, features + size };
+    while (c.ok(4)) {
+        const char id0 = char(c.u8()), id1 = char(c.u8());
+        const uint16_t length = c.u16();
+        const uint8_t* end    = c.p + std::min<size_t>(length, size_t(c.end - c.p));
+
+        // O1..O4 are Furnace's operator order, OP1 OP3 OP2 OP4
+        if (id0 == 'M' && id1 == 'A')
+            readMacros({ c.p, end }, -1, *this);
+        else if (id0 == 'O' && id1 >= '1' && id1 <= '4')
+            readMacros({ c.p, end }, PatchCodecs::kSlotToUi[id1 - '1'], *this);
+        c.seek(end);
+    }
+    return m_count;
+}
+
+bool MacroProgram::add(Macro m, const int16_t* values)
+{
+    if (m_count >= kMaxMacros || m.length == 0) return false;
+    m.length = uint8_t(std::min<int>(m.length, kMaxSteps));
+    m.first  = uint16_t(m_used);
+    std::copy(values, values + m.length, m_values + m_used);
+    m_used += m.length;
+    m_macros[m_count++] = m;
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  MacroPlayer
+// ─────────────────────────────────────────────────────────────────────────────
+void MacroPlayer::start(const MacroProgram* program, int midiNote)
+{
+    m_program   = (program != nullptr && !program->empty()) ? program : nullptr;
+    m_released  = false;
+    m_note      = midiNote;
+    m_lastUnits = midiNote * 128;
+    if (m_program == nullptr) return;
+
+    for (int i = 0; i < m_program->size(); ++i) {
+        m_state[i]       = State();
+        m_state[i].delay = (*m_program)[i].delay;
+    }
+}
+
+void MacroPlayer::tick(Ym2612Engine& engine)
+{
+    if (m_program == nullptr) return;
+
+    for (int i = 0; i < m_program->size(); ++i) {
+        const auto& m = (*m_program)[i];
+        State& st = m_state[i];
+        if (st.done) continue;
+        if (st.delay > 0) { --st.delay; continue; }
+        if (st.wait > 1)  { --st.wait;  continue; }
+        st.wait = m.speed;
+
+        // Furnace's step: hold at the release point until note off, loop
+        // back unless the loop lies behind the release point after it
+        const int v = m_program->value(m, st.pos++);
+        st.value = m.relative ? std::clamp(st.value + v, -65535, 65535) : v;
+        st.has   = true;
+        if (st.pos > m.release && !m_released)
+            st.pos = (m.loop < m.length && m.loop < m.release) ? m.loop : st.pos - 1;
+        if (st.pos >= m.length) {
+            if (m.loop < m.length && (m.loop >= m.release || m.release >= m.length)) st.pos = m.loop;
+            else                                                                    st.done = true;
+        }
+    }
+    apply(engine);
+}
+
+void MacroPlayer::apply(Ym2612Engine& engine)
+{
+    if (m_program == nullptr) return;
+
+    auto frame = engine.getRegisterImage();
+    int  volume = 127, arp = 0, pitch = 0, fixedNote = -1;
+
+    for (int i = 0; i < m_program->size(); ++i) {
+        if (!m_state[i].has) continue;
+        const auto& m = (*m_program)[i];
+        const int   v = m_state[i].value;
+        switch (m.target) {
+            case MacroProgram::Target::volume:    volume = std::clamp(v, 0, 127); break;
+            case MacroProgram::Target::arp:
+                if ((v & MacroProgram::kFixedNote) != 0 && v > 0) fixedNote = (v & 0xFF) + 12;
+                else { arp = v; fixedNote = -1; }
+                break;
+            case MacroProgram::Target::pitch:     pitch = v; break;
+            case MacroProgram::Target::algorithm: frame.algFb    = uint8_t((frame.algFb & 0x38) | (v & 7)); break;
+            case MacroProgram::Target::feedback:  frame.algFb    = uint8_t((frame.algFb & 0x07) | ((v & 7) << 3)); break;
+            case MacroProgram::Target::fms:       frame.lrAmsFms = uint8_t((frame.lrAmsFms & ~0x07) | (v & 7)); break;
+            case MacroProgram::Target::ams:       frame.lrAmsFms = uint8_t((frame.lrAmsFms & ~0x30) | ((v & 3) << 4)); break;
+            case MacroProgram::Target::opField: {
+                uint8_t& r = frame.op[m.op][m.reg];
+                r = uint8_t((r & ~(m.mask << m.shift)) | ((v & m.mask) << m.shift));
+                break;
+            }
+            case MacroProgram::Target::opDetune: {
+                // Furnace's centred value, converted like the codecs convert it
+                uint8_t& r = frame.op[m.op][0];
+                r = uint8_t((r & 0x8F) | (PatchCodecs::dtToChip(v - 3) << 4));
+                break;
+            }
+        }
+    }
+
+    // Volume attenuates the carriers of the algorithm in effect this tick
+    if (volume < 127) {
+        const uint8_t carriers = Ym2612Engine::kCarrierMask[frame.algorithm()];
+        for (int p = 0; p < 4; ++p)
+            if ((carriers & (1 << p)) != 0) {
+                uint8_t& tl = frame.op[p][1];
+                tl = uint8_t(std::min(127, (tl & 0x7F) + 127 - volume));
+            }
+    }
+    engine.writeChangedRegisters(frame);
+
+    const int units = (fixedNote >= 0 ? fixedNote : m_note + arp) * 128 + pitch;
+    if (units != m_lastUnits) {
+        engine.setNote(units / 128.0);
+        m_lastUnits = units;
+    }
+}
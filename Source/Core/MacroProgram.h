@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Ym2612Engine.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// MacroProgram.h  –  Furnace instrument macros, precompiled for the audio thread
+//
+// A Furnace macro is a short sequence of values stepped once per engine tick.
+// The .fui "MA" feature holds the instrument macros and "O1".."O4" the
+// operator ones; PatchData::macros keeps those blocks verbatim, and
+// MacroProgram::compile() turns them into fixed arrays once, when the patch
+// is loaded. A MacroPlayer per voice then steps them at kTickRate:
+//
+//   vol            carrier TL += 127 - vol
+//   arp            semitones from the played note, or a fixed note
+//   pitch          1/128 semitone (Furnace linear pitch); relative mode adds up
+//   alg fb fms ams fields of 0xB0 / 0xB4
+//   op AM AR DR MULT RR SL TL RS DT D2R SSG    fields of 0x30..0x90
+//                  (DT centred as Furnace stores it, 3 = none)
+//
+// Playback follows Furnace: delay, speed, loop and release points, and a
+// macro that ends holds its last value. Fixed arp notes count from C-0 = 0
+// (MIDI note 12). ADSR and LFO type macros and the ones the YM2612 has no
+// register for (duty, wave, DT2, OPL/OPZ fields) are dropped by compile().
+//
+// A tick is a frame built from the patch image plus the macro values; only
+// the bytes that changed since the last tick are written to the chip.
+// ─────────────────────────────────────────────────────────────────────────────
+
+class MacroProgram
+{
+public:
+    static constexpr double kTickRate = 60.0;   // Furnace's default (NTSC) tick rate
+    static constexpr int    kMaxMacros = 64;
+    static constexpr int    kMaxSteps  = 255;
+    static constexpr int    kNone      = 255;   // no loop / release point
+
+    static constexpr int16_t kFixedNote = 0x4000;   // arp step flag: absolute note
+
+    enum class Target : uint8_t { volume, arp, pitch, algorithm, feedback, fms, ams, opField, opDetune };
+
+    struct Macro {
+        Target   target   = Target::volume;
+        uint8_t  op       = 0;      // opField, opDetune: OP1..OP4 in user order
+        uint8_t  reg      = 0;      // opField: 0..6 = registers 0x30..0x90
+        uint8_t  shift    = 0;      //          field position and width
+        uint8_t  mask     = 0;
+        uint8_t  length   = 0;
+        uint8_t  loop     = kNone;
+        uint8_t  release  = kNone;
+        uint8_t  delay    = 0;      // ticks before the first step
+        uint8_t  speed    = 1;      // ticks per step
+        bool     relative = false;  // pitch: each step adds to the last
+        uint16_t first    = 0;      // index of step 0 in the value pool
+    };
+
+    // Replaces the program with the macros found in raw feature blocks
+    // (PatchData::macros). Returns the number of macros kept.
+    int compile(const uint8_t* features, size_t size);
+
+    // Appends one macro; false when the program is full
+    bool add(Macro m, const int16_t* values);
+
+    void clear() { m_count = 0; m_used = 0; }
+
+    bool         empty() const                           { return m_count == 0; }
+    int          size() const                            { return m_count; }
+    const Macro& operator[](int i) const                 { return m_macros[i]; }
+    int16_t      value(const Macro& m, int step) const   { return m_values[m.first + step]; }
+
+private:
+    Macro   m_macros[kMaxMacros];
+    int     m_count = 0;
+    int16_t m_values[kMaxMacros * kMaxSteps] {};
+    int     m_used  = 0;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+// MacroPlayer  –  one voice's position in a MacroProgram
+//
+// Plain fixed-size state: start() at note on, tick() at kTickRate, release()
+// at note off. The program must outlive the note (or stop() is called).
+// ─────────────────────────────────────────────────────────────────────────────
+class MacroPlayer
+{
+public:
+    void start(const MacroProgram* program, int midiNote);
+    void release() { m_released = true; }
+    void stop()    { m_program = nullptr; }
+
+    bool isRunning() const { return m_program != nullptr; }
+
+    // Steps every macro once and writes what changed
+    void tick(Ym2612Engine& engine);
+
+    // Writes the current values again, e.g. after writeAllRegisters()
+    void apply(Ym2612Engine& engine);
+
+private:
+    struct State {
+        int     pos   = 0;
+        int     delay = 0;
+        int     wait  = 0;
+        int     value = 0;      // pitch: the running sum in relative mode
+        bool    has   = false;  // a step has played
+        bool    done  = false;
+    };
+
+    const MacroProgram* m_program  = nullptr;
+    State               m_state[MacroProgram::kMaxMacros];
+    bool                m_released = false;
+    int                 m_note     = 60;
+    int                 m_lastUnits = 0;   // note * 128 + pitch last sent
+};
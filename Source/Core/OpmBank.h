@@ -0,0 +1,196 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// OpmBank.h  –  VOPM / MiOPMdrv text bank (.opm)
+//
+//   //MiOPMdrv sound bank Paramer Ver2002.04.22
+//   @:0 Instrument 0
+//   LFO: LFRQ AMD PMD WF NFRQ
+//   CH:  PAN FL CON AMS PMS SLOT NE
+//   M1:  AR D1R D2R RR D1L TL KS MUL DT1 DT2 AMS-EN
+//   C1:  ...
+//   M2:  ...
+//   C2:  ...
+//
+// Lines starting with // are comments; any line may hold a trailing one.
+// M1, C1, M2, C2 are the OPM operators in algorithm order, i.e. OP1..OP4.
+// D1R/D2R/D1L/KS are DR/SR/SL/RS; DT1 uses the chip encoding. OPM-only
+// fields (PAN, SLOT, NE, DT2, the LFO line) are read and dropped: OPM LFO
+// rates do not map onto the OPN2 ones, so voices come in with the LFO off.
+//
+// The file is parsed line by line straight from the input buffer. A voice is
+// handed on when the next "@:" or the end of the file is reached; voices
+// missing the CH line or an operator are skipped.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <cstdio>
+#include "PatchCodec.h"
+
+namespace OpmBank {
+
+namespace detail {
+
+struct Line {
+    const char* p;
+    const char* end;
+
+    void skipBlanks() { while (p < end && (*p == ' ' || *p == '\t' || *p == ',')) ++p; }
+
+    bool startsWith(const char* prefix) const
+    {
+        const char* q = p;
+        for (; *prefix != 0; ++prefix, ++q)
+            if (q >= end || *q != *prefix) return false;
+        return true;
+    }
+
+    // Up to n decimal integers; returns how many were read
+    int ints(int* out, int n)
+    {
+        int count = 0;
+        for (; count < n; ++count) {
+            skipBlanks();
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+            if (p >= end || *p < '0' || *p > '9') break;
+            int v = 0;
+            while (p < end && *p >= '0' && *p <= '9') {
+                if (v < 100000) v = v * 10 + (*p - '0');
+                ++p;
+            }
+            out[count] = negative ? -v : v;
+        }
+        return count;
+    }
+};
+
+inline int clampField(int v, int hi) { return std::clamp(v, 0, hi); }
+
+} // namespace detail
+
+inline int decode(const uint8_t* data, size_t size, const VoiceCallback& onVoice)
+{
+    if (data == nullptr) return -1;
+
+    const char* p   = reinterpret_cast<const char*>(data);
+    const char* end = p + size;
+
+    PatchData voice;
+    bool inVoice = false;
+    int  seen    = 0;        // bit 0 = CH, bits 1-4 = M1, C1, M2, C2
+    int  voices  = 0;
+    bool stopped = false;
+
+    auto finish = [&] {
+        if (inVoice && seen == 0x1F && !stopped) {
+            ++voices;
+            if (!onVoice(voice)) stopped = true;
+        }
+        inVoice = false;
+    };
+
+    while (p < end && !stopped) {
+        const char* eol = p;
+        while (eol < end && *eol != '\n' && *eol != '\r') ++eol;
+        detail::Line line { p, eol };
+        p = eol;
+        while (p < end && (*p == '\n' || *p == '\r')) ++p;
+
+        // A trailing comment ends the line
+        for (const char* c = line.p; c + 1 < line.end; ++c)
+            if (c[0] == '/' && c[1] == '/') { line.end = c; break; }
+        line.skipBlanks();
+        if (line.p >= line.end) continue;
+
+        if (line.startsWith("@:")) {
+            finish();
+            line.p += 2;
+            int number = 0;
+            line.ints(&number, 1);
+            line.skipBlanks();
+            const char* nameEnd = line.end;
+            while (nameEnd > line.p && (nameEnd[-1] == ' ' || nameEnd[-1] == '\t')) --nameEnd;
+
+            voice = PatchData();
+            voice.name.assign(line.p, size_t(nameEnd - line.p));
+            inVoice = true;
+            seen    = 0;
+            continue;
+        }
+        if (!inVoice) continue;
+
+        if (line.startsWith("CH:")) {
+            line.p += 3;
+            int f[7] = {};
+            if (line.ints(f, 7) < 5) continue;
+            voice.patch.FB  = detail::clampField(f[1], 7);
+            voice.patch.ALG = detail::clampField(f[2], 7);
+            voice.patch.AMS = detail::clampField(f[3], 3);
+            voice.patch.FMS = detail::clampField(f[4], 7);
+            seen |= 1;
+            continue;
+        }
+
+        static constexpr const char* kOps[4] = { "M1:", "C1:", "M2:", "C2:" };
+        for (int op = 0; op < 4; ++op) {
+            if (!line.startsWith(kOps[op])) continue;
+            line.p += 3;
+            int f[11] = {};
+            if (line.ints(f, 11) < 10) break;
+            auto& o = voice.patch.op[op];
+            o.AR  = detail::clampField(f[0], 31);
+            o.DR  = detail::clampField(f[1], 31);
+            o.SR  = detail::clampField(f[2], 31);
+            o.RR  = detail::clampField(f[3], 15);
+            o.SL  = detail::clampField(f[4], 15);
+            o.TL  = detail::clampField(f[5], 127);
+            o.RS  = detail::clampField(f[6], 3);
+            o.MUL = detail::clampField(f[7], 15);
+            o.DT  = PatchCodecs::dtFromChip(detail::clampField(f[8], 7));
+            o.AM  = f[10] != 0 ? 1 : 0;   // 128 in VOPM, 1 in some converters
+            o.SSG = 0;
+            seen |= 2 << op;
+            break;
+        }
+    }
+    finish();
+    return voices > 0 ? voices : -1;
+}
+
+inline std::vector<uint8_t> encode(const std::vector<PatchData>& voices)
+{
+    std::string text = "//MiOPMdrv sound bank Paramer Ver2002.04.22\n"
+                       "//LFO: LFRQ AMD PMD WF NFRQ\n"
+                       "//@:[Num] [Name]\n"
+                       "//CH: PAN FL CON AMS PMS SLOT NE\n"
+                       "//[OPname]: AR D1R D2R RR D1L TL KS MUL DT1 DT2 AMS-EN\n";
+    char line[160];
+    static constexpr const char* kOps[4] = { "M1", "C1", "M2", "C2" };
+
+    for (size_t v = 0; v < voices.size(); ++v) {
+        const auto& d = voices[v];
+        // Names end at a line break or comment – keep them on their line
+        std::string name = d.name;
+        for (auto& c : name) if (c == '\n' || c == '\r') c = ' ';
+        if (const auto cut = name.find("//"); cut != std::string::npos) name.resize(cut);
+
+        std::snprintf(line, sizeof(line), "\n@:%zu ", v);
+        text += line;
+        text += name;
+        text += "\nLFO:  0   0   0   0   0\n";
+        std::snprintf(line, sizeof(line), "CH: 64 %3d %3d %3d %3d 120   0\n",
+                      d.patch.FB & 7, d.patch.ALG & 7, d.patch.AMS & 3, d.patch.FMS & 7);
+        text += line;
+        for (int op = 0; op < 4; ++op) {
+            const auto& o = d.patch.op[op];
+            std::snprintf(line, sizeof(line), "%s: %3d %3d %3d %3d %3d %3d %3d %3d %3d %3d %3d\n",
+                          kOps[op], o.AR & 31, o.DR & 31, o.SR & 31, o.RR & 15, o.SL & 15,
+                          o.TL & 127, o.RS & 3, o.MUL & 15, PatchCodecs::dtToChip(o.DT), 0,
+                          o.AM ? 128 : 0);
+            text += line;
+        }
+    }
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+} // namespace OpmBank
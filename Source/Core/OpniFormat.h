@@ -0,0 +1,76 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// OpniFormat.h  –  OPN2-BANK-Editor / libOPNMIDI single instrument (.opni)
+//
+//   [0]   11 bytes  "WOPN2-INST\0" (version 1) or "WOPN2-IN2T\0"
+//                   followed by a uint16 LE version
+//   [.]   1 byte    percussion flag
+//   [.]   32 bytes  name, zero padded
+//   [+32] int16 BE  note offset (semitones)
+//   [+34] 1 byte    percussion key
+//   [+35] 1 byte    register 0xB0: FB << 3 | ALG
+//   [+36] 1 byte    register 0xB4 sensitivity: AMS << 4 | FMS
+//   [+37] 4 × 7     operators in slot order (OP1, OP3, OP2, OP4),
+//                   registers 0x30, 0x40, 0x50, 0x60, 0x70, 0x80, 0x90
+//   [+65] 2 × uint16 BE key-on / key-off delays (version 2+, optional)
+//
+// A note offset that is a whole number of octaves within ±2 becomes the
+// octave offset; others are dropped. Written as version 1.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <cstring>
+#include "PatchCodec.h"
+
+namespace OpniFormat {
+
+static constexpr char   kMagic1[11] = { 'W','O','P','N','2','-','I','N','S','T','\0' };
+static constexpr char   kMagic2[11] = { 'W','O','P','N','2','-','I','N','2','T','\0' };
+static constexpr size_t kInstrumentSize = 65;
+
+inline bool decode(const uint8_t* data, size_t size, PatchData& out)
+{
+    if (data == nullptr || size < 11 + 1 + kInstrumentSize) return false;
+
+    size_t pos = 11;
+    if (std::memcmp(data, kMagic2, 11) == 0) {
+        pos += 2;   // version; only the optional delays depend on it
+        if (size < pos + 1 + kInstrumentSize) return false;
+    } else if (std::memcmp(data, kMagic1, 11) != 0) {
+        return false;
+    }
+    ++pos;          // percussion flag
+
+    const uint8_t* p = data + pos;
+    out = PatchData();
+    out.name = PatchCodecs::readName(p, 32);
+
+    out.block = PatchCodecs::blockFromTranspose(int16_t(uint16_t((p[32] << 8) | p[33])));
+
+    out.patch.ALG = p[35] & 7;
+    out.patch.FB  = (p[35] >> 3) & 7;
+    out.patch.AMS = (p[36] >> 4) & 3;
+    out.patch.FMS = p[36] & 7;
+    for (int slot = 0; slot < 4; ++slot)
+        PatchCodecs::opFromRegisters(p + 37 + slot * 7, out.patch.op[PatchCodecs::kSlotToUi[slot]]);
+    return true;
+}
+
+inline std::vector<uint8_t> encode(const PatchData& in)
+{
+    std::vector<uint8_t> out(11 + 1 + kInstrumentSize, 0);
+    std::memcpy(out.data(), kMagic1, 11);
+
+    uint8_t* p = out.data() + 12;
+    PatchCodecs::writeName(p, 32, in.name);
+    const auto noteOffset = uint16_t(int16_t(std::clamp(in.block, -2, 2) * 12));
+    p[32] = uint8_t(noteOffset >> 8);
+    p[33] = uint8_t(noteOffset);
+    p[35] = uint8_t(((in.patch.FB & 7) << 3) | (in.patch.ALG & 7));
+    p[36] = uint8_t(((in.patch.AMS & 3) << 4) | (in.patch.FMS & 7));
+    for (int slot = 0; slot < 4; ++slot)
+        PatchCodecs::opToRegisters(in.patch.op[PatchCodecs::kSlotToUi[slot]], p + 37 + slot * 7);
+    return out;
+}
+
+} // namespace OpniFormat
@@ -0,0 +1,156 @@
+#include "PatchCodec.h"
+
+#include <cctype>
+
+#include "DmpFormat.h"
+#include "FurModule.h"
+#include "FurnaceFormat.h"
+#include "GybBank.h"
+#include "OpmBank.h"
+#include "OpniFormat.h"
+#include "TfiFormat.h"
+#include "Y12Format.h"
+
+namespace {
+
+// The .fui block byte is not the plugin's octave offset (it is the OPLL/OPZ
+// block), so Furnace patches come in at octave 0 like they always have.
+bool decodeFui(const uint8_t* data, size_t size, PatchData& out)
+{
+    FurnaceFormat::Instrument ins;
+    if (!FurnaceFormat::parseFui(data, size, ins)) return false;
+    out = PatchData();
+    out.name  = std::move(ins.name);
+    out.patch = FurnaceFormat::toPatch(ins);
+    out.macros = std::move(ins.macroFeatures);
+    return true;
+}
+
+std::vector<uint8_t> encodeFui(const PatchData& in)
+{
+    auto ins = FurnaceFormat::fromPatch(in.patch, in.name);
+    ins.macroFeatures = in.macros;
+    return FurnaceFormat::encodeFui(ins);
+}
+
+// Sniffing order matters: formats with a magic go first, the fixed-size
+// headerless ones (Y12, TFI) last.
+const std::vector<PatchCodec> kCodecs = {
+    { PatchIndex::Format::fui,  "fui",  "Furnace instrument",    decodeFui,          encodeFui          },
+    { PatchIndex::Format::opni, "opni", "OPN2-BANK-Editor",      OpniFormat::decode, OpniFormat::encode },
+    { PatchIndex::Format::dmp,  "dmp",  "DefleMask preset",      DmpFormat::decode,  DmpFormat::encode  },
+    { PatchIndex::Format::y12,  "y12",  "Gens KMod dump",        Y12Format::decode,  Y12Format::encode  },
+    { PatchIndex::Format::tfi,  "tfi",  "TFM Music Maker",       TfiFormat::decode,  TfiFormat::encode  },
+};
+
+// Banks with a signature are checked first; an .opm bank needs a complete voice
+const std::vector<PatchBankCodec> kBanks = {
+    { PatchIndex::Format::gyb, "gyb", "GYBank bank",           GybBank::decode,    GybBank::encode    },
+    { PatchIndex::Format::fur, "fur", "Furnace module",        FurModule::decode,  nullptr            },
+    { PatchIndex::Format::opm, "opm", "VOPM bank",             OpmBank::decode,    OpmBank::encode    },
+};
+
+bool sameExtension(std::string_view a, const char* b)
+{
+    size_t i = 0;
+    for (; i < a.size() && b[i] != 0; ++i)
+        if (std::tolower(static_cast<unsigned char>(a[i])) != b[i]) return false;
+    return i == a.size() && b[i] == 0;
+}
+
+} // namespace
+
+namespace PatchCodecs {
+
+const std::vector<PatchCodec>& all()
+{
+    return kCodecs;
+}
+
+const std::vector<PatchBankCodec>& banks()
+{
+    return kBanks;
+}
+
+const PatchCodec* forExtension(std::string_view extension)
+{
+    if (!extension.empty() && extension.front() == '.') extension.remove_prefix(1);
+    for (const auto& c : kCodecs)
+        if (sameExtension(extension, c.extension)) return &c;
+    return nullptr;
+}
+
+const PatchCodec* forFormat(PatchIndex::Format format)
+{
+    for (const auto& c : kCodecs)
+        if (c.format == format) return &c;
+    return nullptr;
+}
+
+const PatchCodec* tryDecode(std::string_view extension, const uint8_t* data, size_t size, PatchData& out)
+{
+    // A known extension is trusted – a 42-byte corrupt .fui must not
+    // come back as a TFI
+    if (const auto* codec = forExtension(extension))
+        return codec->decode(data, size, out) ? codec : nullptr;
+
+    for (const auto& c : kCodecs)
+        if (c.decode(data, size, out)) return &c;
+    return nullptr;
+}
+
+const PatchBankCodec* bankForExtension(std::string_view extension)
+{
+    if (!extension.empty() && extension.front() == '.') extension.remove_prefix(1);
+    for (const auto& b : kBanks)
+        if (sameExtension(extension, b.extension)) return &b;
+    return nullptr;
+}
+
+int decodeAll(std::string_view extension, const uint8_t* data, size_t size,
+              const VoiceCallback& onPatch, PatchIndex::Format* format)
+{
+    auto single = [&](const PatchCodec& c) {
+        PatchData patch;
+        if (!c.decode(data, size, patch)) return -1;
+        if (format != nullptr) *format = c.format;
+        onPatch(patch);
+        return 1;
+    };
+    // The format is set before the first onPatch call, so callers can use it
+    // while the voices stream in
+    auto bank = [&](const PatchBankCodec& b) {
+        if (format != nullptr) *format = b.format;
+        return b.decode(data, size, onPatch);
+    };
+
+    if (const auto* codec = forExtension(extension)) return single(*codec);
+    if (const auto* b = bankForExtension(extension)) return bank(*b);
+
+    for (const auto& b : kBanks)
+        if (const int n = bank(b); n >= 0) return n;
+    for (const auto& c : kCodecs)
+        if (const int n = single(c); n >= 0) return n;
+    return -1;
+}
+
+std::string wildcard()
+{
+    std::string w;
+    auto add = [&w](const char* extension) {
+        if (!w.empty()) w += ';';
+        w += "*.";
+        w += extension;
+    };
+    for (const auto& c : kCodecs) add(c.extension);
+    for (const auto& b : kBanks) {
+#if !ARM2612_HAVE_ZLIB
+        // Most .fur files are compressed and would only fail to read
+        if (b.format == PatchIndex::Format::fur) continue;
+#endif
+        add(b.extension);
+    }
+    return w;
+}
+
+} // namespace PatchCodecs
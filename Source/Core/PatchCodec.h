@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BuiltInPatches.h"
+#include "PatchIndex.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PatchCodec  –  registry of instrument file formats
+//
+// Every format is a pair of plain functions over bytes: decode() parses in
+// place from (data, size) – no copy of the input is made – into a
+// PatchData, and encode() writes one. PatchData is the plugin's patch in
+// UI units plus what the formats carry besides it (name, octave offset,
+// LFO, Furnace macros). Fields a format does not store decode as 0.
+//
+// The built-in codecs (all() order, also the sniffing order):
+//   fui   Furnace instrument        FurnaceFormat.h
+//   opni  OPN2-BANK-Editor / WOPN   OpniFormat.h
+//   dmp   DefleMask preset          DmpFormat.h
+//   y12   Gens KMod register dump   Y12Format.h
+//   tfi   TFM Music Maker           TfiFormat.h
+// A new format is a header with its two functions and one line in
+// PatchCodec.cpp. Decoders must reject anything they cannot fully read –
+// tryDecode() relies on it to sniff files without a known extension, and
+// the fuzz targets in Tools/ hold every codec to it.
+//
+// Banks hold many voices per file (banks() order):
+//   opm   VOPM text bank            OpmBank.h
+//   gyb   GYBank binary bank        GybBank.h
+//   fur   Furnace module            FurModule.h   (read only)
+// A bank decoder streams: it walks the file once and calls onVoice for each
+// voice as soon as it is complete, reusing one PatchData, so memory stays
+// the same for a 5-voice and a 5000-voice bank. decodeAll() covers both
+// kinds for callers that just want every patch in a file.
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct PatchData
+{
+    std::string name;
+    YM2612Patch patch {};
+    int         block     = 0;   // octave offset -2..+2
+    int         lfoEnable = 0;
+    int         lfoFreq   = 0;   // index, 0 = off
+    std::vector<uint8_t> macros;   // Furnace MA / O1-O4 feature blocks (MacroProgram.h)
+};
+
+struct PatchCodec
+{
+    PatchIndex::Format format;
+    const char*        extension;     // lower case, no dot
+    const char*        description;
+    bool                 (*decode)(const uint8_t* data, size_t size, PatchData& out);
+    std::vector<uint8_t> (*encode)(const PatchData& in);
+};
+
+// Called once per voice of a bank; return false to stop reading
+using VoiceCallback = std::function<bool(const PatchData&)>;
+
+struct PatchBankCodec
+{
+    PatchIndex::Format format;
+    const char*        extension;
+    const char*        description;
+    // Number of voices passed to onVoice, or -1 if the data is not a bank
+    // of this format
+    int                  (*decode)(const uint8_t* data, size_t size, const VoiceCallback& onVoice);
+    // nullptr for formats that are only read
+    std::vector<uint8_t> (*encode)(const std::vector<PatchData>& voices);
+};
+
+namespace PatchCodecs {
+
+const std::vector<PatchCodec>& all();
+const std::vector<PatchBankCodec>& banks();
+
+// Case-insensitive, with or without the leading dot; nullptr if unknown
+const PatchCodec* forExtension(std::string_view extension);
+const PatchCodec* forFormat(PatchIndex::Format format);
+
+// Decodes with the codec for the extension; for an unknown or missing
+// extension, sniffs with every codec in all() order. Returns the codec
+// that succeeded, or nullptr.
+const PatchCodec* tryDecode(std::string_view extension, const uint8_t* data, size_t size, PatchData& out);
+
+const PatchBankCodec* bankForExtension(std::string_view extension);
+
+// Every patch in the data, instrument file or bank: onPatch runs once per
+// patch. Picks the codec like tryDecode(), banks first when sniffing.
+// Returns the number of patches, or -1 if no codec could read the data.
+// The format goes to *format before the first onPatch call.
+int decodeAll(std::string_view extension, const uint8_t* data, size_t size,
+              const VoiceCallback& onPatch, PatchIndex::Format* format = nullptr);
+
+// "*.fui;*.opni;..." for file choosers and directory scans, banks included
+// (.fur only when built with zlib)
+std::string wildcard();
+
+// ─── Shared helpers for the format headers ───────────────────────────────────
+// Files list operators in register (slot) order OP1, OP3, OP2, OP4; the
+// plugin's patch uses OP1..OP4. The map is its own inverse.
+static constexpr int kSlotToUi[4] = { 0, 2, 1, 3 };
+
+// Detune as most editors store it: 0..6 with 3 = none (UI value + 3)
+inline int dtFromCentred(int v)  { return std::clamp((v & 7) - 3, -3, 3); }
+inline int dtToCentred(int ui)   { return std::clamp(ui, -3, 3) + 3; }
+
+// Detune as the chip register holds it: 0..3 = +0..+3, 4..7 = -0..-3
+inline int dtFromChip(int v)     { v &= 7; return v < 4 ? v : -(v - 4); }
+inline int dtToChip(int ui)      { ui = std::clamp(ui, -3, 3); return ui >= 0 ? ui : 4 - ui; }
+
+// SSG-EG register value (bit 3 enable, bits 2..0 mode) ↔ UI 0 = off, 1-8
+inline int ssgFromRegister(int v) { return (v & 0x08) ? (v & 0x07) + 1 : 0; }
+inline int ssgToRegister(int ui)  { return ui > 0 ? 0x08 | ((ui - 1) & 7) : 0; }
+
+// One operator's registers 0x30..0x90 (7 bytes, chip layout)
+inline void opFromRegisters(const uint8_t* r, YM2612Operator& o)
+{
+    o.DT  = dtFromChip(r[0] >> 4);
+    o.MUL = r[0] & 0x0F;
+    o.TL  = r[1] & 0x7F;
+    o.RS  = (r[2] >> 6) & 3;
+    o.AR  = r[2] & 0x1F;
+    o.AM  = (r[3] >> 7) & 1;
+    o.DR  = r[3] & 0x1F;
+    o.SR  = r[4] & 0x1F;
+    o.SL  = (r[5] >> 4) & 0x0F;
+    o.RR  = r[5] & 0x0F;
+    o.SSG = ssgFromRegister(r[6]);
+}
+
+inline void opToRegisters(const YM2612Operator& o, uint8_t* r)
+{
+    r[0] = uint8_t((dtToChip(o.DT) << 4) | (o.MUL & 0x0F));
+    r[1] = uint8_t(o.TL & 0x7F);
+    r[2] = uint8_t(((o.RS & 3) << 6) | (o.AR & 0x1F));
+    r[3] = uint8_t(((o.AM & 1) << 7) | (o.DR & 0x1F));
+    r[4] = uint8_t(o.SR & 0x1F);
+    r[5] = uint8_t(((o.SL & 0x0F) << 4) | (o.RR & 0x0F));
+    r[6] = uint8_t(ssgToRegister(o.SSG));
+}
+
+// Fixed-size, zero-padded name field
+inline std::string readName(const uint8_t* p, size_t maxLength)
+{
+    size_t n = 0;
+    while (n < maxLength && p[n] != 0) ++n;
+    return std::string(reinterpret_cast<const char*>(p), n);
+}
+
+inline void writeName(uint8_t* p, size_t maxLength, const std::string& name)
+{
+    std::fill(p, p + maxLength, uint8_t(0));
+    std::copy_n(name.data(), std::min(name.size(), maxLength), p);
+}
+
+// Semitone transpose → octave offset, when it is whole octaves within ±2
+inline int blockFromTranspose(int semitones)
+{
+    return (semitones % 12 == 0 && semitones >= -24 && semitones <= 24) ? semitones / 12 : 0;
+}
+
+} // namespace PatchCodecs
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "BuiltInPatches.h"
+#include "PatchCodec.h"
+#include "Ym2612Engine.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// compilePatch  –  YM2612Patch (UI units) → Ym2612Engine::RegisterImage
+//
+// Uses exactly the same unit conversions as the parameter path
+// (ARM2612AudioProcessor::pushParamsToVoices), so a patch sounds identical
+// whether it arrives via the APVTS or via a MIDI program change:
+//   DT  UI(-3..+3) → chip 0..3 = +0..+3, 5..7 = -1..-3 (PatchCodecs::dtToChip,
+//       the mapping the patch files and the DT macro use too)
+//   SSG 0 = off, 1-8 = chip modes 0-7
+//   LFO frequency index 0 = off, 1-7 = chip values 0-6
+// ─────────────────────────────────────────────────────────────────────────────
+inline Ym2612Engine::RegisterImage compilePatch(const YM2612Patch& patch, int block, int lfoFreqIndex)
+{
+    Ym2612Engine::GlobalParams gp;
+    gp.algorithm = patch.ALG;
+    gp.feedback  = patch.FB;
+    gp.lfoEnable = (lfoFreqIndex > 0);
+    gp.lfoFreq   = (lfoFreqIndex > 0) ? (lfoFreqIndex - 1) : 0;
+    gp.ams       = patch.AMS;
+    gp.fms       = patch.FMS;
+    gp.octave    = block;
+
+    Ym2612Engine::OpParams ops[4];
+    for (int op = 0; op < 4; op++) {
+        const YM2612Operator& o = patch.op[op];
+        ops[op].tl  = o.TL;
+        ops[op].ar  = o.AR;
+        ops[op].dr  = o.DR;
+        ops[op].sr  = o.SR;
+        ops[op].sl  = o.SL;
+        ops[op].rr  = o.RR;
+        ops[op].mul = o.MUL;
+        ops[op].dt  = PatchCodecs::dtToChip(o.DT);
+        ops[op].rs  = o.RS;
+        ops[op].am  = o.AM ? 1 : 0;
+        ops[op].ssgEnable = (o.SSG > 0) ? 1 : 0;
+        ops[op].ssgMode   = (o.SSG > 0) ? (o.SSG - 1) : 0;
+    }
+    return Ym2612Engine::RegisterImage::compile(gp, ops);
+}
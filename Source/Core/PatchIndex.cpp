@@ -0,0 +1,256 @@
+#include "PatchIndex.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "PatchCompiler.h"
+
+namespace PatchIndex {
+
+static constexpr char kMagic[4] = { 'A', '2', '6', 'X' };
+
+uint64_t hashBytes(const void* data, size_t size)
+{
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+void setPatch(Record& r, const YM2612Patch& patch, int block, int lfoEnable, int lfoFreq)
+{
+    auto u8 = [](int v, int lo, int hi) { return uint8_t(std::clamp(v, lo, hi)); };
+
+    r.block     = int8_t(std::clamp(block, -2, 2));
+    r.lfoEnable = u8(lfoEnable, 0, 1);
+    r.lfoFreq   = u8(lfoFreq, 0, 7);
+    r.alg = u8(patch.ALG, 0, 7);
+    r.fb  = u8(patch.FB,  0, 7);
+    r.ams = u8(patch.AMS, 0, 3);
+    r.fms = u8(patch.FMS, 0, 7);
+
+    for (int i = 0; i < 4; ++i) {
+        const auto& o = patch.op[i];
+        const uint8_t v[11] = { u8(o.DT + 3, 0, 6), u8(o.MUL, 0, 15), u8(o.TL, 0, 127),
+                                u8(o.RS, 0, 3),     u8(o.AR, 0, 31),  u8(o.AM, 0, 1),
+                                u8(o.DR, 0, 31),    u8(o.SR, 0, 31),  u8(o.SL, 0, 15),
+                                u8(o.RR, 0, 15),    u8(o.SSG, 0, 8) };
+        std::memcpy(r.op[i], v, sizeof(v));
+    }
+
+    const auto img = compilePatch(patch, block, lfoFreq);
+    r.regLfo      = img.lfo;
+    r.regAlgFb    = img.algFb;
+    r.regLrAmsFms = img.lrAmsFms;
+    std::memcpy(r.regOp, img.op, sizeof(r.regOp));
+    r.regOctave   = int8_t(img.octave);
+
+    r.canonicalHash = hashImage(canonicalImage(img));
+}
+
+YM2612Patch getPatch(const Record& r)
+{
+    YM2612Patch p {};
+    p.ALG = r.alg;
+    p.FB  = r.fb;
+    p.AMS = r.ams;
+    p.FMS = r.fms;
+    for (int i = 0; i < 4; ++i) {
+        const uint8_t* v = r.op[i];
+        auto& o = p.op[i];
+        o.DT = int(v[0]) - 3;  o.MUL = v[1];  o.TL = v[2];  o.RS = v[3];
+        o.AR = v[4];           o.AM  = v[5];  o.DR = v[6];  o.SR = v[7];
+        o.SL = v[8];           o.RR  = v[9];  o.SSG = v[10];
+    }
+    return p;
+}
+
+Ym2612Engine::RegisterImage getImage(const Record& r)
+{
+    Ym2612Engine::RegisterImage img;
+    img.lfo      = r.regLfo;
+    img.algFb    = r.regAlgFb;
+    img.lrAmsFms = r.regLrAmsFms;
+    std::memcpy(img.op, r.regOp, sizeof(img.op));
+    img.octave   = r.regOctave;
+    return img;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Canonical form
+// ─────────────────────────────────────────────────────────────────────────────
+Ym2612Engine::RegisterImage canonicalImage(const Ym2612Engine::RegisterImage& img)
+{
+    auto c = img;
+    const uint8_t carriers = Ym2612Engine::kCarrierMask[c.algorithm()];
+
+    for (int p = 0; p < 4; ++p) {
+        const bool silentModulator = !(carriers & (1 << p)) && (c.op[p][1] & 0x7F) == 0x7F;
+        if (!silentModulator) continue;
+        std::memset(c.op[p], 0, sizeof(c.op[p]));
+        c.op[p][1] = 0x7F;
+        if (p == 0) c.algFb &= 0x07;   // OP1 feedback
+    }
+
+    if (!(c.lfo & 0x08)) {
+        c.lfo       = 0;
+        c.lrAmsFms &= 0xC0;
+        for (auto& op : c.op) op[3] &= 0x1F;   // AM enable
+    }
+    return c;
+}
+
+uint64_t hashImage(const Ym2612Engine::RegisterImage& img)
+{
+    uint8_t bytes[4 + sizeof(img.op)];
+    bytes[0] = img.lfo;
+    bytes[1] = img.algFb;
+    bytes[2] = img.lrAmsFms;
+    bytes[3] = uint8_t(int8_t(img.octave));
+    std::memcpy(bytes + 4, img.op, sizeof(img.op));
+    return hashBytes(bytes, sizeof(bytes));
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  View
+// ─────────────────────────────────────────────────────────────────────────────
+bool View::open(const void* data, size_t size)
+{
+    close();
+    if (data == nullptr || size < sizeof(Header)) return false;
+
+    Header h;
+    std::memcpy(&h, data, sizeof(h));
+    if (std::memcmp(h.magic, kMagic, 4) != 0 || h.version != kVersion
+        || h.entrySize != sizeof(Entry) || h.recordSize != sizeof(Record))
+        return false;
+
+    const uint64_t entriesEnd = sizeof(Header) + uint64_t(h.entryCount) * sizeof(Entry);
+    const uint64_t recordsEnd = h.recordsOffset + uint64_t(h.recordCount) * sizeof(Record);
+    const uint64_t failedEnd  = h.failedOffset + uint64_t(h.failedCount) * sizeof(Failed);
+    if (entriesEnd > size || h.recordsOffset < entriesEnd || h.recordsOffset % alignof(Record) != 0
+        || recordsEnd > size || h.failedSize != sizeof(Failed)
+        || h.failedOffset < recordsEnd || h.failedOffset % alignof(Failed) != 0
+        || failedEnd > size || h.stringsOffset < failedEnd
+        || h.stringsOffset > size || h.stringsSize > size - h.stringsOffset)
+        return false;
+
+    const auto* base    = static_cast<const uint8_t*>(data);
+    const auto* entries = reinterpret_cast<const Entry*>(base + sizeof(Header));
+    for (uint32_t i = 0; i < h.entryCount; ++i) {
+        const Entry& e = entries[i];
+        if (uint64_t(e.pathOffset) + e.pathLength > h.stringsSize
+            || uint64_t(e.nameOffset) + e.nameLength > h.stringsSize
+            || e.record >= h.recordCount)
+            return false;
+    }
+    const auto* failed = reinterpret_cast<const Failed*>(base + h.failedOffset);
+    for (uint32_t f = 0; f < h.failedCount; ++f)
+        if (uint64_t(failed[f].pathOffset) + failed[f].pathLength > h.stringsSize)
+            return false;
+
+    m_entries     = entries;
+    m_records     = reinterpret_cast<const Record*>(base + h.recordsOffset);
+    m_failed      = failed;
+    m_strings     = reinterpret_cast<const char*>(base + h.stringsOffset);
+    m_entryCount  = h.entryCount;
+    m_recordCount = h.recordCount;
+    m_failedCount = h.failedCount;
+    return true;
+}
+
+std::string_view View::path(size_t i) const
+{
+    const Entry& e = m_entries[i];
+    return { m_strings + e.pathOffset, e.pathLength };
+}
+
+std::string_view View::name(size_t i) const
+{
+    const Entry& e = m_entries[i];
+    return { m_strings + e.nameOffset, e.nameLength };
+}
+
+std::string_view View::failedPath(size_t f) const
+{
+    const Failed& e = m_failed[f];
+    return { m_strings + e.pathOffset, e.pathLength };
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Builder
+// ─────────────────────────────────────────────────────────────────────────────
+void Builder::add(const Entry& e, const Record& r, std::string_view path, std::string_view name)
+{
+    path = path.substr(0, 0xFFFF);
+    name = name.substr(0, 0xFFFF);
+
+    // Same hash is only a candidate; the canonical images must match too
+    const auto canonical = canonicalImage(getImage(r));
+    uint32_t   index     = uint32_t(m_records.size());
+    const auto [first, last] = m_byHash.equal_range(r.canonicalHash);
+    for (auto it = first; it != last; ++it)
+        if (canonicalImage(getImage(m_records[it->second])) == canonical) { index = it->second; break; }
+
+    if (index == m_records.size()) {
+        m_records.push_back(r);
+        m_byHash.emplace(r.canonicalHash, index);
+    }
+
+    Entry entry = e;
+    entry.record     = index;
+    entry.pathOffset = uint32_t(m_strings.size());
+    entry.pathLength = uint16_t(path.size());
+    m_strings.append(path);
+    entry.nameOffset = uint32_t(m_strings.size());
+    entry.nameLength = uint16_t(name.size());
+    m_strings.append(name);
+    m_entries.push_back(entry);
+}
+
+void Builder::addFailed(int64_t mtimeMs, uint64_t fileSize, std::string_view path)
+{
+    path = path.substr(0, 0xFFFF);
+
+    Failed f {};
+    f.mtimeMs    = mtimeMs;
+    f.fileSize   = fileSize;
+    f.pathOffset = uint32_t(m_strings.size());
+    f.pathLength = uint16_t(path.size());
+    m_strings.append(path);
+    m_failed.push_back(f);
+}
+
+std::vector<uint8_t> Builder::finish() const
+{
+    Header h {};
+    std::memcpy(h.magic, kMagic, 4);
+    h.version       = kVersion;
+    h.entryCount    = uint32_t(m_entries.size());
+    h.entrySize     = sizeof(Entry);
+    h.recordCount   = uint32_t(m_records.size());
+    h.recordSize    = sizeof(Record);
+    h.recordsOffset = sizeof(Header) + m_entries.size() * sizeof(Entry);
+    h.failedOffset  = h.recordsOffset + m_records.size() * sizeof(Record);
+    h.failedCount   = uint32_t(m_failed.size());
+    h.failedSize    = sizeof(Failed);
+    h.stringsOffset = h.failedOffset + m_failed.size() * sizeof(Failed);
+    h.stringsSize   = m_strings.size();
+
+    std::vector<uint8_t> out(size_t(h.stringsOffset + h.stringsSize));
+    std::memcpy(out.data(), &h, sizeof(h));
+    if (!m_entries.empty())
+        std::memcpy(out.data() + sizeof(Header), m_entries.data(), m_entries.size() * sizeof(Entry));
+    if (!m_records.empty())
+        std::memcpy(out.data() + h.recordsOffset, m_records.data(), m_records.size() * sizeof(Record));
+    if (!m_failed.empty())
+        std::memcpy(out.data() + h.failedOffset, m_failed.data(), m_failed.size() * sizeof(Failed));
+    if (!m_strings.empty())
+        std::memcpy(out.data() + h.stringsOffset, m_strings.data(), m_strings.size());
+    return out;
+}
+
+} // namespace PatchIndex
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "BuiltInPatches.h"
+#include "Ym2612Engine.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PatchIndex  –  on-disk index of a patch library, read in place
+//
+// The file is meant to be memory-mapped and used without parsing:
+//
+//   Header   64 bytes   magic "A26X", version, counts, section offsets
+//   Entry    48 bytes   × entryCount, one per patch in a source file
+//   Record   96 bytes   × recordCount, one per distinct patch
+//   Failed   24 bytes   × failedCount, one per file that gave no patch
+//   Strings  UTF-8 paths and names, referenced by (offset, length)
+//
+// An entry holds the name, source path, mtime and size (to detect changed
+// files on rescan) and a content hash of the file, and points at a record.
+// A bank file has one entry per voice; they are consecutive and share the
+// file fields.
+// A record holds the patch in UI units and its compiled register image –
+// what the browser needs to load a patch without touching its file.
+// Files that gave no patch (unreadable, not FM, no FM voices) keep only
+// their path, mtime and size, so a rescan skips them too while unchanged.
+//
+// Records are content-addressed: every patch is reduced to a canonical
+// register image (canonicalImage) and files whose patches agree there
+// share one record, whatever their names. Sections are fixed size, so
+// entry i and record j are at known offsets.
+//
+// The layout is the host's native one (little-endian on every supported
+// platform) – it is a cache, so a mismatch just means a rebuild. View
+// checks every record's string references on open, so a truncated or
+// corrupt file is rejected rather than read out of bounds.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace PatchIndex {
+
+static constexpr uint32_t kVersion = 4;
+
+// Source file format (see PatchCodec.h); appended to, never renumbered
+enum class Format : uint8_t { fui = 0, dmp, tfi, y12, opni, opm, gyb, fur };
+
+struct Header {
+    char     magic[4];            // "A26X"
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t entrySize;
+    uint32_t recordCount;
+    uint32_t recordSize;
+    uint64_t recordsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t failedOffset;
+    uint32_t failedCount;
+    uint32_t failedSize;
+};
+
+struct Entry {
+    int64_t  mtimeMs;             // source file modification time
+    uint64_t fileSize;
+    uint64_t contentHash;         // hashBytes() of the source file
+    uint32_t pathOffset;          // into the string table
+    uint32_t nameOffset;
+    uint16_t pathLength;
+    uint16_t nameLength;
+    uint32_t record;              // index of the patch record
+    Format   format;
+    uint8_t  reserved[7];
+};
+
+struct Record {
+    uint64_t canonicalHash;       // hashImage(canonicalImage())
+    int8_t   block;               // octave offset -2..+2
+    uint8_t  lfoEnable;
+    uint8_t  lfoFreq;             // index, 0 = off
+
+    // Patch in UI units (DT stored +3, so 0..6)
+    uint8_t  alg, fb, ams, fms;
+    uint8_t  op[4][11];           // DT MUL TL RS AR AM DR SR SL RR SSG
+
+    // Compiled register image (Ym2612Engine::RegisterImage)
+    uint8_t  regLfo, regAlgFb, regLrAmsFms;
+    uint8_t  regOp[4][7];
+    int8_t   regOctave;
+
+    uint8_t  reserved[5];
+};
+
+struct Failed {
+    int64_t  mtimeMs;
+    uint64_t fileSize;
+    uint32_t pathOffset;
+    uint16_t pathLength;
+    uint8_t  reserved[2];
+};
+
+static_assert(sizeof(Header) == 64, "PatchIndex::Header layout");
+static_assert(sizeof(Entry)  == 48, "PatchIndex::Entry layout");
+static_assert(sizeof(Record) == 96, "PatchIndex::Record layout");
+static_assert(sizeof(Failed) == 24, "PatchIndex::Failed layout");
+
+// 64-bit FNV-1a
+uint64_t hashBytes(const void* data, size_t size);
+
+// Fills every field of r, including canonicalHash
+void setPatch(Record& r, const YM2612Patch& patch, int block, int lfoEnable, int lfoFreq);
+
+YM2612Patch                 getPatch(const Record& r);
+Ym2612Engine::RegisterImage getImage(const Record& r);
+
+// The register image with everything that cannot change the sound cleared:
+//  - modulators (non-carriers in the algorithm) at TL=127, all registers
+//  - feedback, when OP1 is such a silent modulator
+//  - AMS, FMS and the per-operator AM bits, when the LFO is off
+// Two patches with equal canonical images sound the same.
+Ym2612Engine::RegisterImage canonicalImage(const Ym2612Engine::RegisterImage& img);
+
+// Hash of a register image's bytes (no padding)
+uint64_t hashImage(const Ym2612Engine::RegisterImage& img);
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Read-only view over index bytes (usually a memory mapping). Indices are
+// entry indices unless noted.
+class View
+{
+public:
+    // Validates the whole file; on failure the view stays empty
+    bool open(const void* data, size_t size);
+    void close() { *this = View(); }
+
+    size_t        size() const { return m_entryCount; }
+    const Entry&  entry(size_t i) const  { return m_entries[i]; }
+    const Record& record(size_t i) const { return m_records[m_entries[i].record]; }
+
+    // Distinct patches; recordAt() takes a record index (Entry::record)
+    size_t        numRecords() const { return m_recordCount; }
+    const Record& recordAt(size_t r) const { return m_records[r]; }
+
+    std::string_view path(size_t i) const;
+    std::string_view name(size_t i) const;
+
+    // Files that gave no patch; f is a failed-file index
+    size_t           numFailed() const        { return m_failedCount; }
+    const Failed&    failed(size_t f) const   { return m_failed[f]; }
+    std::string_view failedPath(size_t f) const;
+
+private:
+    const Entry*   m_entries     = nullptr;
+    const Record*  m_records     = nullptr;
+    const Failed*  m_failed      = nullptr;
+    const char*    m_strings     = nullptr;
+    size_t         m_entryCount  = 0;
+    size_t         m_recordCount = 0;
+    size_t         m_failedCount = 0;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Builds a new index file in memory
+class Builder
+{
+public:
+    // Copies the file fields of e (not the string or record references) and
+    // points the entry at an existing record with the same canonical image,
+    // or at a new copy of r
+    void add(const Entry& e, const Record& r, std::string_view path, std::string_view name);
+
+    // A file that gave no patch
+    void addFailed(int64_t mtimeMs, uint64_t fileSize, std::string_view path);
+
+    size_t size() const       { return m_entries.size(); }
+    size_t numRecords() const { return m_records.size(); }
+    size_t numFailed() const  { return m_failed.size(); }
+
+    std::vector<uint8_t> finish() const;
+
+private:
+    std::vector<Entry>  m_entries;
+    std::vector<Record> m_records;
+    std::vector<Failed> m_failed;
+    std::unordered_multimap<uint64_t, uint32_t> m_byHash;   // canonicalHash → record
+    std::string         m_strings;
+};
+
+} // namespace PatchIndex
@@ -0,0 +1,293 @@
+#include "PatchSearch.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+#include "Ym2612Engine.h"
+
+static std::string lowerPadded(std::string_view s)
+{
+    // Leading/trailing space so word starts and ends form trigrams too
+    std::string out;
+    out.reserve(s.size() + 2);
+    out.push_back(' ');
+    for (char c : s) out.push_back(char(std::tolower(uint8_t(c))));
+    out.push_back(' ');
+    return out;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Build
+// ─────────────────────────────────────────────────────────────────────────────
+void PatchSearch::build(const std::vector<Item>& items)
+{
+    m_count = items.size();
+
+    for (auto& g : m_global) g.assign(m_count, 0);
+    for (auto& op : m_op)
+        for (auto& p : op) p.assign(m_count, 0);
+    m_carrierMask.assign(m_count, 0);
+    m_text.assign(m_count, {});
+
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;   // (trigram, item)
+    pairs.reserve(m_count * 16);
+
+    for (size_t i = 0; i < m_count; ++i) {
+        const auto& r = items[i].record;
+        m_global[ALG][i] = r.alg;
+        m_global[FB][i]  = r.fb;
+        m_global[AMS][i] = r.ams;
+        m_global[FMS][i] = r.fms;
+        for (int op = 0; op < 4; ++op)
+            for (int p = 0; p < kNumOpParams; ++p)
+                m_op[op][p][i] = r.op[op][p];
+        m_carrierMask[i] = Ym2612Engine::kCarrierMask[r.alg & 7];
+
+        m_text[i] = lowerPadded(items[i].text);
+        const auto& t = m_text[i];
+        const size_t first = pairs.size();
+        for (size_t k = 0; k + 3 <= t.size(); ++k)
+            pairs.emplace_back(trigram(t.data() + k), uint32_t(i));
+        // Each trigram counts once per item
+        std::sort(pairs.begin() + long(first), pairs.end());
+        pairs.erase(std::unique(pairs.begin() + long(first), pairs.end()), pairs.end());
+    }
+
+    std::sort(pairs.begin(), pairs.end());
+
+    m_keys.clear();
+    m_offsets.clear();
+    m_postings.clear();
+    m_postings.reserve(pairs.size());
+    for (const auto& [key, item] : pairs) {
+        if (m_keys.empty() || m_keys.back() != key) {
+            m_keys.push_back(key);
+            m_offsets.push_back(uint32_t(m_postings.size()));
+        }
+        m_postings.push_back(item);
+    }
+    m_offsets.push_back(uint32_t(m_postings.size()));
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Query parsing
+// ─────────────────────────────────────────────────────────────────────────────
+bool PatchSearch::parseFilter(std::string_view token, Filter& f, std::string& error)
+{
+    const size_t cmpAt = token.find_first_of("=!<>");
+    if (cmpAt == std::string_view::npos || cmpAt == 0) return false;   // plain text
+
+    std::string field;
+    for (char c : token.substr(0, cmpAt)) field.push_back(char(std::tolower(uint8_t(c))));
+    std::string_view rest = token.substr(cmpAt);
+
+    if      (rest.substr(0, 2) == "<=") { f.cmp = Cmp::le; rest.remove_prefix(2); }
+    else if (rest.substr(0, 2) == ">=") { f.cmp = Cmp::ge; rest.remove_prefix(2); }
+    else if (rest.substr(0, 2) == "!=") { f.cmp = Cmp::ne; rest.remove_prefix(2); }
+    else if (rest.substr(0, 2) == "==") { f.cmp = Cmp::eq; rest.remove_prefix(2); }
+    else if (rest[0] == '=')            { f.cmp = Cmp::eq; rest.remove_prefix(1); }
+    else if (rest[0] == '<')            { f.cmp = Cmp::lt; rest.remove_prefix(1); }
+    else if (rest[0] == '>')            { f.cmp = Cmp::gt; rest.remove_prefix(1); }
+    else { error = "bad operator in '" + std::string(token) + "'"; return true; }
+
+    const std::string valueText(rest);
+    char* end = nullptr;
+    const long v = std::strtol(valueText.c_str(), &end, 10);
+    if (valueText.empty() || end == nullptr || *end != '\0') {
+        error = "bad value in '" + std::string(token) + "'";
+        return true;
+    }
+    f.value = int(v);
+
+    static const char* const globals[kNumGlobals]   = { "alg", "fb", "ams", "fms" };
+    static const char* const opParams[kNumOpParams] = { "dt", "mul", "tl", "rs", "ar", "am",
+                                                        "dr", "sr", "sl", "rr", "ssg" };
+
+    for (int g = 0; g < kNumGlobals; ++g)
+        if (field == globals[g]) { f.scope = Scope::global; f.param = g; f.op = 0; return true; }
+
+    // Optional operator prefix: opN. / car. / mod.
+    f.scope = Scope::anyOp;
+    f.op    = 0;
+    std::string_view name = field;
+    if (name.size() > 4 && name.substr(0, 2) == "op" && name[3] == '.' && name[2] >= '1' && name[2] <= '4') {
+        f.scope = Scope::op;
+        f.op    = name[2] - '1';
+        name.remove_prefix(4);
+    } else if (name.substr(0, 4) == "car.") {
+        f.scope = Scope::carriers;
+        name.remove_prefix(4);
+    } else if (name.substr(0, 4) == "mod.") {
+        f.scope = Scope::modulators;
+        name.remove_prefix(4);
+    }
+
+    for (int p = 0; p < kNumOpParams; ++p)
+        if (name == opParams[p]) {
+            f.param = p;
+            // DT is stored +3; filters use UI values
+            if (p == DT) f.value += 3;
+            return true;
+        }
+
+    error = "unknown parameter '" + field + "'";
+    return true;
+}
+
+PatchSearch::Parsed PatchSearch::parse(std::string_view query)
+{
+    Parsed out;
+    size_t i = 0;
+    while (i < query.size()) {
+        while (i < query.size() && std::isspace(uint8_t(query[i]))) ++i;
+        size_t j = i;
+        while (j < query.size() && !std::isspace(uint8_t(query[j]))) ++j;
+        if (j == i) break;
+
+        const auto token = query.substr(i, j - i);
+        Filter f {};
+        std::string error;
+        if (parseFilter(token, f, error)) {
+            if (error.empty())          out.filters.push_back(f);
+            else if (out.error.empty()) out.error = error;
+        } else {
+            if (!out.text.empty()) out.text.push_back(' ');
+            out.text.append(token);
+        }
+        i = j;
+    }
+    return out;
+}
+
+std::string PatchSearch::checkQuery(std::string_view query)
+{
+    return parse(query).error;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Filters – one pass per array, no branches in the loops
+// ─────────────────────────────────────────────────────────────────────────────
+template <typename Test>
+static void andColumn(std::vector<uint8_t>& mask, const std::vector<uint8_t>& col, Test test)
+{
+    uint8_t* m = mask.data();
+    const uint8_t* c = col.data();
+    const size_t n = mask.size();
+    for (size_t i = 0; i < n; ++i) m[i] &= uint8_t(test(int(c[i])));
+}
+
+void PatchSearch::applyFilter(const Filter& f, std::vector<uint8_t>& mask) const
+{
+    const int v = f.value;
+    auto dispatch = [&](auto&& apply) {
+        switch (f.cmp) {
+            case Cmp::eq: apply([v](int x) { return x == v; }); break;
+            case Cmp::ne: apply([v](int x) { return x != v; }); break;
+            case Cmp::lt: apply([v](int x) { return x <  v; }); break;
+            case Cmp::le: apply([v](int x) { return x <= v; }); break;
+            case Cmp::gt: apply([v](int x) { return x >  v; }); break;
+            case Cmp::ge: apply([v](int x) { return x >= v; }); break;
+        }
+    };
+
+    if (f.scope == Scope::global) {
+        dispatch([&](auto test) { andColumn(mask, m_global[f.param], test); });
+        return;
+    }
+    if (f.scope == Scope::op) {
+        dispatch([&](auto test) { andColumn(mask, m_op[f.op][f.param], test); });
+        return;
+    }
+
+    // Any of several operators: OR the per-operator tests, restricted by role
+    const size_t n = m_count;
+    std::vector<uint8_t> any(n, 0);
+    dispatch([&](auto test) {
+        for (int op = 0; op < 4; ++op) {
+            const uint8_t* c   = m_op[op][f.param].data();
+            const uint8_t* car = m_carrierMask.data();
+            uint8_t*       a   = any.data();
+            const uint8_t  bit = uint8_t(1u << op);
+            switch (f.scope) {
+                case Scope::carriers:
+                    for (size_t i = 0; i < n; ++i) a[i] |= uint8_t(test(int(c[i])) & ((car[i] & bit) != 0));
+                    break;
+                case Scope::modulators:
+                    for (size_t i = 0; i < n; ++i) a[i] |= uint8_t(test(int(c[i])) & ((car[i] & bit) == 0));
+                    break;
+                default:
+                    for (size_t i = 0; i < n; ++i) a[i] |= uint8_t(test(int(c[i])));
+                    break;
+            }
+        }
+    });
+    for (size_t i = 0; i < n; ++i) mask[i] &= any[i];
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Text
+// ─────────────────────────────────────────────────────────────────────────────
+void PatchSearch::matchText(const std::string& text, std::vector<uint16_t>& score) const
+{
+    const std::string q = lowerPadded(text);
+
+    std::vector<uint32_t> grams;
+    for (size_t k = 0; k + 3 <= q.size(); ++k) grams.push_back(trigram(q.data() + k));
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+    for (uint32_t g : grams) {
+        const auto it = std::lower_bound(m_keys.begin(), m_keys.end(), g);
+        if (it == m_keys.end() || *it != g) continue;
+        const size_t k = size_t(it - m_keys.begin());
+        for (uint32_t p = m_offsets[k]; p < m_offsets[k + 1]; ++p)
+            ++score[m_postings[p]];
+    }
+}
+
+std::vector<uint32_t> PatchSearch::search(std::string_view query) const
+{
+    const Parsed q = parse(query);
+
+    std::vector<uint8_t> mask(m_count, 1);
+    for (const auto& f : q.filters) applyFilter(f, mask);
+
+    std::vector<uint32_t> result;
+    if (q.text.empty()) {
+        for (size_t i = 0; i < m_count; ++i)
+            if (mask[i]) result.push_back(uint32_t(i));
+        return result;
+    }
+
+    std::string needle;
+    for (char c : q.text) needle.push_back(char(std::tolower(uint8_t(c))));
+
+    // Short queries have at most one inner trigram – plain substring scan
+    if (needle.size() < 3) {
+        for (size_t i = 0; i < m_count; ++i)
+            if (mask[i] && m_text[i].find(needle) != std::string::npos) result.push_back(uint32_t(i));
+        return result;
+    }
+
+    std::vector<uint16_t> score(m_count, 0);
+    matchText(q.text, score);
+
+    // Padded query of n chars has n trigrams; require half of them
+    const int total   = int(needle.size());
+    const int minHits = std::max(2, (total + 1) / 2);
+
+    std::vector<std::pair<int, uint32_t>> ranked;   // (-rank, index)
+    for (size_t i = 0; i < m_count; ++i) {
+        if (!mask[i] || score[i] < minHits) continue;
+        // An exact substring always outranks a fuzzy match
+        const bool exact = m_text[i].find(needle) != std::string::npos;
+        ranked.emplace_back(-(int(score[i]) + (exact ? 1000 : 0)), uint32_t(i));
+    }
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    result.reserve(ranked.size());
+    for (const auto& r : ranked) result.push_back(r.second);
+    return result;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "PatchIndex.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PatchSearch  –  name/tag search and parameter filters over a patch list
+//
+// Text: every name + tags string is lower-cased and split into trigrams; an
+// inverted index (trigram → sorted item list) finds candidates, and items
+// are ranked by the share of the query's trigrams they contain, so typos
+// and word order still match ("slpa bass" finds "Slap Bass"). Queries
+// shorter than three characters fall back to a substring scan.
+//
+// Filters: the patch parameters are kept as a structure of arrays – one
+// contiguous uint8_t array per parameter (per operator for operator
+// parameters) – and each filter is a branch-free pass over one or four of
+// them into a byte mask, which compilers vectorise.
+//
+// Query syntax, whitespace separated; anything that is not a filter is text:
+//   alg=4  fb>=5  ams!=0           global parameters
+//   ssg>0  tl<10                   any operator matches
+//   op2.tl<=20  op4.ar=31          one operator (OP1..OP4, UI order)
+//   car.tl<10  mod.tl>100          any carrier / any modulator
+// Operators: = != < <= > >=
+// ─────────────────────────────────────────────────────────────────────────────
+class PatchSearch
+{
+public:
+    struct Item {
+        std::string        text;     // name and tags, any case
+        PatchIndex::Record record;   // only the patch fields are used
+    };
+
+    void build(const std::vector<Item>& items);
+
+    size_t size() const { return m_count; }
+
+    // Matching item indices, best text match first (then in list order).
+    // An empty query returns every item.
+    std::vector<uint32_t> search(std::string_view query) const;
+
+    // Only the filter part of a query, as an error string for the UI
+    // ("" if every filter token parsed)
+    static std::string checkQuery(std::string_view query);
+
+private:
+    enum Param { DT, MUL, TL, RS, AR, AM, DR, SR, SL, RR, SSG, kNumOpParams };
+    enum Global { ALG, FB, AMS, FMS, kNumGlobals };
+    enum class Scope { global, op, anyOp, carriers, modulators };
+    enum class Cmp { eq, ne, lt, le, gt, ge };
+
+    struct Filter {
+        Scope scope;
+        int   param;    // Global or Param
+        int   op;       // 0-3 for Scope::op
+        Cmp   cmp;
+        int   value;
+    };
+
+    struct Parsed {
+        std::vector<Filter> filters;
+        std::string         text;
+        std::string         error;
+    };
+
+    static Parsed parse(std::string_view query);
+    static bool   parseFilter(std::string_view token, Filter& f, std::string& error);
+
+    void applyFilter(const Filter& f, std::vector<uint8_t>& mask) const;
+    void matchText(const std::string& text, std::vector<uint16_t>& score) const;
+
+    static uint32_t trigram(const char* p)
+    {
+        return (uint32_t(uint8_t(p[0])) << 16) | (uint32_t(uint8_t(p[1])) << 8) | uint8_t(p[2]);
+    }
+
+    size_t m_count = 0;
+
+    // Structure of arrays, m_count entries each
+    std::vector<uint8_t> m_global[kNumGlobals];
+    std::vector<uint8_t> m_op[4][kNumOpParams];
+    std::vector<uint8_t> m_carrierMask;           // bit n = OP(n+1) is a carrier
+
+    // Lower-cased text, for the short-query substring scan
+    std::vector<std::string> m_text;
+
+    // Trigram index in CSR form: m_keys sorted, postings for m_keys[k] are
+    // m_postings[m_offsets[k] .. m_offsets[k+1])
+    std::vector<uint32_t> m_keys;
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint32_t> m_postings;
+};
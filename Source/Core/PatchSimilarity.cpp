@@ -0,0 +1,38 @@
+#include "PatchSimilarity.h"
+
+#include <cstring>
+#include <limits>
+
+void PatchSimilarity::build(const std::vector<const float*>& features)
+{
+    m_rows.assign(features.size() * kFeatures, 0.0f);
+    m_valid.assign(features.size(), 0);
+    for (size_t i = 0; i < features.size(); ++i) {
+        if (features[i] == nullptr) continue;
+        std::memcpy(m_rows.data() + i * kFeatures, features[i], sizeof(float) * kFeatures);
+        m_valid[i] = 1;
+    }
+}
+
+std::vector<float> PatchSimilarity::distances(const float* query) const
+{
+    const size_t n = size();
+    std::vector<float> out(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        const float* row = m_rows.data() + i * kFeatures;
+        float acc[kLanes] {};
+        for (int k = 0; k < kFeatures; k += kLanes)
+            for (int l = 0; l < kLanes; ++l) {
+                const float d = row[k + l] - query[k + l];
+                acc[l] += d * d;
+            }
+        float sum = 0.0f;
+        for (float a : acc) sum += a;
+        out[i] = sum;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        if (!m_valid[i]) out[i] = std::numeric_limits<float>::infinity();
+    return out;
+}
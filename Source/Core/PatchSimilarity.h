@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "PatchThumbnail.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PatchSimilarity  –  nearest-neighbour ranking over thumbnail features
+//
+// Feature vectors (PatchThumbnail::Thumbnail::features) are copied into
+// one flat row-major array, kFeatures floats per item. distances() computes the
+// squared Euclidean distance from the query to every row: kLanes
+// independent accumulators across each row keep the inner loop free of
+// dependencies, so compilers turn it into packed SIMD. Items without a
+// vector get infinity, so they sort last.
+// ─────────────────────────────────────────────────────────────────────────────
+class PatchSimilarity
+{
+public:
+    static constexpr int kFeatures = PatchThumbnail::kFeatures;
+
+    // features[i] may be nullptr (not rendered yet)
+    void build(const std::vector<const float*>& features);
+
+    size_t size() const { return m_valid.size(); }
+
+    // Distance of every item to the query; items without a vector get
+    // infinity
+    std::vector<float> distances(const float* query) const;
+
+private:
+    static constexpr int kLanes = 8;
+    static_assert(kFeatures % kLanes == 0, "features must split into lanes");
+
+    std::vector<float>   m_rows;    // size() × kFeatures
+    std::vector<uint8_t> m_valid;
+};
@@ -0,0 +1,170 @@
+#include "PatchThumbnail.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstring>
+
+namespace PatchThumbnail {
+
+static constexpr char     kMagic[4] = { 'A', '2', '6', 'T' };
+static constexpr uint32_t kVersion  = 2;
+
+struct Header {
+    char     magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t size;
+};
+
+static_assert(sizeof(Header) == 16, "PatchThumbnail::Header layout");
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Spectrum features
+// ─────────────────────────────────────────────────────────────────────────────
+// In-place iterative radix-2 FFT, n a power of two
+static void fft(std::vector<std::complex<float>>& x)
+{
+    const size_t n = x.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(x[i], x[j]);
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const float angle = -2.0f * 3.14159265358979f / float(len);
+        const std::complex<float> step(std::cos(angle), std::sin(angle));
+        for (size_t i = 0; i < n; i += len) {
+            std::complex<float> w(1.0f, 0.0f);
+            for (size_t k = 0; k < len / 2; ++k) {
+                const auto a = x[i + k];
+                const auto b = x[i + k + len / 2] * w;
+                x[i + k]           = a + b;
+                x[i + k + len / 2] = a - b;
+                w *= step;
+            }
+        }
+    }
+}
+
+// Hann-windowed frame of kFftSize samples → kBands features into out
+static void spectrumFeatures(const float* frame, double rate, float* out)
+{
+    std::vector<std::complex<float>> x(kFftSize);
+    for (int i = 0; i < kFftSize; ++i) {
+        const float w = 0.5f - 0.5f * std::cos(2.0f * 3.14159265358979f * i / (kFftSize - 1));
+        x[size_t(i)] = frame[i] * w;
+    }
+    fft(x);
+
+    double power[kBands] {};
+    double total = 0.0;
+    const double binHz = rate / kFftSize;
+    int lo = 1;
+    for (int b = 0; b < kBands; ++b) {
+        const double edge = 60.0 * std::pow(16000.0 / 60.0, double(b + 1) / kBands);
+        const int hi = std::clamp(int(edge / binHz), lo + 1, kFftSize / 2);
+        for (int k = lo; k < hi; ++k) power[b] += std::norm(x[size_t(k)]);
+        total += power[b];
+        lo = hi;
+    }
+
+    for (int b = 0; b < kBands; ++b) {
+        const double share = total > 0.0 ? power[b] / total : 0.0;
+        const double db    = share > 0.0 ? 10.0 * std::log10(share) : -60.0;
+        out[b] = float(std::clamp(1.0 + db / 60.0, 0.0, 1.0));
+    }
+}
+
+Thumbnail render(const Ym2612Engine::RegisterImage& img, uint64_t hash)
+{
+    const double rate        = Ym2612Engine::CHIP_RATE;
+    Ym2612Engine engine;
+    engine.setRegisterImage(img);
+
+    const int holdSamples    = int(kHoldSeconds * rate);
+    const int releaseSamples = int(std::min(engine.getTailSeconds(), kReleaseSeconds) * rate) + 1;
+    const int total          = int((kHoldSeconds + kReleaseSeconds) * rate);
+
+    std::vector<float> buffer(size_t(total), 0.0f);
+    float* dst[1] = { buffer.data() };
+    engine.startNote(kNote, rate, 1);
+    engine.render(dst, holdSamples, 1.0f);
+    engine.stopNote();
+    float* tail[1] = { buffer.data() + holdSamples };
+    engine.render(tail, std::min(releaseSamples, total - holdSamples), 1.0f);
+
+    Thumbnail t {};
+    t.hash = hash;
+
+    double sumSquares = 0.0;
+    for (int b = 0; b < kBins; ++b) {
+        const int from = int(int64_t(total) * b / kBins);
+        const int to   = int(int64_t(total) * (b + 1) / kBins);
+        float binPeak = 0.0f;
+        for (int i = from; i < to; ++i) {
+            const float v = buffer[size_t(i)];
+            binPeak     = std::max(binPeak, std::abs(v));
+            sumSquares += double(v) * v;
+        }
+        t.peak = std::max(t.peak, binPeak);
+
+        const float db = binPeak > 0.0f ? 20.0f * std::log10(binPeak) : kFloorDb;
+        t.envelope[b]  = uint8_t(std::lround(std::clamp(1.0f - db / kFloorDb, 0.0f, 1.0f) * 255.0f));
+    }
+    t.rms = float(std::sqrt(sumSquares / total));
+
+    spectrumFeatures(buffer.data(), rate, t.features);
+    spectrumFeatures(buffer.data() + std::max(0, holdSamples - kFftSize), rate, t.features + kBands);
+    constexpr int perPoint = kBins / kEnvelopePoints;
+    for (int p = 0; p < kEnvelopePoints; ++p) {
+        int sum = 0;
+        for (int b = 0; b < perPoint; ++b) sum += t.envelope[p * perPoint + b];
+        t.features[2 * kBands + p] = float(sum) / (255.0f * perPoint);
+    }
+    return t;
+}
+
+float envelopeGain(uint8_t v)
+{
+    if (v == 0) return 0.0f;
+    return std::pow(10.0f, (1.0f - v / 255.0f) * kFloorDb / 20.0f);
+}
+
+bool read(const void* data, size_t size, std::vector<Thumbnail>& out)
+{
+    out.clear();
+    if (data == nullptr || size < sizeof(Header)) return false;
+
+    Header h;
+    std::memcpy(&h, data, sizeof(h));
+    if (std::memcmp(h.magic, kMagic, 4) != 0 || h.version != kVersion || h.size != sizeof(Thumbnail)
+        || uint64_t(h.count) * sizeof(Thumbnail) != size - sizeof(Header))
+        return false;
+
+    out.resize(h.count);
+    if (h.count > 0)
+        std::memcpy(out.data(), static_cast<const uint8_t*>(data) + sizeof(Header), h.count * sizeof(Thumbnail));
+    return true;
+}
+
+std::vector<uint8_t> write(std::vector<Thumbnail> thumbs)
+{
+    std::sort(thumbs.begin(), thumbs.end(),
+              [](const Thumbnail& a, const Thumbnail& b) { return a.hash < b.hash; });
+
+    Header h {};
+    std::memcpy(h.magic, kMagic, 4);
+    h.version = kVersion;
+    h.count   = uint32_t(thumbs.size());
+    h.size    = sizeof(Thumbnail);
+
+    std::vector<uint8_t> out(sizeof(Header) + thumbs.size() * sizeof(Thumbnail));
+    std::memcpy(out.data(), &h, sizeof(h));
+    if (!thumbs.empty())
+        std::memcpy(out.data() + sizeof(Header), thumbs.data(), thumbs.size() * sizeof(Thumbnail));
+    return out;
+}
+
+} // namespace PatchThumbnail
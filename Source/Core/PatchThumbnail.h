@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Ym2612Engine.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PatchThumbnail  –  audition summary of a patch for the browser
+//
+// render() plays a reference note (middle C, full velocity) through a
+// private Ym2612Engine at the chip rate: kHoldSeconds key-down, then up to
+// kReleaseSeconds of release. The result is reduced to peak and RMS over
+// the whole render and an envelope of kBins per-bin peaks in dB, mapped
+// -48..0 dB → 0..255 so quiet tails still show.
+//
+// The same render yields a feature vector for similarity search
+// (PatchSimilarity), kFeatures floats in 0..1:
+//   [0, 24)   spectrum of the attack (first kFftSize samples)
+//   [24, 48)  spectrum just before key-off
+//   [48, 64)  the envelope, 16 points
+// Each spectrum is the share of the frame's energy in kBands log-spaced
+// bands (60 Hz – 16 kHz) in dB, -60..0 → 0..1, so loudness does not count,
+// only timbre and its change over the note.
+//
+// Thumbnails are keyed by the patch record's canonicalHash (PatchIndex), so
+// a changed patch misses the cache and is rendered again, and duplicates
+// share one thumbnail.
+//
+// The cache file is a 16-byte header (magic "A26T", version, count, size)
+// followed by thumbnails sorted by hash.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace PatchThumbnail {
+
+static constexpr int    kBins           = 48;
+static constexpr double kHoldSeconds    = 0.3;
+static constexpr double kReleaseSeconds = 0.3;
+static constexpr int    kNote           = 60;
+static constexpr float  kFloorDb        = -48.0f;
+
+static constexpr int    kFftOrder       = 11;
+static constexpr int    kFftSize        = 1 << kFftOrder;
+static constexpr int    kBands          = 24;
+static constexpr int    kEnvelopePoints = 16;
+static constexpr int    kFeatures       = 2 * kBands + kEnvelopePoints;
+
+struct Thumbnail {
+    uint64_t hash;                // PatchIndex::Record::canonicalHash
+    float    peak;                // linear, whole render
+    float    rms;
+    uint8_t  envelope[kBins];     // per-bin peak, kFloorDb..0 dB → 0..255
+    float    features[kFeatures];
+};
+
+static_assert(sizeof(Thumbnail) == 320, "PatchThumbnail::Thumbnail layout");
+
+// Renders the reference note; safe to call from any thread
+Thumbnail render(const Ym2612Engine::RegisterImage& img, uint64_t hash);
+
+// Envelope byte back to linear gain (0 for the floor)
+float envelopeGain(uint8_t v);
+
+// Cache file. read() accepts any valid file and returns false otherwise;
+// write() sorts by hash.
+bool                 read(const void* data, size_t size, std::vector<Thumbnail>& out);
+std::vector<uint8_t> write(std::vector<Thumbnail> thumbs);
+
+} // namespace PatchThumbnail
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// SpscRing  –  fixed-capacity single-producer / single-consumer queue
+//
+// Storage is allocated once in the constructor; push() and pop() never
+// allocate, lock or block, so the producer can be the audio thread. A full
+// ring drops the new item and push() returns false.
+//
+// Capacity is rounded up to a power of two.
+// ─────────────────────────────────────────────────────────────────────────────
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t capacity)
+    {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        m_items.resize(n);
+        m_mask = n - 1;
+    }
+
+    // Producer thread only
+    bool push(const T& item)
+    {
+        const size_t w = m_write.load(std::memory_order_relaxed);
+        if (w - m_read.load(std::memory_order_acquire) > m_mask) return false;
+        m_items[w & m_mask] = item;
+        m_write.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool pop(T& item)
+    {
+        const size_t r = m_read.load(std::memory_order_relaxed);
+        if (r == m_write.load(std::memory_order_acquire)) return false;
+        item = m_items[r & m_mask];
+        m_read.store(r + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only: drops everything queued so far
+    void discard() { m_read.store(m_write.load(std::memory_order_acquire), std::memory_order_release); }
+
+    size_t capacity() const { return m_mask + 1; }
+
+private:
+    std::vector<T>      m_items;
+    size_t              m_mask = 0;
+    std::atomic<size_t> m_write { 0 };
+    std::atomic<size_t> m_read  { 0 };
+};
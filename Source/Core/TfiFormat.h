@@ -0,0 +1,70 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// TfiFormat.h  –  TFM Music Maker instrument (.tfi)
+//
+// 42 bytes, no header and no name:
+//   [0]  algorithm
+//   [1]  feedback
+//   4 operators in slot order (OP1, OP3, OP2, OP4), 10 bytes each:
+//     MUL, DT (0..6, 3 = none), TL, RS, AR, DR, SR, RR, SL, SSG-EG
+//
+// The format has no AM flag; AM decodes as off and is not written.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "PatchCodec.h"
+
+namespace TfiFormat {
+
+static constexpr size_t kSize = 42;
+
+inline bool decode(const uint8_t* data, size_t size, PatchData& out)
+{
+    if (data == nullptr || size != kSize) return false;
+
+    out = PatchData();
+    out.patch.ALG = data[0] & 7;
+    out.patch.FB  = data[1] & 7;
+
+    for (int slot = 0; slot < 4; ++slot) {
+        const uint8_t* p = data + 2 + slot * 10;
+        auto& o = out.patch.op[PatchCodecs::kSlotToUi[slot]];
+        o.MUL = p[0] & 0x0F;
+        o.DT  = PatchCodecs::dtFromCentred(p[1]);
+        o.TL  = p[2] & 0x7F;
+        o.RS  = p[3] & 3;
+        o.AR  = p[4] & 0x1F;
+        o.DR  = p[5] & 0x1F;
+        o.SR  = p[6] & 0x1F;
+        o.RR  = p[7] & 0x0F;
+        o.SL  = p[8] & 0x0F;
+        o.SSG = PatchCodecs::ssgFromRegister(p[9]);
+        o.AM  = 0;
+    }
+    return true;
+}
+
+inline std::vector<uint8_t> encode(const PatchData& in)
+{
+    std::vector<uint8_t> out(kSize, 0);
+    out[0] = uint8_t(in.patch.ALG & 7);
+    out[1] = uint8_t(in.patch.FB & 7);
+
+    for (int slot = 0; slot < 4; ++slot) {
+        uint8_t* p = out.data() + 2 + slot * 10;
+        const auto& o = in.patch.op[PatchCodecs::kSlotToUi[slot]];
+        p[0] = uint8_t(o.MUL & 0x0F);
+        p[1] = uint8_t(PatchCodecs::dtToCentred(o.DT));
+        p[2] = uint8_t(o.TL & 0x7F);
+        p[3] = uint8_t(o.RS & 3);
+        p[4] = uint8_t(o.AR & 0x1F);
+        p[5] = uint8_t(o.DR & 0x1F);
+        p[6] = uint8_t(o.SR & 0x1F);
+        p[7] = uint8_t(o.RR & 0x0F);
+        p[8] = uint8_t(o.SL & 0x0F);
+        p[9] = uint8_t(PatchCodecs::ssgToRegister(o.SSG));
+    }
+    return out;
+}
+
+} // namespace TfiFormat
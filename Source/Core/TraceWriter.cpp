@@ -0,0 +1,62 @@
+#include "TraceWriter.h"
+
+TraceWriter::~TraceWriter()
+{
+    if (m_file != nullptr) std::fclose(m_file);
+}
+
+bool TraceWriter::open(const std::string& path, std::string& error)
+{
+    if (m_file != nullptr) std::fclose(m_file);
+    m_file = std::fopen(path.c_str(), "w");
+    if (m_file == nullptr) {
+        error = "cannot write " + path;
+        return false;
+    }
+    m_originNs = Tracer::nowNs();
+    m_first    = true;
+    m_ok       = std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", m_file) >= 0;
+    if (!m_ok) error = "write failed: " + path;
+    return m_ok;
+}
+
+void TraceWriter::drain(Tracer& tracer)
+{
+    if (m_file == nullptr) return;
+    tracer.drain([this](int thread, const Tracer::Event& e) { writeEvent(thread, e); });
+}
+
+void TraceWriter::writeEvent(int thread, const Tracer::Event& e)
+{
+    // Events from different threads arrive out of order; the viewer sorts them
+    const double ts  = (double(e.beginNs) - double(m_originNs)) / 1000.0;
+    const double dur = double(e.endNs - e.beginNs) / 1000.0;
+
+    if (std::fprintf(m_file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                     m_first ? "" : ",\n", e.name, thread, ts, dur) < 0)
+        m_ok = false;
+    m_first = false;
+}
+
+bool TraceWriter::finish(const Tracer& tracer)
+{
+    if (m_file == nullptr) return false;
+
+    for (int t = 0; t < tracer.numThreads(); ++t) {
+        const char* name = tracer.threadName(t);
+        const int   rc   = name != nullptr
+            ? std::fprintf(m_file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                           m_first ? "" : ",\n", t, name)
+            : std::fprintf(m_file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+                           m_first ? "" : ",\n", t, t);
+        if (rc < 0) m_ok = false;
+        m_first = false;
+    }
+    if (std::fprintf(m_file, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"ARM2612\"}}\n]}\n",
+                     m_first ? "" : ",\n") < 0)
+        m_ok = false;
+
+    if (std::fclose(m_file) != 0) m_ok = false;
+    m_file = nullptr;
+    return m_ok;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "Tracer.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// TraceWriter  –  writes Tracer events as a Chrome trace-event JSON file
+//
+// The output loads in chrome://tracing and ui.perfetto.dev: one "X"
+// (complete) event per scope, one track per traced thread, named through
+// "thread_name" metadata. Timestamps are microseconds since open(). Runs
+// on a background thread; drain() as often as needed.
+// ─────────────────────────────────────────────────────────────────────────────
+class TraceWriter
+{
+public:
+    ~TraceWriter();
+
+    bool open(const std::string& path, std::string& error);
+
+    // Writes everything the tracer has buffered so far
+    void drain(Tracer& tracer);
+
+    // Thread names, closing bracket; false if any write failed
+    bool finish(const Tracer& tracer);
+
+    bool isOpen() const { return m_file != nullptr; }
+
+private:
+    void writeEvent(int thread, const Tracer::Event& e);
+
+    std::FILE* m_file     = nullptr;
+    uint64_t   m_originNs = 0;
+    bool       m_first    = true;
+    bool       m_ok       = false;
+};
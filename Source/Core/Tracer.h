@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "SpscRing.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tracer.h  –  scoped timeline events from any thread, for Chrome/Perfetto
+//
+// Built only with ARM2612_TRACE=1 (CMake: -DARM2612_TRACE=ON). Without it
+// the ARM2612_TRACE_* macros expand to nothing.
+//
+//   ARM2612_TRACE_THREAD("audio");          // names the calling thread once
+//   ARM2612_TRACE_SCOPE("processBlock");    // one complete event per scope
+//
+// Each thread gets its own SpscRing from a fixed pool the first time it
+// records, so recording never locks or allocates: a thread claims a free
+// slot with one compare-exchange and then is the only producer of that
+// ring. A thread gives its slot back when it exits, so hosts that rotate
+// audio worker threads keep finding one; the next thread to claim it shares
+// its track. Events are only recorded between start() and stop().
+//
+// The tracer is process-wide, so several plugin instances share one
+// timeline – and one drainer: the rings have a single consumer, so only the
+// holder of claimWriter() may call start(), stop() and drain().
+//
+// Event and thread names must be string literals (only the pointer is stored).
+// ─────────────────────────────────────────────────────────────────────────────
+
+#ifndef ARM2612_TRACE
+ #define ARM2612_TRACE 0
+#endif
+
+class Tracer
+{
+public:
+    static constexpr int    kMaxThreads     = 16;
+    static constexpr size_t kEventsPerThread = 8192;
+
+    struct Event {
+        const char* name    = nullptr;
+        uint64_t    beginNs = 0;
+        uint64_t    endNs   = 0;
+    };
+
+    // Create it early (plugin constructor) – the ring pool is allocated here
+    static Tracer& get()
+    {
+        static Tracer instance;
+        return instance;
+    }
+
+    static uint64_t nowNs()
+    {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // ── Writer side ──────────────────────────────────────────────────────────
+    // One drainer at a time: false if another one holds the claim
+    bool claimWriter()
+    {
+        bool expected = false;
+        return m_writerClaimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel);
+    }
+    void releaseWriter() { m_writerClaimed.store(false, std::memory_order_release); }
+
+    void start() { m_dropped.store(0); m_active.store(true, std::memory_order_release); }
+    void stop()  { m_active.store(false, std::memory_order_release); }
+    bool isActive() const { return m_active.load(std::memory_order_relaxed); }
+
+    // Slots that have ever been claimed; a name is nullptr for unnamed threads
+    int         numThreads() const { return m_numSlots.load(std::memory_order_acquire); }
+    const char* threadName(int slot) const { return m_slots[size_t(slot)].name.load(std::memory_order_acquire); }
+    uint64_t    droppedEvents() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // Pops everything recorded so far: fn(threadSlot, event)
+    template <typename Fn>
+    void drain(Fn&& fn)
+    {
+        const int n = numThreads();
+        for (int s = 0; s < n; ++s) {
+            auto& slot = m_slots[size_t(s)];
+            if (!slot.ready.load(std::memory_order_acquire)) continue;
+            Event e;
+            while (slot.events.pop(e)) fn(s, e);
+        }
+    }
+
+    // ── Any thread ───────────────────────────────────────────────────────────
+    void nameThread(const char* name)
+    {
+        if (t_slot.index < 0) claimSlot(name);
+    }
+
+    void record(const char* name, uint64_t beginNs, uint64_t endNs)
+    {
+        if (t_slot.index < 0 && !claimSlot(nullptr)) { m_dropped.fetch_add(1, std::memory_order_relaxed); return; }
+        if (!m_slots[size_t(t_slot.index)].events.push({ name, beginNs, endNs }))
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char* n) : name(n), begin(Tracer::get().isActive() ? nowNs() : 0) {}
+        ~Scope()
+        {
+            if (begin != 0 && Tracer::get().isActive())
+                Tracer::get().record(name, begin, nowNs());
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char*    name;
+        const uint64_t begin;
+    };
+
+private:
+    Tracer() = default;
+
+    struct Slot {
+        SpscRing<Event>          events { kEventsPerThread };
+        std::atomic<const char*> name   { nullptr };
+        std::atomic<bool>        owned  { false };   // a live thread produces into it
+        std::atomic<bool>        ready  { false };   // has been claimed at least once
+    };
+
+    // The calling thread's slot; gives it back when the thread exits. Events
+    // still in the ring are drained as usual.
+    struct ThreadSlot {
+        int index;
+        constexpr ThreadSlot() : index(-1) {}
+        ~ThreadSlot()
+        {
+            if (index >= 0) Tracer::get().m_slots[size_t(index)].owned.store(false, std::memory_order_release);
+        }
+    };
+
+    bool claimSlot(const char* name)
+    {
+        for (int s = 0; s < kMaxThreads; ++s) {
+            auto& slot = m_slots[size_t(s)];
+            bool expected = false;
+            if (!slot.owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) continue;
+
+            if (name != nullptr) slot.name.store(name, std::memory_order_release);
+            slot.ready.store(true, std::memory_order_release);
+
+            int n = m_numSlots.load(std::memory_order_relaxed);
+            while (n < s + 1 && !m_numSlots.compare_exchange_weak(n, s + 1, std::memory_order_acq_rel)) {}
+            t_slot.index = s;
+            return true;
+        }
+        return false;   // every slot is held by a live thread
+    }
+
+    std::array<Slot, kMaxThreads> m_slots;
+    std::atomic<int>      m_numSlots { 0 };
+    std::atomic<bool>     m_active { false };
+    std::atomic<bool>     m_writerClaimed { false };
+    std::atomic<uint64_t> m_dropped { 0 };
+
+    static inline thread_local ThreadSlot t_slot;
+};
+
+#if ARM2612_TRACE
+ #define ARM2612_TRACE_CONCAT_(a, b) a##b
+ #define ARM2612_TRACE_CONCAT(a, b)  ARM2612_TRACE_CONCAT_(a, b)
+ #define ARM2612_TRACE_SCOPE(name)   const Tracer::Scope ARM2612_TRACE_CONCAT(traceScope_, __LINE__) { name }
+ #define ARM2612_TRACE_THREAD(name)  Tracer::get().nameThread(name)
+#else
+ #define ARM2612_TRACE_SCOPE(name)
+ #define ARM2612_TRACE_THREAD(name)
+#endif
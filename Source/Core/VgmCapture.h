@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "SpscRing.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// VgmCapture  –  real-time log of every register write the voices make
+//
+// Each plugin voice drives its own chip on channel 0. For the log they are
+// folded onto one YM2612: voice n becomes hardware channel n (0-2 on port 0,
+// 3-5 on port 1), and key-on channel select bits are remapped to match.
+// Voices beyond the sixth are not captured.
+//
+// Audio thread: beginBlock() / setBlockOffset() keep a host-sample clock,
+// write() stamps each register write with the matching chip sample and
+// stages it in time order; flush() moves the staged writes into a
+// preallocated SpscRing. Voices render one after another, so a later
+// voice's macro tick can be stamped before writes an earlier voice made in
+// the same span – staging keeps the ring monotonic. Nothing allocates or
+// blocks.
+//
+// Writer thread: start() arms the capture (the next block restarts the
+// clock at zero), pop() drains the ring, stop() disarms it. The writer turns
+// the stream into a file with VgmWriter. Every note programs its channel
+// from scratch, so notes already held when a capture starts are left out.
+// ─────────────────────────────────────────────────────────────────────────────
+class VgmCapture
+{
+public:
+    struct Write {
+        uint64_t chipTime;   // chip samples since the capture started
+        uint8_t  port;       // 0 or 1
+        uint8_t  reg;
+        uint8_t  value;
+    };
+
+    static constexpr int kNumChannels = 6;
+
+    explicit VgmCapture(size_t ringCapacity = 1 << 16) : m_ring(ringCapacity), m_staged(kStageCapacity) {}
+
+    // ── Writer thread (the ring's only consumer) ─────────────────────────────
+    void start()
+    {
+        m_ring.discard();
+        m_dropped.store(0);
+        m_state.store(armed);
+    }
+    void stop() { m_state.store(idle); }
+
+    bool isCapturing() const { return m_state.load() != idle; }
+    bool pop(Write& w)       { return m_ring.pop(w); }
+
+    // Writes lost to a full ring since start()
+    int      droppedWrites() const { return m_dropped.load(); }
+    uint64_t currentChipTime() const { return m_published.load(std::memory_order_relaxed); }
+
+    // ── Audio thread ─────────────────────────────────────────────────────────
+    void setSampleRates(double hostRate, double chipRate) { m_chipPerHost = chipRate / hostRate; }
+
+    void beginBlock(int numSamples)
+    {
+        int expected = armed;
+        if (m_state.compare_exchange_strong(expected, running)) {
+            m_blockStart = 0;
+            m_blockLen   = 0;
+            m_numStaged  = 0;
+        }
+        flush();
+        m_blockStart += uint64_t(m_blockLen);
+        m_blockLen    = numSamples;
+        setBlockOffset(0);
+    }
+
+    // Position inside the current block that subsequent writes belong to
+    void setBlockOffset(int offset)
+    {
+        m_now = uint64_t(double(m_blockStart + uint64_t(offset)) * m_chipPerHost);
+        m_published.store(m_now, std::memory_order_relaxed);
+    }
+
+    // A write to channel 0 of the voice's chip, as the engine makes it
+    void write(int channel, uint8_t reg, uint8_t value)
+    {
+        if (m_state.load(std::memory_order_relaxed) != running || channel >= kNumChannels) return;
+
+        uint8_t port = 0;
+        if (reg == 0x28) {
+            // Key on/off: low bits select the channel (0-2, 4-6)
+            value = uint8_t((value & 0xF0) | (channel < 3 ? channel : channel + 1));
+        } else if (reg >= 0x30) {
+            // Channel / operator registers: low two bits select the channel
+            port = uint8_t(channel / 3);
+            reg  = uint8_t(reg + channel % 3);
+        }
+
+        if (m_numStaged == m_staged.size()) flush();
+
+        // Insert after every write stamped at or before m_now, so writes
+        // with equal stamps keep the order they were made in
+        size_t i = m_numStaged++;
+        for (; i > 0 && m_staged[i - 1].chipTime > m_now; --i)
+            m_staged[i] = m_staged[i - 1];
+        m_staged[i] = { m_now, port, reg, value };
+    }
+
+    // Hands the staged writes to the writer. Call at the end of each render
+    // span, once no write earlier than the span's end can still arrive.
+    void flush()
+    {
+        for (size_t i = 0; i < m_numStaged; ++i)
+            if (!m_ring.push(m_staged[i]))
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+        m_numStaged = 0;
+    }
+
+private:
+    enum State { idle, armed, running };
+
+    static constexpr size_t kStageCapacity = 1024;
+
+    SpscRing<Write>       m_ring;
+    std::atomic<int>      m_state     { idle };
+    std::atomic<int>      m_dropped   { 0 };
+    std::atomic<uint64_t> m_published { 0 };
+
+    // Writes of the current render span, sorted by chipTime
+    std::vector<Write>    m_staged;
+    size_t                m_numStaged = 0;
+
+    // Audio thread clock
+    double   m_chipPerHost = 1.0;
+    uint64_t m_blockStart  = 0;
+    int      m_blockLen    = 0;
+    uint64_t m_now         = 0;
+};
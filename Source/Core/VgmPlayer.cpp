@@ -0,0 +1,284 @@
+#include "VgmPlayer.h"
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr size_t kReadWindow = 16 * 1024;
+
+VgmPlayer::VgmPlayer()
+    : m_chip(m_interface)
+{
+    m_buf.resize(kReadWindow);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Header
+//
+//   0x00 "Vgm "   0x04 EOF offset (rel)   0x08 version (BCD)
+//   0x10 YM2413 clock – also the YM2612 clock before v1.10
+//   0x18 total samples   0x1C loop offset (rel)   0x20 loop samples
+//   0x2C YM2612 clock (v1.10+)   0x34 data offset (rel, v1.50+)
+// ─────────────────────────────────────────────────────────────────────────────
+bool VgmPlayer::open(std::unique_ptr<VgmSource> source, std::string& error)
+{
+    m_source   = std::move(source);
+    m_finished = true;
+    m_bufPos = m_bufLen = 0;
+
+    uint8_t h[0x40] {};
+    if (m_source == nullptr || m_source->read(h, sizeof h) != sizeof h || std::memcmp(h, "Vgm ", 4) != 0) {
+        error = "not a VGM file";
+        return false;
+    }
+    auto le32 = [&](size_t at) {
+        return uint32_t(h[at]) | uint32_t(h[at + 1]) << 8 | uint32_t(h[at + 2]) << 16 | uint32_t(h[at + 3]) << 24;
+    };
+
+    Info info;
+    info.version      = le32(0x08);
+    info.endOffset    = 0x04 + size_t(le32(0x04));
+    info.totalSamples = le32(0x18);
+    info.loopSamples  = le32(0x20);
+    info.loopOffset   = le32(0x1C) != 0 ? 0x1C + size_t(le32(0x1C)) : 0;
+    info.ym2612Clock  = (info.version >= 0x110) ? le32(0x2C) : le32(0x10);
+    info.dataOffset   = (info.version >= 0x150 && le32(0x34) != 0) ? 0x34 + size_t(le32(0x34)) : 0x40;
+    info.ym2612Clock &= 0x3FFFFFFF;   // bit 30 = dual-chip, bit 31 = chip variant
+
+    if (info.ym2612Clock == 0) {
+        error = "file has no YM2612 part";
+        return false;
+    }
+    if (!m_source->seek(info.dataOffset)) {
+        error = "truncated VGM header";
+        return false;
+    }
+
+    m_info     = info;
+    m_chipRate = m_chip.sample_rate(info.ym2612Clock);
+    m_chip.reset();
+    m_pcm.clear();
+    m_pcmPos      = 0;
+    m_pcmLoadedTo = 0;
+    m_vgmTime  = m_chipDue = m_chipDone = 0;
+    m_finished = false;
+    return true;
+}
+
+uint64_t VgmPlayer::expectedChipSamples() const
+{
+    const uint64_t vgm = uint64_t(m_info.totalSamples)
+                       + (m_info.hasLoop() ? uint64_t(m_info.loopSamples) * uint64_t(std::max(0, m_loopsLeft)) : 0);
+    return vgm * m_chipRate / kVgmRate;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Rendering
+// ─────────────────────────────────────────────────────────────────────────────
+int VgmPlayer::render(float* left, float* right, int numFrames)
+{
+    int produced = 0;
+    while (produced < numFrames) {
+        if (m_chipDone == m_chipDue) {
+            if (m_finished) break;
+            step();
+            continue;
+        }
+
+        const int n = int(std::min<uint64_t>(m_chipDue - m_chipDone, uint64_t(numFrames - produced)));
+        for (int i = 0; i < n; ++i) {
+            ymfm::ym2612::output_data out;
+            m_chip.generate(&out);
+            if (left  != nullptr) left [produced + i] += float(out.data[0]) * m_gain;
+            if (right != nullptr) right[produced + i] += float(out.data[1]) * m_gain;
+        }
+        produced   += n;
+        m_chipDone += n;
+    }
+    return produced;
+}
+
+void VgmPlayer::wait(uint32_t vgmSamples)
+{
+    // Running total keeps rounding from drifting over long files
+    m_vgmTime += vgmSamples;
+    m_chipDue  = m_vgmTime * m_chipRate / kVgmRate;
+}
+
+void VgmPlayer::writeChip(int port, uint8_t reg, uint8_t value)
+{
+    if (port == 0) { m_chip.write_address(reg);    m_chip.write_data(value); }
+    else           { m_chip.write_address_hi(reg); m_chip.write_data_hi(value); }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Command decoding – returns once time advances or the log ends
+// ─────────────────────────────────────────────────────────────────────────────
+void VgmPlayer::step()
+{
+    const uint64_t before = m_vgmTime;
+
+    while (m_vgmTime == before && !m_finished) {
+        const int cmd = next();
+        if (cmd < 0) { m_finished = true; break; }
+
+        switch (cmd) {
+            case 0x52: case 0x53: {                       // YM2612 port 0 / 1
+                const int reg = next(), val = next();
+                if (val < 0) { m_finished = true; break; }
+                writeChip(cmd - 0x52, uint8_t(reg), uint8_t(val));
+                break;
+            }
+            case 0x61: wait(readLE(2)); break;
+            case 0x62: wait(735);       break;            // 1/60 s
+            case 0x63: wait(882);       break;            // 1/50 s
+
+            case 0x66:                                    // end of data
+                if (m_loopsLeft > 0 && m_info.hasLoop() && seekTo(m_info.loopOffset))
+                    --m_loopsLeft;
+                else
+                    m_finished = true;
+                break;
+
+            case 0x67: {                                  // data block
+                const size_t   block = offset() - 1;
+                next();                                   // 0x66 compatibility byte
+                const int      type = next();
+                const uint32_t size = readLE(4) & 0x7FFFFFFF;
+                const size_t   data = offset();
+                if (m_finished) break;
+
+                // The size comes from the file: check it before it is read
+                if (m_info.endOffset != 0 && (data > m_info.endOffset || size > m_info.endOffset - data)) {
+                    m_finished = true;
+                    break;
+                }
+                if (type == 0x00 && block >= m_pcmLoadedTo) {   // YM2612 PCM, not loaded on an earlier pass
+                    if (!appendPcm(size)) m_finished = true;
+                    m_pcmLoadedTo = data + size;
+                } else if (!skip(size)) {
+                    m_finished = true;
+                }
+                break;
+            }
+
+            case 0x64:                       skip(3);  break;   // 0x62/0x63 length override
+            case 0x68:                       skip(11); break;   // PCM RAM write (other chips)
+
+            case 0xE0:                                    // PCM bank seek
+                m_pcmPos = readLE(4);
+                break;
+
+            // DAC stream control – parsed, not emulated
+            case 0x90: case 0x91: case 0x95: skip(4);  break;
+            case 0x92:                       skip(5);  break;
+            case 0x93:                       skip(10); break;
+            case 0x94:                       skip(1);  break;
+
+            default:
+                if (cmd >= 0x70 && cmd <= 0x7F) {         // short wait
+                    wait(uint32_t(cmd & 0x0F) + 1);
+                } else if (cmd >= 0x80 && cmd <= 0x8F) {  // DAC byte from bank, then wait
+                    const uint8_t sample = m_pcmPos < m_pcm.size() ? m_pcm[m_pcmPos] : 0x80;
+                    ++m_pcmPos;
+                    writeChip(0, 0x2A, sample);
+                    if ((cmd & 0x0F) != 0) wait(uint32_t(cmd & 0x0F));
+                } else if (cmd >= 0x30 && cmd <= 0x3F) {  // one operand
+                    skip(1);
+                } else if (cmd == 0x4F || cmd == 0x50) {  // PSG – one operand
+                    skip(1);
+                } else if ((cmd >= 0x40 && cmd <= 0x4E) || (cmd >= 0x51 && cmd <= 0x5F)
+                           || (cmd >= 0xA0 && cmd <= 0xBF)) {
+                    skip(2);                              // other chips – two operands
+                } else if (cmd >= 0xC0 && cmd <= 0xDF) {
+                    skip(3);
+                } else if (cmd >= 0xE1) {
+                    skip(4);
+                } else {
+                    m_finished = true;                    // unknown – stop rather than misparse
+                }
+                break;
+        }
+
+        if (m_info.endOffset != 0 && offset() >= m_info.endOffset
+            && !m_finished && m_vgmTime == before) {
+            // Ran past the header's EOF offset without an end command
+            if (m_loopsLeft > 0 && m_info.hasLoop() && seekTo(m_info.loopOffset)) --m_loopsLeft;
+            else m_finished = true;
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Buffered reader
+// ─────────────────────────────────────────────────────────────────────────────
+bool VgmPlayer::fill()
+{
+    m_bufLen = m_source->read(m_buf.data(), m_buf.size());
+    m_bufPos = 0;
+    return m_bufLen > 0;
+}
+
+int VgmPlayer::next()
+{
+    if (m_bufPos == m_bufLen && !fill()) return -1;
+    return m_buf[m_bufPos++];
+}
+
+bool VgmPlayer::readBytes(uint8_t* dst, size_t n)
+{
+    while (n > 0) {
+        if (m_bufPos == m_bufLen && !fill()) return false;
+        const size_t take = std::min(n, m_bufLen - m_bufPos);
+        std::memcpy(dst, m_buf.data() + m_bufPos, take);
+        m_bufPos += take;
+        dst      += take;
+        n        -= take;
+    }
+    return true;
+}
+
+// Reads a PCM block onto the bank in window-sized steps, so a size the file
+// cannot back never turns into one large allocation
+bool VgmPlayer::appendPcm(size_t n)
+{
+    while (n > 0) {
+        const size_t take = std::min(n, kReadWindow);
+        const size_t at   = m_pcm.size();
+        m_pcm.resize(at + take);
+        if (!readBytes(m_pcm.data() + at, take)) {
+            m_pcm.resize(at);
+            return false;
+        }
+        n -= take;
+    }
+    return true;
+}
+
+size_t VgmPlayer::offset() const
+{
+    return m_source->position() - (m_bufLen - m_bufPos);
+}
+
+bool VgmPlayer::skip(size_t n)
+{
+    const size_t buffered = m_bufLen - m_bufPos;
+    if (n <= buffered) { m_bufPos += n; return true; }
+    return seekTo(m_source->position() + (n - buffered));
+}
+
+uint32_t VgmPlayer::readLE(int bytes)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; ++i) {
+        const int b = next();
+        if (b < 0) { m_finished = true; return 0; }
+        v |= uint32_t(b) << (8 * i);
+    }
+    return v;
+}
+
+bool VgmPlayer::seekTo(size_t offset)
+{
+    m_bufPos = m_bufLen = 0;
+    return m_source->seek(offset);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Ym2612Engine.h"
+#include "VgmSource.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// VgmPlayer  –  plays the YM2612 part of a VGM register log
+//
+// Commands are decoded straight from a VgmSource through a small fixed read
+// buffer, so a multi-megabyte log plays in constant memory. The one
+// exception is YM2612 PCM data blocks (0x67 type 0x00), which are kept for
+// the 0x8n "DAC write + wait" commands that index into them. A block is
+// loaded once – loops that pass it again skip it – and the bank only grows
+// as far as the block's data really goes; a block that claims more than the
+// file has left ends playback.
+//
+// Waits are in 44.1 kHz VGM samples and are converted to chip samples with
+// an exact integer running total, so every register write lands on the
+// same chip sample it would on hardware. Output is at the chip's own rate
+// (clock / 144); render() runs as fast as the CPU allows.
+//
+// Only the YM2612 is emulated; writes to other chips (SN76489 PSG etc.) and
+// the 0x90-0x95 DAC stream commands are parsed and skipped.
+// ─────────────────────────────────────────────────────────────────────────────
+class VgmPlayer
+{
+public:
+    static constexpr uint32_t kVgmRate = 44100;
+
+    struct Info {
+        uint32_t version      = 0;
+        uint32_t totalSamples = 0;   // 44.1 kHz samples, one pass
+        uint32_t loopSamples  = 0;
+        size_t   loopOffset   = 0;   // absolute, 0 = no loop
+        size_t   dataOffset   = 0x40;
+        size_t   endOffset    = 0;   // absolute EOF offset from the header
+        uint32_t ym2612Clock  = 0;   // 0 = file has no YM2612
+
+        bool hasLoop() const { return loopOffset != 0 && loopSamples != 0; }
+    };
+
+    VgmPlayer();
+
+    // Takes ownership of the source and parses the header
+    bool open(std::unique_ptr<VgmSource> source, std::string& error);
+
+    const Info& info() const     { return m_info; }
+    uint32_t    chipRate() const { return m_chipRate; }
+
+    // How many extra times the loop section plays before the end (0 = none)
+    void setLoopCount(int loops) { m_loopsLeft = loops; }
+
+    // Output scale applied to the chip's integer samples
+    void setGain(float gain) { m_gain = gain; }
+
+    // Adds up to numFrames chip-rate frames to left/right (either may be
+    // nullptr). Returns the number of frames produced; fewer than asked
+    // means the log has ended.
+    int render(float* left, float* right, int numFrames);
+
+    bool     finished() const       { return m_finished; }
+    uint64_t chipSamplesPlayed() const { return m_chipDone; }
+
+    // Rendered length in chip samples for one pass plus the configured loops
+    uint64_t expectedChipSamples() const;
+
+private:
+    // ── Buffered reader over the source ──────────────────────────────────────
+    bool    fill();
+    int     next();                      // -1 at end of stream
+    bool    skip(size_t n);
+    bool    readBytes(uint8_t* dst, size_t n);
+    bool    appendPcm(size_t n);
+    size_t  offset() const;              // file offset of the next byte
+    uint32_t readLE(int bytes);
+    bool    seekTo(size_t offset);
+
+    // Decodes commands until a wait is scheduled or the log ends
+    void    step();
+    void    wait(uint32_t vgmSamples);
+    void    writeChip(int port, uint8_t reg, uint8_t value);
+
+    std::unique_ptr<VgmSource> m_source;
+    std::vector<uint8_t>       m_buf;     // fixed read window
+    size_t                     m_bufPos = 0, m_bufLen = 0;
+
+    PluginYmfmInterface m_interface;
+    ymfm::ym2612        m_chip;
+    Info                m_info;
+    uint32_t            m_chipRate = Ym2612Engine::CHIP_RATE;
+    float               m_gain     = 1.0f / 32768.0f;
+
+    std::vector<uint8_t> m_pcm;           // YM2612 PCM data bank
+    size_t               m_pcmPos  = 0;
+    size_t               m_pcmLoadedTo = 0;   // file offset past the last block loaded
+
+    uint64_t m_vgmTime  = 0;             // 44.1 kHz samples consumed
+    uint64_t m_chipDue  = 0;             // chip samples owed up to m_vgmTime
+    uint64_t m_chipDone = 0;             // chip samples rendered
+    int      m_loopsLeft = 0;
+    bool     m_finished  = true;
+};
@@ -0,0 +1,176 @@
+#include "VgmSource.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_WIN32)
+ #define NOMINMAX
+ #include <windows.h>
+#else
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
+#if ARM2612_HAVE_ZLIB
+ #include <zlib.h>
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Memory
+// ─────────────────────────────────────────────────────────────────────────────
+size_t MemoryVgmSource::read(uint8_t* dst, size_t n)
+{
+    n = std::min(n, m_size - m_pos);
+    std::memcpy(dst, m_data + m_pos, n);
+    m_pos += n;
+    return n;
+}
+
+bool MemoryVgmSource::seek(size_t offset)
+{
+    if (offset > m_size) return false;
+    m_pos = offset;
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Memory-mapped file
+// ─────────────────────────────────────────────────────────────────────────────
+std::unique_ptr<MappedFileVgmSource> MappedFileVgmSource::open(const std::string& path, std::string& error)
+{
+    std::unique_ptr<MappedFileVgmSource> src(new MappedFileVgmSource());
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { error = "cannot open " + path; return nullptr; }
+
+    LARGE_INTEGER size {};
+    GetFileSizeEx(file, &size);
+    if (size.QuadPart == 0) { CloseHandle(file); error = path + " is empty"; return nullptr; }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) { error = "cannot map " + path; return nullptr; }
+
+    src->m_data    = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    src->m_mapping = mapping;
+    src->m_size    = size_t(size.QuadPart);
+    if (src->m_data == nullptr) { error = "cannot map " + path; return nullptr; }
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { error = "cannot open " + path; return nullptr; }
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); error = path + " is empty"; return nullptr; }
+
+    void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);   // the mapping keeps the file alive
+    if (p == MAP_FAILED) { error = "cannot map " + path; return nullptr; }
+
+    madvise(p, size_t(st.st_size), MADV_SEQUENTIAL);
+    src->m_data = static_cast<const uint8_t*>(p);
+    src->m_size = size_t(st.st_size);
+#endif
+    return src;
+}
+
+MappedFileVgmSource::~MappedFileVgmSource()
+{
+#if defined(_WIN32)
+    if (m_data != nullptr)    UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr) CloseHandle(static_cast<HANDLE>(m_mapping));
+#else
+    if (m_data != nullptr) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Gzip (.vgz)
+// ─────────────────────────────────────────────────────────────────────────────
+#if ARM2612_HAVE_ZLIB
+std::unique_ptr<GzipFileVgmSource> GzipFileVgmSource::open(const std::string& path, std::string& error)
+{
+    std::unique_ptr<GzipFileVgmSource> src(new GzipFileVgmSource());
+    src->m_path = path;
+    src->m_in.resize(kWindow);
+    src->m_zstream = new z_stream {};
+    if (!src->restart()) { error = "cannot open " + path; return nullptr; }
+    return src;
+}
+
+GzipFileVgmSource::~GzipFileVgmSource()
+{
+    if (auto* zs = static_cast<z_stream*>(m_zstream)) {
+        inflateEnd(zs);
+        delete zs;
+    }
+    if (m_file != nullptr) std::fclose(m_file);
+}
+
+bool GzipFileVgmSource::restart()
+{
+    auto* zs = static_cast<z_stream*>(m_zstream);
+    if (m_file != nullptr) { std::fclose(m_file); inflateEnd(zs); }
+    m_file = std::fopen(m_path.c_str(), "rb");
+    if (m_file == nullptr) return false;
+
+    *zs = z_stream {};
+    if (inflateInit2(zs, 16 + MAX_WBITS) != Z_OK) return false;   // gzip header
+    m_pos = 0;
+    m_eof = false;
+    return true;
+}
+
+size_t GzipFileVgmSource::read(uint8_t* dst, size_t n)
+{
+    auto* zs = static_cast<z_stream*>(m_zstream);
+    zs->next_out  = dst;
+    zs->avail_out = uInt(n);
+
+    while (zs->avail_out > 0 && !m_eof) {
+        if (zs->avail_in == 0) {
+            const size_t got = std::fread(m_in.data(), 1, m_in.size(), m_file);
+            if (got == 0) { m_eof = true; break; }
+            zs->next_in  = m_in.data();
+            zs->avail_in = uInt(got);
+        }
+        const int rc = inflate(zs, Z_NO_FLUSH);
+        if (rc == Z_STREAM_END || (rc != Z_OK && rc != Z_BUF_ERROR)) m_eof = true;
+    }
+
+    const size_t got = n - zs->avail_out;
+    m_pos += got;
+    return got;
+}
+
+bool GzipFileVgmSource::seek(size_t offset)
+{
+    if (offset < m_pos && !restart()) return false;
+
+    uint8_t scratch[4096];
+    while (m_pos < offset)
+        if (read(scratch, std::min(sizeof scratch, offset - m_pos)) == 0) return false;
+    return true;
+}
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+std::unique_ptr<VgmSource> openVgmFile(const std::string& path, std::string& error)
+{
+    auto mapped = MappedFileVgmSource::open(path, error);
+    if (mapped == nullptr) return nullptr;
+
+    const bool gzip = mapped->size() >= 2 && mapped->data()[0] == 0x1F && mapped->data()[1] == 0x8B;
+    if (!gzip) return mapped;
+
+#if ARM2612_HAVE_ZLIB
+    mapped.reset();
+    return GzipFileVgmSource::open(path, error);
+#else
+    error = path + " is gzip-compressed (.vgz) – rebuild with zlib to play it";
+    return nullptr;
+#endif
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// VgmSource.h  –  byte sources for the VGM player
+//
+// A VgmSource hands out the uncompressed VGM byte stream in order. Seeking
+// is only needed for loops, so sources are free to make it expensive:
+//
+//   MemoryVgmSource      bytes already in memory (not owned)
+//   MappedFileVgmSource  memory-mapped .vgm – no copy, no read syscalls
+//   GzipFileVgmSource    .vgz inflated incrementally through a fixed
+//                        window; seeking backwards restarts the inflater
+//                        (only when built with zlib, ARM2612_HAVE_ZLIB)
+//
+// openVgmFile() picks the right one from the file's magic bytes.
+// ─────────────────────────────────────────────────────────────────────────────
+class VgmSource
+{
+public:
+    virtual ~VgmSource() = default;
+
+    // Copies up to n bytes to dst; returns the number copied (0 at end)
+    virtual size_t read(uint8_t* dst, size_t n) = 0;
+
+    // Moves to an absolute offset in the uncompressed stream
+    virtual bool seek(size_t offset) = 0;
+
+    virtual size_t position() const = 0;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+class MemoryVgmSource : public VgmSource
+{
+public:
+    MemoryVgmSource(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    size_t read(uint8_t* dst, size_t n) override;
+    bool   seek(size_t offset) override;
+    size_t position() const override { return m_pos; }
+
+protected:
+    MemoryVgmSource() = default;
+
+    const uint8_t* m_data = nullptr;
+    size_t         m_size = 0;
+    size_t         m_pos  = 0;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+class MappedFileVgmSource : public MemoryVgmSource
+{
+public:
+    ~MappedFileVgmSource() override;
+
+    static std::unique_ptr<MappedFileVgmSource> open(const std::string& path, std::string& error);
+
+    const uint8_t* data() const { return m_data; }
+    size_t         size() const { return m_size; }
+
+private:
+    MappedFileVgmSource() = default;
+
+    void* m_mapping = nullptr;   // platform handle (Windows) – unused on POSIX
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+#if ARM2612_HAVE_ZLIB
+class GzipFileVgmSource : public VgmSource
+{
+public:
+    ~GzipFileVgmSource() override;
+
+    static std::unique_ptr<GzipFileVgmSource> open(const std::string& path, std::string& error);
+
+    size_t read(uint8_t* dst, size_t n) override;
+    bool   seek(size_t offset) override;
+    size_t position() const override { return m_pos; }
+
+private:
+    GzipFileVgmSource() = default;
+    bool restart();
+
+    static constexpr size_t kWindow = 64 * 1024;   // compressed bytes per fread
+
+    std::string          m_path;
+    std::FILE*           m_file = nullptr;
+    void*                m_zstream = nullptr;      // z_stream, kept out of the header
+    std::vector<uint8_t> m_in;
+    size_t               m_pos  = 0;
+    bool                 m_eof  = false;
+};
+#endif
+
+// .vgm (mapped) or .vgz (inflated) chosen by content, not by extension
+std::unique_ptr<VgmSource> openVgmFile(const std::string& path, std::string& error);
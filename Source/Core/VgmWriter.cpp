@@ -0,0 +1,109 @@
+#include "VgmWriter.h"
+
+#include <algorithm>
+
+static constexpr uint32_t kVgmRate    = 44100;
+static constexpr size_t   kHeaderSize = 0x40;
+static constexpr size_t   kFlushAt    = 64 * 1024;
+
+VgmWriter::~VgmWriter()
+{
+    if (m_file != nullptr) std::fclose(m_file);
+}
+
+bool VgmWriter::open(const std::string& path, uint32_t ym2612Clock, std::string& error)
+{
+    m_file = std::fopen(path.c_str(), "wb");
+    if (m_file == nullptr) {
+        error = "cannot write " + path;
+        return false;
+    }
+    m_clock     = ym2612Clock;
+    m_chipRate  = ym2612Clock / 144;
+    m_vgmTime   = 0;
+    m_dataBytes = 0;
+    m_buf.clear();
+    m_ok        = writeHeader();
+
+    // Known starting state for hardware playback
+    write(0, 0, 0x2B, 0x00);                       // DAC off
+    write(0, 0, 0x27, 0x00);                       // channel 3 normal mode
+    for (uint8_t ch : { 0, 1, 2, 4, 5, 6 })
+        write(0, 0, 0x28, ch);                     // key off
+
+    if (!m_ok) error = "write failed: " + path;
+    return m_ok;
+}
+
+void VgmWriter::write(uint64_t chipTime, int port, uint8_t reg, uint8_t value)
+{
+    advanceTo(chipTime);
+    m_buf.push_back(port == 0 ? 0x52 : 0x53);
+    m_buf.push_back(reg);
+    m_buf.push_back(value);
+    if (m_buf.size() >= kFlushAt) flush();
+}
+
+// Emits waits up to the 44.1 kHz sample that chipTime falls on
+void VgmWriter::advanceTo(uint64_t chipTime)
+{
+    const uint64_t target = chipTime * kVgmRate / m_chipRate;
+    while (m_vgmTime < target) {
+        const uint64_t gap = target - m_vgmTime;
+        uint32_t n;
+        if      (gap == 735)  { m_buf.push_back(0x62); n = 735; }
+        else if (gap == 882)  { m_buf.push_back(0x63); n = 882; }
+        else if (gap <= 16)   { n = uint32_t(gap); m_buf.push_back(uint8_t(0x70 + n - 1)); }
+        else {
+            n = uint32_t(std::min<uint64_t>(gap, 0xFFFF));
+            m_buf.push_back(0x61);
+            m_buf.push_back(uint8_t(n));
+            m_buf.push_back(uint8_t(n >> 8));
+        }
+        m_vgmTime += n;
+    }
+}
+
+bool VgmWriter::flush()
+{
+    if (m_buf.empty()) return m_ok;
+    m_ok = m_ok && std::fwrite(m_buf.data(), 1, m_buf.size(), m_file) == m_buf.size();
+    m_dataBytes += m_buf.size();
+    m_buf.clear();
+    return m_ok;
+}
+
+bool VgmWriter::finish(uint64_t endChipTime)
+{
+    if (m_file == nullptr) return false;
+
+    advanceTo(endChipTime);
+    m_buf.push_back(0x66);
+    flush();
+
+    m_ok = m_ok && std::fseek(m_file, 0, SEEK_SET) == 0 && writeHeader();
+    m_ok = (std::fclose(m_file) == 0) && m_ok;
+    m_file = nullptr;
+    return m_ok;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Header – VGM 1.50, YM2612 only, data right after the 0x40-byte header
+// ─────────────────────────────────────────────────────────────────────────────
+bool VgmWriter::writeHeader()
+{
+    uint8_t h[kHeaderSize] {};
+    auto le32 = [&](size_t at, uint32_t v) {
+        for (int k = 0; k < 4; ++k) h[at + k] = uint8_t(v >> (8 * k));
+    };
+
+    h[0] = 'V'; h[1] = 'g'; h[2] = 'm'; h[3] = ' ';
+    le32(0x04, uint32_t(kHeaderSize + m_dataBytes - 0x04));   // EOF offset
+    le32(0x08, 0x150);                                         // version
+    le32(0x18, uint32_t(m_vgmTime));                           // total samples
+    le32(0x24, 60);                                            // rate (NTSC)
+    le32(0x2C, m_clock);                                       // YM2612 clock
+    le32(0x34, uint32_t(kHeaderSize - 0x34));                  // data offset
+
+    return std::fwrite(h, 1, sizeof h, m_file) == sizeof h;
+}
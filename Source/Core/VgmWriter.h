@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// VgmWriter  –  writes a YM2612-only VGM 1.50 file
+//
+// Register writes come in with chip-sample timestamps (non-decreasing);
+// the gaps between them become VGM waits at 44.1 kHz, using the shortest
+// wait commands. Times are converted from a running total so rounding never
+// accumulates. The header (lengths, EOF offset) is patched in finish().
+//
+// The file starts with DAC off, channel 3 in normal mode and all six
+// channels keyed off, so it plays the same on hardware from any state.
+// ─────────────────────────────────────────────────────────────────────────────
+class VgmWriter
+{
+public:
+    ~VgmWriter();
+
+    bool open(const std::string& path, uint32_t ym2612Clock, std::string& error);
+
+    void write(uint64_t chipTime, int port, uint8_t reg, uint8_t value);
+
+    // Pads to endChipTime, writes the end command and the final header
+    bool finish(uint64_t endChipTime);
+
+    bool isOpen() const { return m_file != nullptr; }
+
+private:
+    void advanceTo(uint64_t chipTime);
+    bool flush();
+    bool writeHeader();
+
+    std::FILE*           m_file      = nullptr;
+    uint32_t             m_clock     = 0;
+    uint32_t             m_chipRate  = 0;
+    uint64_t             m_vgmTime   = 0;   // 44.1 kHz samples emitted so far
+    uint64_t             m_dataBytes = 0;
+    std::vector<uint8_t> m_buf;
+    bool                 m_ok        = false;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Y12Format.h  –  Gens KMod YM2612 channel dump (.y12)
+//
+// 128 bytes of raw register values:
+//   0x00  4 operators in slot order (OP1, OP3, OP2, OP4), 16 bytes each:
+//         registers 0x30, 0x40, 0x50, 0x60, 0x70, 0x80, 0x90, then 9 zero
+//   0x40  algorithm
+//   0x41  feedback
+//   0x42  14 bytes zero
+//   0x50  instrument name, 16 bytes, zero padded
+//   0x60  dumper name, 16 bytes
+//   0x70  game name, 16 bytes
+//
+// Detune is the chip encoding (4..7 negative). AMS/FMS are not stored.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "PatchCodec.h"
+
+namespace Y12Format {
+
+static constexpr size_t kSize = 128;
+
+inline bool decode(const uint8_t* data, size_t size, PatchData& out)
+{
+    if (data == nullptr || size != kSize) return false;
+
+    out = PatchData();
+    for (int slot = 0; slot < 4; ++slot)
+        PatchCodecs::opFromRegisters(data + slot * 16, out.patch.op[PatchCodecs::kSlotToUi[slot]]);
+    out.patch.ALG = data[0x40] & 7;
+    out.patch.FB  = data[0x41] & 7;
+    out.name      = PatchCodecs::readName(data + 0x50, 16);
+    return true;
+}
+
+inline std::vector<uint8_t> encode(const PatchData& in)
+{
+    std::vector<uint8_t> out(kSize, 0);
+    for (int slot = 0; slot < 4; ++slot)
+        PatchCodecs::opToRegisters(in.patch.op[PatchCodecs::kSlotToUi[slot]], out.data() + slot * 16);
+    out[0x40] = uint8_t(in.patch.ALG & 7);
+    out[0x41] = uint8_t(in.patch.FB & 7);
+    PatchCodecs::writeName(out.data() + 0x50, 16, in.name);
+    PatchCodecs::writeName(out.data() + 0x60, 16, "ARM2612");
+    return out;
+}
+
+} // namespace Y12Format
@@ -0,0 +1,176 @@
+#include "Ym2612Engine.h"
+#include "Tracer.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Register image
+// ─────────────────────────────────────────────────────────────────────────────
+Ym2612Engine::RegisterImage Ym2612Engine::RegisterImage::compile(const GlobalParams& g,
+                                                                 const OpParams (&ops)[4])
+{
+    RegisterImage img;
+    img.algFb    = static_cast<uint8_t>(((g.feedback & 7) << 3) | (g.algorithm & 7));
+    img.lrAmsFms = static_cast<uint8_t>(0xC0 | ((g.ams & 3) << 4) | (g.fms & 7));
+    img.lfo      = g.lfoEnable ? static_cast<uint8_t>(0x08 | (g.lfoFreq & 7)) : 0x00;
+    img.octave   = g.octave;
+
+    for (int p = 0; p < 4; p++) {
+        const OpParams& q = ops[p];
+        uint8_t* r = img.op[p];
+        r[0] = static_cast<uint8_t>(((q.dt  & 7) << 4) | (q.mul & 0x0F));   // 0x30 DT/MUL
+        r[1] = static_cast<uint8_t>(q.tl  & 0x7F);                          // 0x40 TL
+        r[2] = static_cast<uint8_t>(((q.rs & 3) << 6) | (q.ar & 0x1F));     // 0x50 KS/AR
+        r[3] = static_cast<uint8_t>(((q.am & 1) << 7) | (q.dr & 0x1F));     // 0x60 AM/DR
+        r[4] = static_cast<uint8_t>(q.sr  & 0x1F);                          // 0x70 SR
+        r[5] = static_cast<uint8_t>(((q.sl & 0x0F) << 4) | (q.rr & 0x0F));  // 0x80 SL/RR
+        // SSG-EG: bit[3] = enable, bits[2:0] = mode
+        r[6] = q.ssgEnable ? static_cast<uint8_t>(0x08 | (q.ssgMode & 7)) : 0; // 0x90
+    }
+    return img;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Release tail estimate
+//
+// On the chip the release raises a 10-bit attenuation (0 = full level,
+// 0x3FF = silent) once per envelope clock (chip rate / 3). The effective
+// rate is 2 * (2*RR + 1) + key scale; key scale is 0 for the lowest notes,
+// which gives the longest release. For rate R < 60 the average step per
+// envelope clock is (4 + (R & 3)) / 8 * 2^((R >> 2) - 11); rates 60-63
+// step by 8. TL is added on top of the envelope, so a carrier only has to
+// travel 0x3FF - (TL << 3) before it is inaudible. A note can be released
+// mid-attack, so the estimate starts at full level rather than at SL.
+// ─────────────────────────────────────────────────────────────────────────────
+double Ym2612Engine::estimateReleaseSeconds(const RegisterImage& img)
+{
+    const double egClockHz = static_cast<double>(YM_CLOCK) / 144.0 / 3.0;
+    const uint8_t carriers = kCarrierMask[img.algorithm()];
+    double tail = 0.0;
+
+    for (int p = 0; p < 4; p++) {
+        if ((carriers & (1 << p)) == 0) continue;
+
+        const int tl       = img.op[p][1] & 0x7F;
+        const int rr       = img.op[p][5] & 0x0F;
+        const int distance = 0x3FF - (tl << 3);
+        if (distance <= 0) continue;   // carrier is silent anyway
+
+        const int    rate = 2 * (2 * rr + 1);
+        const double step = (rate >= 60) ? 8.0
+                          : (4 + (rate & 3)) / 8.0 * std::ldexp(1.0, (rate >> 2) - 11);
+        tail = std::max(tail, distance / step / egClockHz);
+    }
+    return std::min(tail, kMaxTailSeconds);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Engine
+// ─────────────────────────────────────────────────────────────────────────────
+Ym2612Engine::Ym2612Engine()
+    : m_chip(m_interface)
+{
+    // Algo 4 defaults: carriers loud, modulators half-open
+    OpParams ops[4];
+    ops[0].tl = 63;   // OP1 modulator
+    ops[1].tl = 0;    // OP2 carrier
+    ops[2].tl = 63;   // OP3 modulator
+    ops[3].tl = 0;    // OP4 carrier
+    m_image       = RegisterImage::compile(GlobalParams{}, ops);
+    m_tailSeconds = estimateReleaseSeconds(m_image);
+}
+
+bool Ym2612Engine::setRegisterImage(const RegisterImage& img)
+{
+    if (img == m_image) return false;
+    m_image       = img;
+    m_tailSeconds = estimateReleaseSeconds(img);
+    return true;
+}
+
+void Ym2612Engine::startNote(int midiNote, double hostRate, int numChannels)
+{
+    ARM2612_TRACE_SCOPE("note on");
+    initResamplingState(hostRate, numChannels);
+    m_chip.reset();
+    if (m_capture != nullptr)
+        m_capture->write(m_captureChannel, 0x28, 0x00);   // hardware has no reset – key off instead
+    writeAllRegisters();
+    m_note = midiNote;
+    setFrequency(midiNoteToHz(midiNote));
+    keyOn();
+}
+
+void Ym2612Engine::initResamplingState(double hostRate, int numChannels)
+{
+    uint32_t chipRate = m_chip.sample_rate(YM_CLOCK);
+    m_resampleStep    = static_cast<double>(chipRate) / hostRate;
+    m_resamplePos     = 1.0;
+    m_prev[0] = m_prev[1] = m_curr[0] = m_curr[1] = 0.0f;
+
+    // n outputs consume at most 1 + n * step chip samples
+    m_batchOutputs = std::max(1, static_cast<int>((kChipBatch - 1) / m_resampleStep));
+
+    const bool mono = (numChannels == 1);
+    if (m_resampleStep == 1.0)
+        m_render = mono ? &Ym2612Engine::renderNative<1> : &Ym2612Engine::renderNative<2>;
+    else
+        m_render = mono ? &Ym2612Engine::renderResampled<1> : &Ym2612Engine::renderResampled<2>;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Full register programming
+//
+// YM2612 slot register offsets within ch0 (part 0):
+//   OP1=+0, OP3=+4, OP2=+8, OP4=+12  (hardware numbering)
+// m_image.op[] is indexed as the user sees: [0]=OP1, [1]=OP2, [2]=OP3, [3]=OP4
+// so we map:  param[0]→reg+0,  param[1]→reg+8,  param[2]→reg+4,  param[3]→reg+12
+// ─────────────────────────────────────────────────────────────────────────────
+static constexpr uint8_t kSlotOff[4] = { 0, 8, 4, 12 };
+
+void Ym2612Engine::writeAllRegisters()
+{
+    wr(0xB0, m_image.algFb);       // Algorithm + Feedback
+    wr(0xB4, m_image.lrAmsFms);    // AMS + FMS
+    wr(0x22, m_image.lfo);         // LFO enable + frequency
+
+    // Per-operator registers, 0x30..0x90 + slot offset
+    for (int p = 0; p < 4; p++) {
+        const uint8_t  o = kSlotOff[p];
+        const uint8_t* r = m_image.op[p];
+        for (int i = 0; i < 7; i++)
+            wr(static_cast<uint8_t>(0x30 + i * 0x10 + o), r[i]);
+    }
+    m_live = m_image;
+}
+
+void Ym2612Engine::writeChangedRegisters(const RegisterImage& frame)
+{
+    if (frame.algFb    != m_live.algFb)    wr(0xB0, frame.algFb);
+    if (frame.lrAmsFms != m_live.lrAmsFms) wr(0xB4, frame.lrAmsFms);
+    if (frame.lfo      != m_live.lfo)      wr(0x22, frame.lfo);
+
+    for (int p = 0; p < 4; p++) {
+        const uint8_t o = kSlotOff[p];
+        for (int i = 0; i < 7; i++)
+            if (frame.op[p][i] != m_live.op[p][i])
+                wr(static_cast<uint8_t>(0x30 + i * 0x10 + o), frame.op[p][i]);
+    }
+    m_live = frame;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Frequency
+// ─────────────────────────────────────────────────────────────────────────────
+void Ym2612Engine::setFrequency(double hz)
+{
+    // Apply octave offset
+    hz *= std::pow(2.0, m_image.octave);
+
+    const double fref = static_cast<double>(YM_CLOCK) / 144.0;
+    int    block = 4;
+    double fn    = hz * static_cast<double>(1 << (20 - block)) / fref;
+    while (fn > 0x7FF && block < 7) { block++; fn /= 2.0; }
+    while (fn < 0x200 && block > 0) { block--; fn *= 2.0; }
+    auto fnum = static_cast<uint16_t>(std::clamp(static_cast<int>(fn), 0, 0x7FF));
+    wr(0xA4, static_cast<uint8_t>(((block & 7) << 3) | ((fnum >> 8) & 0x07)));
+    wr(0xA0, static_cast<uint8_t>(fnum & 0xFF));
+}
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "ymfm_opn.h"
+#include "VgmCapture.h"
+#include "DspProfiler.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Ym2612Engine.h  –  one YM2612 channel, no JUCE
+//
+// Everything the plugin needs to turn a patch and a note into samples:
+// register image compilation, chip programming, tuning, release-tail
+// estimation and the chip-rate → host-rate render loops. Ym2612Voice is a
+// thin juce::SynthesiserVoice adapter around it; the benchmark and CLI tools
+// drive it directly.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PluginYmfmInterface  –  stub timer / IRQ callbacks (not needed for a synth)
+// ─────────────────────────────────────────────────────────────────────────────
+class PluginYmfmInterface : public ymfm::ymfm_interface
+{
+public:
+    void    ymfm_set_timer(uint32_t, int32_t)                 override {}
+    void    ymfm_sync_mode_write(uint8_t)                     override {}
+    void    ymfm_sync_check_interrupts()                      override {}
+    void    ymfm_set_busy_end(uint32_t)                       override {}
+    uint8_t ymfm_external_read(ymfm::access_class, uint32_t)  override { return 0; }
+    void    ymfm_external_write(ymfm::access_class, uint32_t, uint8_t) override {}
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Ym2612Engine
+//
+// One ymfm::ym2612 chip instance, playing on channel 0.
+// ─────────────────────────────────────────────────────────────────────────────
+class Ym2612Engine
+{
+public:
+    static constexpr uint32_t YM_CLOCK  = 7'670'453;       // NTSC Mega Drive
+    static constexpr uint32_t CHIP_RATE = YM_CLOCK / 144;  // 53'267 Hz, matches ym2612::sample_rate()
+
+    // True when the host runs at the chip's own rate and no resampling happens
+    static bool isNativeRate(double sampleRate) { return sampleRate == static_cast<double>(CHIP_RATE); }
+
+    // ── Global parameter block ────────────────────────────────────────────────
+    struct GlobalParams {
+        int  algorithm = 4;      // 0-7
+        int  feedback  = 5;      // 0-7 (applies to OP1 only)
+        bool lfoEnable = false;
+        int  lfoFreq   = 0;      // 0-7 chip value
+        int  ams       = 0;      // AM LFO sensitivity 0-3
+        int  fms       = 0;      // FM LFO sensitivity 0-7
+        int  octave    = 0;      // -2 to +2
+    };
+
+    // ── Per-operator parameter block ─────────────────────────────────────────
+    struct OpParams {
+        int tl  = 0;    // total level  0-127  (0=loud, 127=silent)
+        int ar  = 31;   // attack rate  0-31
+        int dr  = 5;    // decay rate   0-31
+        int sr  = 0;    // sustain rate 0-31
+        int sl  = 1;    // sustain level 0-15
+        int rr  = 10;   // release rate  0-15
+        int mul = 1;    // frequency multiply 0-15  (0 = ×0.5)
+        int dt  = 0;    // detune 0-7  (4-7 = negative on chip)
+        int rs  = 0;    // rate scale (key scale) 0-3
+        int am  = 0;    // AM enable 0-1
+        int ssgEnable = 0;   // SSG-EG enable 0-1
+        int ssgMode   = 0;   // SSG-EG mode 0-7
+    };
+
+    // ── Precompiled register image ──────────────────────────────────────────
+    // The exact bytes writeAllRegisters() sends to the chip for one patch.
+    // Compiling once per patch change (instead of once per voice per block)
+    // lets a program change swap timbres with a plain struct copy.
+    struct RegisterImage {
+        uint8_t lfo      = 0x00;   // 0x22  LFO enable + frequency
+        uint8_t algFb    = 0x00;   // 0xB0  feedback + algorithm
+        uint8_t lrAmsFms = 0xC0;   // 0xB4  L/R + AMS + FMS
+        uint8_t op[4][7] {};       // 0x30..0x90 per operator, user order OP1..OP4
+        int     octave   = 0;      // not a register – applied in setFrequency()
+
+        bool operator==(const RegisterImage&) const = default;
+
+        int algorithm() const { return algFb & 7; }
+
+        static RegisterImage compile(const GlobalParams& g, const OpParams (&ops)[4]);
+    };
+
+    // Carriers per algorithm as an OP1..OP4 bit mask (bit 0 = OP1)
+    static constexpr uint8_t kCarrierMask[8] = {
+        0b1000, 0b1000, 0b1000, 0b1000, 0b1010, 0b1110, 0b1110, 0b1111
+    };
+
+    static constexpr double kMaxTailSeconds = 30.0;
+
+    // Worst-case time from key-off until every carrier is silent (see .cpp)
+    static double estimateReleaseSeconds(const RegisterImage& img);
+
+    // Fractional notes for macro pitch offsets
+    static double midiNoteToHz(double midiNote)
+    {
+        return 440.0 * std::pow(2.0, (midiNote - 69) / 12.0);
+    }
+
+    Ym2612Engine();
+
+    // Returns false (and does nothing) if img is identical to the current image
+    bool setRegisterImage(const RegisterImage& img);
+
+    const RegisterImage& getRegisterImage() const { return m_image; }
+    double               getTailSeconds() const   { return m_tailSeconds; }
+
+    // Resets the chip, programs the current image and keys the note on.
+    // numChannels (1 or 2) and hostRate select the render loop used by render().
+    void startNote(int midiNote, double hostRate, int numChannels);
+    void stopNote() { keyOff(); }
+
+    // Re-sends the whole register image (after setRegisterImage mid-note)
+    void writeAllRegisters();
+
+    // Writes only the bytes of frame that differ from what the chip holds –
+    // the per-tick path of MacroPlayer. The stored patch image is unchanged.
+    void writeChangedRegisters(const RegisterImage& frame);
+
+    void setFrequency(double hz);
+    void setNote(double midiNote) { setFrequency(midiNoteToHz(midiNote)); }
+    int  getNote() const          { return m_note; }
+
+    // Adds numSamples at the host rate into dst[0..numChannels), scaled by
+    // gain. A nullptr channel is skipped (the chip still advances).
+    void render(float* const* dst, int numSamples, float gain)
+    {
+        (this->*m_render)(dst, numSamples, gain);
+    }
+
+    ymfm::ym2612& chip() { return m_chip; }
+
+#if ARM2612_PROFILE
+    // Ticks spent inside ymfm since the last call (see DspProfiler)
+    uint64_t takeChipTicks() { const uint64_t t = m_chipTicks; m_chipTicks = 0; return t; }
+#endif
+
+    // Mirrors every register write into capture as hardware channel
+    // `channel` (nullptr = off). Set before rendering starts.
+    void setCapture(VgmCapture* capture, int channel)
+    {
+        m_capture        = capture;
+        m_captureChannel = channel;
+    }
+
+private:
+    using RenderFn = void (Ym2612Engine::*)(float* const*, int, float);
+
+    // ── Render path, specialised per output channel count ────────────────────
+    // Mono targets sum L+R once at chip rate and interpolate a single channel,
+    // which halves the resampling work.
+
+    // Both loops generate the chip samples a stretch of output needs in one
+    // batch first (exactly those, so register writes between render calls
+    // still land on the right sample), then convert them.
+
+    // Host rate == chip rate: one chip sample per output sample, written as is
+    template <int NumChannels>
+    void renderNative(float* const* dst, int numSamples, float gain)
+    {
+        const float scale = gain / (2.0f * 32768.0f);
+
+        for (int done = 0; done < numSamples; ) {
+            const int n = std::min(numSamples - done, kChipBatch);
+            generate(m_batch, n);
+            for (int i = 0; i < n; i++) {
+                const auto& out = m_batch[i];
+                if constexpr (NumChannels == 1) {
+                    if (dst[0] != nullptr)
+                        dst[0][done + i] += 0.5f * static_cast<float>(out.data[0] + out.data[1]) * scale;
+                } else {
+                    if (dst[0] != nullptr) dst[0][done + i] += static_cast<float>(out.data[0]) * scale;
+                    if (dst[1] != nullptr) dst[1][done + i] += static_cast<float>(out.data[1]) * scale;
+                }
+            }
+            done += n;
+        }
+    }
+
+    template <int NumChannels>
+    void renderResampled(float* const* dst, int numSamples, float gain)
+    {
+        const float scale = gain / (2.0f * 32768.0f);
+
+        for (int done = 0; done < numSamples; ) {
+            // m_batchOutputs output samples never need more than kChipBatch chip samples
+            const int n = std::min(numSamples - done, m_batchOutputs);
+
+            int    needed = 0;
+            double pos    = m_resamplePos;
+            for (int i = 0; i < n; i++) {
+                while (pos >= 1.0) { ++needed; pos -= 1.0; }
+                pos += m_resampleStep;
+            }
+            generate(m_batch, needed);
+
+            const ymfm::ym2612::output_data* next = m_batch;
+            for (int i = done; i < done + n; i++) {
+                while (m_resamplePos >= 1.0) {
+                    const auto& out = *next++;
+                    for (int c = 0; c < NumChannels; c++) m_prev[c] = m_curr[c];
+                    if constexpr (NumChannels == 1) {
+                        m_curr[0] = 0.5f * static_cast<float>(out.data[0] + out.data[1]);
+                    } else {
+                        m_curr[0] = static_cast<float>(out.data[0]);
+                        m_curr[1] = static_cast<float>(out.data[1]);
+                    }
+                    m_resamplePos -= 1.0;
+                }
+                const float t = static_cast<float>(m_resamplePos);
+                for (int c = 0; c < NumChannels; c++)
+                    if (dst[c] != nullptr)
+                        dst[c][i] += (m_prev[c] + t * (m_curr[c] - m_prev[c])) * scale;
+                m_resamplePos += m_resampleStep;
+            }
+            done += n;
+        }
+    }
+
+    PluginYmfmInterface m_interface;
+    ymfm::ym2612        m_chip;
+
+    // Patch storage
+    RegisterImage m_image;
+    RegisterImage m_live;            // what the chip holds, incl. macro writes
+    double        m_tailSeconds = 0.0;
+    int           m_note        = 60;
+
+    // Resampler
+    double   m_resampleStep = 1.0;
+    double   m_resamplePos  = 1.0;
+    float    m_prev[2] {};      // [L, R] – mono path uses [0] only
+    float    m_curr[2] {};
+    RenderFn m_render = &Ym2612Engine::renderResampled<2>;
+
+    static constexpr int      kChipBatch = 128;
+    ymfm::ym2612::output_data m_batch[kChipBatch];
+    int                       m_batchOutputs = 1;
+
+    void initResamplingState(double hostRate, int numChannels);
+
+    // numSamples chip samples; timed per batch only in profiling builds
+    void generate(ymfm::ym2612::output_data* out, int numSamples)
+    {
+        if (numSamples <= 0) return;
+#if ARM2612_PROFILE
+        ARM2612_PROFILE_BEGIN(t0);
+        m_chip.generate(out, uint32_t(numSamples));
+        m_chipTicks += DspProfiler::ticks() - t0;
+#else
+        m_chip.generate(out, uint32_t(numSamples));
+#endif
+    }
+
+#if ARM2612_PROFILE
+    uint64_t m_chipTicks = 0;
+#endif
+
+    // VGM capture tap
+    VgmCapture* m_capture        = nullptr;
+    int         m_captureChannel = 0;
+
+    // ── Register write helpers ────────────────────────────────────────────────
+    void wr(uint8_t reg, uint8_t val)
+    {
+        m_chip.write_address(reg);
+        m_chip.write_data(val);
+        if (m_capture != nullptr)
+            m_capture->write(m_captureChannel, reg, val);
+    }
+
+    void keyOn()  { wr(0x28, 0xF0); }
+    void keyOff() { wr(0x28, 0x00); }
+};
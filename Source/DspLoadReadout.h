@@ -0,0 +1,75 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "DspProfiler.h"
+
+// =============================================================================
+// DspLoadReadout - live per-stage processBlock timing for the settings panel
+//
+// Refreshes twice a second from DspProfiler snapshots, so every line covers
+// only the blocks of the last half second: p50 / p99 / max in microseconds
+// per stage, and the total as a share of the real-time budget per block.
+// =============================================================================
+class DspLoadReadout : public juce::Component,
+                       private juce::Timer
+{
+public:
+    explicit DspLoadReadout(DspProfiler& p) : profiler(p)
+    {
+       #if ARM2612_PROFILE
+        profiler.collect(previous);   // start the first interval now
+        startTimerHz(2);
+       #endif
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        const auto dim    = juce::Colour(0xFF888888);
+        const auto accent = juce::Colour(0xFF00D4AA);
+        g.setFont(juce::Font("Courier New", 11.f, juce::Font::plain));
+
+       #if ARM2612_PROFILE
+        auto row = [&](int i) { return getLocalBounds().withHeight(14).withY(i * 14); };
+
+        const double load = report.loadP99;
+        g.setColour(load < 0.5 ? accent : load < 0.8 ? juce::Colours::orange : juce::Colours::red);
+        g.drawText(juce::String::formatted("DSP load  %4.1f%% p50  %4.1f%% p99  %4.1f%% max",
+                                           100.0 * report.loadP50, 100.0 * report.loadP99,
+                                           100.0 * report.loadMax),
+                   row(0), juce::Justification::centredLeft);
+
+        g.setColour(dim);
+        g.drawText("stage        p50 us   p99 us   max us", row(1), juce::Justification::centredLeft);
+        for (int s = 0; s < DspProfiler::numStages; ++s) {
+            const auto& st = report.stage[s];
+            g.drawText(juce::String::formatted("%-10s %8.1f %8.1f %8.1f",
+                                               DspProfiler::stageName(s), st.p50Us, st.p99Us, st.maxUs),
+                       row(2 + s), juce::Justification::centredLeft);
+        }
+       #else
+        g.setColour(dim);
+        g.drawFittedText("DSP load readout: build with -DARM2612_PROFILE=ON",
+                         getLocalBounds(), juce::Justification::centredLeft, 2);
+       #endif
+    }
+
+    static constexpr int preferredHeight()
+    {
+       #if ARM2612_PROFILE
+        return 14 * (2 + DspProfiler::numStages);
+       #else
+        return 28;
+       #endif
+    }
+
+private:
+    void timerCallback() override
+    {
+        report = profiler.collect(previous);
+        repaint();
+    }
+
+    DspProfiler&           profiler;
+    DspProfiler::Snapshot  previous;
+    DspProfiler::Report    report;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// KeyboardBridge.h  –  on-screen keyboard ↔ audio thread without locks
+//
+// juce::MidiKeyboardState guards everything with a CriticalSection, so
+// calling processNextMidiBuffer() from processBlock can block the audio
+// thread behind the UI. The bridge keeps the state on the message thread
+// only and passes notes through two SpscRings instead:
+//
+//   UI keyboard → state listener → toAudio → merged into the block's MIDI
+//   host MIDI   → toUi → updateDisplay() on the editor timer → state
+//
+// Notes applied by updateDisplay() are not sent back to the audio thread.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "SpscRing.h"
+
+class KeyboardBridge : private juce::MidiKeyboardState::Listener
+{
+public:
+    explicit KeyboardBridge(juce::MidiKeyboardState& s) : state(s) { state.addListener(this); }
+    ~KeyboardBridge() override { state.removeListener(this); }
+
+    // ── Audio thread ─────────────────────────────────────────────────────────
+    // Queues the block's host notes for the on-screen keyboard
+    void reportHostMidi(const juce::MidiBuffer& midi)
+    {
+        for (const auto meta : midi) {
+            const auto* d = meta.data;
+            const uint8_t type = d[0] & 0xF0;
+            if (meta.numBytes == 3 && (type == 0x80 || type == 0x90 || (type == 0xB0 && d[1] >= 120)))
+                toUi.push({ d[0], d[1], d[2] });
+        }
+    }
+
+    bool hasPendingNotes() const { return pendingForAudio.load(std::memory_order_acquire) > 0; }
+
+    // Moves keyboard notes into dest at sample 0 (dest is preallocated)
+    void addPendingNotes(juce::MidiBuffer& dest)
+    {
+        Message m;
+        while (toAudio.pop(m)) {
+            pendingForAudio.fetch_sub(1, std::memory_order_release);
+            dest.addEvent(m.bytes, 3, 0);
+        }
+    }
+
+    // ── Message thread ───────────────────────────────────────────────────────
+    void updateDisplay()
+    {
+        const juce::ScopedValueSetter<bool> applying(applyingHostNotes, true);
+        Message m;
+        while (toUi.pop(m)) {
+            const int ch = (m.bytes[0] & 0x0F) + 1;
+            switch (m.bytes[0] & 0xF0) {
+                case 0x90:
+                    if (m.bytes[2] > 0) { state.noteOn(ch, m.bytes[1], m.bytes[2] / 127.0f); break; }
+                    [[fallthrough]];   // velocity 0 = note off
+                case 0x80: state.noteOff(ch, m.bytes[1], m.bytes[2] / 127.0f); break;
+                default:   state.allNotesOff(ch); break;
+            }
+        }
+    }
+
+private:
+    struct Message { uint8_t bytes[3]; };
+
+    void handleNoteOn(juce::MidiKeyboardState*, int ch, int note, float velocity) override
+    {
+        if (!applyingHostNotes) send(juce::MidiMessage::noteOn(ch, note, velocity));
+    }
+
+    void handleNoteOff(juce::MidiKeyboardState*, int ch, int note, float velocity) override
+    {
+        if (!applyingHostNotes) send(juce::MidiMessage::noteOff(ch, note, velocity));
+    }
+
+    void send(const juce::MidiMessage& msg)
+    {
+        const auto* d = msg.getRawData();
+        if (toAudio.push({ { d[0], d[1], d[2] } }))
+            pendingForAudio.fetch_add(1, std::memory_order_release);
+    }
+
+    juce::MidiKeyboardState& state;
+    SpscRing<Message>        toAudio { 256 };
+    SpscRing<Message>        toUi    { 1024 };
+    std::atomic<int>         pendingForAudio { 0 };
+    bool                     applyingHostNotes = false;
+
+    JUCE_DECLARE_NON_COPYABLE(KeyboardBridge)
+};
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "SynthSound.h"
+#include "Ym2612Voice.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// OfflineRenderer  –  render a MIDI sequence to disk-quality audio
+//
+// The voices run at Ym2612Voice::CHIP_RATE, where they take the native path
+// and write chip samples untouched. The chip-rate stream is then converted
+// to the requested rate with a windowed-sinc interpolator per channel,
+// instead of the per-sample linear interpolation used for live playback.
+// When the target rate is below the chip rate (44.1 / 48 kHz), the stream
+// is first band-limited by a 129-tap Blackman low-pass that reaches its
+// stopband (about -72 dB) at the output Nyquist, so nothing above it aliases
+// back; the passband ends about 2.3 kHz below Nyquist. At targetRate ==
+// CHIP_RATE the result is the chip output, bit for bit (scaled by note
+// velocity only).
+//
+// renderTo() works in fixed-size chunks and hands each one to a sink, so
+// memory use does not grow with the length of the sequence. render() is a
+// convenience wrapper that collects everything into one buffer.
+//
+// Timestamps in the MidiBuffer are in samples at targetRate.
+// ─────────────────────────────────────────────────────────────────────────────
+class OfflineRenderer
+{
+public:
+    static constexpr int kChunkSize = 4096;   // output samples per sink call
+
+    // Receives consecutive stereo chunks; return false to abort the render
+    using Sink = std::function<bool(const float* const* channels, int numSamples)>;
+
+    explicit OfflineRenderer(int numVoices = 6)
+    {
+        synth.addSound(new SynthSound());
+        for (int i = 0; i < numVoices; ++i)
+            synth.addVoice(new Ym2612Voice());
+        synth.setCurrentPlaybackSampleRate(Ym2612Voice::CHIP_RATE);
+    }
+
+    void setRegisterImage(const Ym2612Voice::RegisterImage& image)
+    {
+        for (int i = 0; i < synth.getNumVoices(); ++i)
+            if (auto* v = dynamic_cast<Ym2612Voice*>(synth.getVoice(i)))
+                v->setRegisterImage(image);
+    }
+
+    // Renders numSamples stereo samples at targetRate. Notes still sounding
+    // at the end are cut, so leave room for release tails in numSamples.
+    // Returns false if the sink aborted.
+    bool renderTo(const juce::MidiBuffer& midi, int numSamples, double targetRate, const Sink& sink)
+    {
+        const double ratio  = Ym2612Voice::CHIP_RATE / targetRate;   // chip samples per output sample
+        const bool   native = Ym2612Voice::isNativeRate(targetRate);
+
+        prepareEvents(midi, native ? 1.0 : ratio);
+        synth.allNotesOff(0, false);
+
+        juce::AudioBuffer<float> out(2, kChunkSize);
+
+        if (native) {
+            for (int done = 0; done < numSamples; ) {
+                const int n = juce::jmin(kChunkSize, numSamples - done);
+                out.clear();
+                renderChip(out, 0, n);
+                if (!sink(out.getArrayOfReadPointers(), n)) return false;
+                done += n;
+            }
+            return true;
+        }
+
+        // Band-limit to the output Nyquist before decimating
+        const bool downsampling = ratio > 1.0;
+        if (downsampling)
+            antiAlias.prepare(0.5 * targetRate, Ym2612Voice::CHIP_RATE);
+
+        // The sinc kernel looks ahead by getBaseLatency() input samples and
+        // the low-pass delays by its half length; drop that many (in output
+        // samples) so the result lines up with the MIDI.
+        const double latency = juce::WindowedSincInterpolator::getBaseLatency()
+                             + (downsampling ? AntiAlias::kDelay : 0);
+        int          skip    = juce::roundToInt(latency / ratio);
+
+        juce::AudioBuffer<float> pending(2, static_cast<int>(std::ceil(kChunkSize * ratio)) + 8);
+        int pendingCount = 0;
+        juce::WindowedSincInterpolator interp[2];
+
+        for (int done = 0; done < numSamples; ) {
+            const int n      = juce::jmin(kChunkSize, numSamples + skip - done);
+            const int needed = static_cast<int>(std::ceil(n * ratio)) + 2;
+
+            if (pendingCount < needed) {
+                pending.clear(pendingCount, needed - pendingCount);
+                renderChip(pending, pendingCount, needed - pendingCount);
+                if (downsampling)
+                    for (int c = 0; c < 2; ++c)
+                        antiAlias.process(c, pending.getWritePointer(c, pendingCount), needed - pendingCount);
+                pendingCount = needed;
+            }
+
+            int used = 0;
+            for (int c = 0; c < 2; ++c)
+                used = interp[c].process(ratio, pending.getReadPointer(c), out.getWritePointer(c), n);
+
+            // Keep the unconsumed chip samples for the next chunk
+            for (int c = 0; c < 2; ++c)
+                std::memmove(pending.getWritePointer(c), pending.getReadPointer(c, used),
+                             sizeof(float) * size_t(pendingCount - used));
+            pendingCount -= used;
+
+            const int drop = juce::jmin(skip, n);
+            skip -= drop;
+            if (n > drop) {
+                const float* chans[2] = { out.getReadPointer(0, drop), out.getReadPointer(1, drop) };
+                if (!sink(chans, n - drop)) return false;
+                done += n - drop;
+            }
+        }
+        return true;
+    }
+
+    juce::AudioBuffer<float> render(const juce::MidiBuffer& midi, int numSamples, double targetRate)
+    {
+        juce::AudioBuffer<float> out(2, numSamples);
+        int pos = 0;
+        renderTo(midi, numSamples, targetRate, [&](const float* const* ch, int n) {
+            for (int c = 0; c < 2; ++c)
+                out.copyFrom(c, pos, ch[c], n);
+            pos += n;
+            return true;
+        });
+        return out;
+    }
+
+private:
+    // Linear-phase FIR low-pass (Blackman-windowed sinc), run in place at the
+    // chip rate. The cutoff sits half a transition band below stopHz, so the
+    // stopband starts at stopHz.
+    class AntiAlias
+    {
+    public:
+        static constexpr int kTaps  = 129;
+        static constexpr int kDelay = kTaps / 2;   // samples
+
+        void prepare(double stopHz, double rate)
+        {
+            const double transition = 5.5 * rate / kTaps;   // Blackman main-lobe width
+            const double fc         = (stopHz - 0.5 * transition) / rate;
+            const double pi         = juce::MathConstants<double>::pi;
+
+            double sum = 0.0;
+            for (int i = 0; i < kTaps; ++i) {
+                const int    m    = i - kDelay;
+                const double sinc = m == 0 ? 2.0 * fc : std::sin(2.0 * pi * fc * m) / (pi * m);
+                const double w    = 0.42 - 0.5 * std::cos(2.0 * pi * i / (kTaps - 1))
+                                         + 0.08 * std::cos(4.0 * pi * i / (kTaps - 1));
+                taps[size_t(i)] = sinc * w;
+                sum += taps[size_t(i)];
+            }
+            for (auto& t : taps) t /= sum;   // unity gain at DC
+
+            for (auto& h : history) h.fill(0.0f);
+            pos[0] = pos[1] = 0;
+        }
+
+        void process(int channel, float* samples, int numSamples)
+        {
+            // Each input is stored twice, kTaps apart, so the newest kTaps
+            // samples are always contiguous
+            auto& h = history[size_t(channel)];
+            int&  p = pos[channel];
+            for (int i = 0; i < numSamples; ++i) {
+                h[size_t(p)] = h[size_t(p + kTaps)] = samples[i];
+                const float* x = h.data() + p + 1;   // oldest .. newest
+                double y = 0.0;
+                for (int k = 0; k < kTaps; ++k)
+                    y += taps[size_t(k)] * x[k];
+                samples[i] = float(y);
+                p = (p + 1) % kTaps;
+            }
+        }
+
+    private:
+        std::array<double, kTaps>                   taps {};
+        std::array<std::array<float, 2 * kTaps>, 2> history {};
+        int                                         pos[2] {};
+    };
+
+    // MIDI converted to chip-rate positions, consumed in order by renderChip
+    void prepareEvents(const juce::MidiBuffer& midi, double ratio)
+    {
+        events.clear();
+        for (const auto meta : midi)
+            events.push_back({ static_cast<juce::int64>(std::llround(meta.samplePosition * ratio)),
+                               meta.getMessage() });
+        nextEvent = 0;
+        chipPos   = 0;
+    }
+
+    // Appends numSamples chip-rate samples at startSample of buffer
+    void renderChip(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+    {
+        juce::MidiBuffer block;
+        while (nextEvent < events.size() && events[nextEvent].chipPos < chipPos + numSamples) {
+            const auto& e = events[nextEvent++];
+            block.addEvent(e.message, startSample + static_cast<int>(juce::jmax<juce::int64>(0, e.chipPos - chipPos)));
+        }
+        synth.renderNextBlock(buffer, block, startSample, numSamples);
+        chipPos += numSamples;
+    }
+
+    struct ChipEvent {
+        juce::int64       chipPos;
+        juce::MidiMessage message;
+    };
+
+    juce::Synthesiser      synth;
+    AntiAlias              antiAlias;
+    std::vector<ChipEvent> events;
+    size_t                 nextEvent = 0;
+    juce::int64            chipPos   = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(OfflineRenderer)
+};
@@ -2,6 +2,7 @@
 
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_audio_basics/juce_audio_basics.h>
+#include "Tracer.h"
 
 // ─────────────────────────────────────────────────────────────────────────────
 // OscilloscopeDisplay - Shows real-time audio waveform
@@ -52,6 +53,7 @@ public:
 
     void paint(juce::Graphics& g) override
     {
+        ARM2612_TRACE_SCOPE("scope paint");
         auto bounds = getLocalBounds();
         
         // Background
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// OutputRouting  –  which output bus each voice renders into
+//
+// The processor declares the main stereo bus plus kNumAuxBuses optional
+// outputs (disabled until the host enables them). A voice resolves its
+// target once in startNote() and then renders straight into those channels
+// of the host buffer – there is no intermediate per-bus buffer or mix pass.
+//
+//   mainOnly        – everything on the main bus (default)
+//   perVoice        – voice N → aux bus N
+//   perMidiChannel  – MIDI channel N → aux bus N
+//
+// A disabled aux bus falls back to the main bus. The channel table is only
+// rewritten in prepareToPlay() (processing suspended); the mode can change
+// at any time and takes effect from the next note.
+// ─────────────────────────────────────────────────────────────────────────────
+struct OutputRouting
+{
+    enum Mode { mainOnly = 0, perVoice, perMidiChannel };
+
+    static constexpr int kNumAuxBuses = 16;   // one per MIDI channel
+
+    struct Target {
+        int firstChannel = 0;   // index into the processBlock buffer
+        int numChannels  = 0;   // 0 = bus disabled
+    };
+
+    std::atomic<int>                  mode { mainOnly };
+    Target                            main { 0, 2 };
+    std::array<Target, kNumAuxBuses>  aux {};
+
+    // voiceIndex is 0-based, midiChannel is 1-16 (0 if unknown)
+    Target resolve(int voiceIndex, int midiChannel) const
+    {
+        int bus = -1;
+        switch (mode.load()) {
+            case perVoice:       bus = voiceIndex;      break;
+            case perMidiChannel: bus = midiChannel - 1; break;
+            default:                                    break;
+        }
+        if (bus >= 0 && bus < kNumAuxBuses && aux[size_t(bus)].numChannels > 0)
+            return aux[size_t(bus)];
+        return main;
+    }
+};
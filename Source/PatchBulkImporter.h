@@ -0,0 +1,170 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PatchBulkImporter.h  –  parses whole folders of patch files in the background
+//
+// Folders are walked recursively for every format in PatchCodec.h. Each file
+// is decoded from a memory mapping (PatchFile.h) and reduced to one
+// ImportedPatch per patch – a bank gives one per voice: name, source file,
+// the patch in the plugin's UI units and whatever octave/LFO settings and
+// macros the format carries. Nothing touches the APVTS or the
+// program bank from the worker thread.
+//
+// Results reach the message thread in batches through onPatches, then
+// onFinished reports the totals. scanFolders() is the same walk as a plain
+// blocking call, for tools and other background workers.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <juce_events/juce_events.h>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "PatchFile.h"
+
+struct ImportedPatch
+{
+    juce::String name;
+    juce::File   file;
+    YM2612Patch  patch {};
+    int          block     = 0;
+    int          lfoEnable = 0;
+    int          lfoFreq   = 0;
+    std::vector<uint8_t> macros;
+};
+
+class PatchBulkImporter : private juce::Thread,
+                        private juce::AsyncUpdater
+{
+public:
+    struct Totals {
+        int parsed = 0;   // patches; a bank counts each voice
+        int failed = 0;   // files unreadable or not an FM instrument
+    };
+
+    // Message thread callbacks
+    std::function<void(std::vector<ImportedPatch>&&)> onPatches;
+    std::function<void(Totals, bool cancelled)>       onFinished;
+
+    PatchBulkImporter() : juce::Thread("Patch import") {}
+    ~PatchBulkImporter() override
+    {
+        stopThread(4000);
+        cancelPendingUpdate();
+    }
+
+    // ── Message thread ───────────────────────────────────────────────────────
+    // Entries may be folders (walked recursively) or single patch files.
+    // Returns false if an import is already running.
+    bool start(const juce::Array<juce::File>& sources)
+    {
+        if (isThreadRunning()) return false;
+        roots = sources;
+        cancelled = false;
+        return startThread(juce::Thread::Priority::low);
+    }
+
+    void cancel()              { cancelled = true; signalThreadShouldExit(); }
+    bool isRunning() const     { return isThreadRunning(); }
+    int  filesParsed() const   { return progress.load(); }
+
+    // ── Any thread ───────────────────────────────────────────────────────────
+    // Calls onPatch for every parsed file; stops early when shouldStop()
+    // returns true. Returns the totals.
+    static Totals scanFolders(const juce::Array<juce::File>& sources,
+                              const std::function<void(ImportedPatch&&)>& onPatch,
+                              const std::function<bool()>& shouldStop = {})
+    {
+        Totals totals;
+        auto importOne = [&](const juce::File& f) {
+            const bool bank = PatchFile::isBank(f);
+            int voice = 0;
+            const int n = PatchFile::readAll(f, [&](const PatchData& data) {
+                onPatch({ PatchFile::displayName(data, f, bank ? voice : -1), f,
+                          data.patch, data.block, data.lfoEnable, data.lfoFreq, data.macros });
+                ++voice;
+                return !(shouldStop && shouldStop());
+            });
+            if (n < 0) ++totals.failed;
+            else       totals.parsed += n;
+        };
+
+        for (const auto& source : sources) {
+            if (source.isDirectory()) {
+                for (const auto& entry : juce::RangedDirectoryIterator(source, true, PatchFile::wildcard(),
+                                                                       juce::File::findFiles)) {
+                    if (shouldStop && shouldStop()) return totals;
+                    importOne(entry.getFile());
+                }
+            } else if (source.existsAsFile()) {
+                if (shouldStop && shouldStop()) return totals;
+                importOne(source);
+            }
+        }
+        return totals;
+    }
+
+private:
+    static constexpr size_t kBatchSize = 256;
+
+    void run() override
+    {
+        progress = 0;
+        std::vector<ImportedPatch> batch;
+        batch.reserve(kBatchSize);
+
+        const auto totals = scanFolders(roots,
+            [&](ImportedPatch&& p) {
+                batch.push_back(std::move(p));
+                ++progress;
+                if (batch.size() >= kBatchSize) {
+                    deliver(std::move(batch));
+                    batch = {};
+                    batch.reserve(kBatchSize);
+                }
+            },
+            [this] { return threadShouldExit(); });
+
+        deliver(std::move(batch));
+
+        const juce::ScopedLock sl(pendingLock);
+        finalTotals = totals;
+        finished    = true;
+        triggerAsyncUpdate();
+    }
+
+    void deliver(std::vector<ImportedPatch>&& batch)
+    {
+        if (batch.empty()) return;
+        const juce::ScopedLock sl(pendingLock);
+        pending.insert(pending.end(), std::make_move_iterator(batch.begin()),
+                       std::make_move_iterator(batch.end()));
+        triggerAsyncUpdate();
+    }
+
+    void handleAsyncUpdate() override
+    {
+        std::vector<ImportedPatch> ready;
+        bool   done = false;
+        Totals totals;
+        {
+            const juce::ScopedLock sl(pendingLock);
+            ready.swap(pending);
+            done   = finished;
+            totals = finalTotals;
+            finished = false;
+        }
+        if (!ready.empty() && onPatches) onPatches(std::move(ready));
+        if (done && onFinished)          onFinished(totals, cancelled.load());
+    }
+
+    juce::Array<juce::File>    roots;
+    std::atomic<bool>          cancelled { false };
+    std::atomic<int>           progress { 0 };
+
+    juce::CriticalSection      pendingLock;
+    std::vector<ImportedPatch> pending;
+    Totals                     finalTotals;
+    bool                       finished = false;
+
+    JUCE_DECLARE_NON_COPYABLE(PatchBulkImporter)
+};
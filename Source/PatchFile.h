@@ -0,0 +1,84 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PatchFile.h  –  juce::File front end for the codecs in PatchCodec.h
+//
+// Files are decoded straight out of a read-only memory mapping – no copy of
+// the file contents is made. Files that cannot be mapped (empty files,
+// some network shares) fall back to a plain read. The codec is picked by
+// file extension; files with any other extension are sniffed. Banks
+// (.opm, .gyb) are only read through readAll().
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <juce_core/juce_core.h>
+#include "PatchCodec.h"
+
+namespace PatchFile {
+
+// Every supported extension, for file choosers and directory scans
+inline const juce::String& wildcard()
+{
+    static const juce::String w(PatchCodecs::wildcard());
+    return w;
+}
+
+// Decodes data that is already in memory; returns the codec used or nullptr
+inline const PatchCodec* decode(const juce::File& file, const uint8_t* data, size_t size, PatchData& out)
+{
+    return PatchCodecs::tryDecode(file.getFileExtension().toStdString(), data, size, out);
+}
+
+inline const PatchCodec* read(const juce::File& file, PatchData& out)
+{
+    const juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly, false);
+    if (mapped.getData() != nullptr)
+        return decode(file, static_cast<const uint8_t*>(mapped.getData()), mapped.getSize(), out);
+
+    juce::MemoryBlock mb;
+    if (!file.existsAsFile() || !file.loadFileAsData(mb)) return nullptr;
+    return decode(file, static_cast<const uint8_t*>(mb.getData()), mb.getSize(), out);
+}
+
+// Every patch in an instrument file or bank, streamed from the mapping: one
+// onPatch call per voice. Returns the number of patches, or -1 if the file
+// is in no known format.
+inline int readAll(const juce::File& file, const VoiceCallback& onPatch,
+                   PatchIndex::Format* format = nullptr)
+{
+    const auto extension = file.getFileExtension().toStdString();
+    const juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly, false);
+    if (mapped.getData() != nullptr)
+        return PatchCodecs::decodeAll(extension, static_cast<const uint8_t*>(mapped.getData()),
+                                      mapped.getSize(), onPatch, format);
+
+    juce::MemoryBlock mb;
+    if (!file.existsAsFile() || !file.loadFileAsData(mb)) return -1;
+    return PatchCodecs::decodeAll(extension, static_cast<const uint8_t*>(mb.getData()), mb.getSize(),
+                                  onPatch, format);
+}
+
+inline bool isBank(const juce::File& file)
+{
+    return PatchCodecs::bankForExtension(file.getFileExtension().toStdString()) != nullptr;
+}
+
+// Writes in the format of the file's extension; false if it has none we know
+inline bool write(const juce::File& file, const PatchData& in)
+{
+    const auto* codec = PatchCodecs::forExtension(file.getFileExtension().toStdString());
+    if (codec == nullptr) return false;
+    const auto bytes = codec->encode(in);
+    return file.replaceWithData(bytes.data(), bytes.size());
+}
+
+// Display name of a decoded patch: its own name, else the file name – with
+// the voice number for a bank voice (voice >= 0)
+inline juce::String displayName(const PatchData& data, const juce::File& file, int voice = -1)
+{
+    const auto name = juce::String::fromUTF8(data.name.data(), int(data.name.size())).trim();
+    if (name.isNotEmpty()) return name;
+    return voice < 0 ? file.getFileNameWithoutExtension()
+                     : file.getFileNameWithoutExtension() + " " + juce::String(voice + 1);
+}
+
+} // namespace PatchFile
@@ -0,0 +1,314 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PatchLibrary.h  –  the user's patch folder, browsed through a mapped index
+//
+// The library is one folder of patch files in any format PatchCodec.h
+// reads, searched recursively. Its PatchIndex lives in the app data folder
+// and is memory-mapped on startup, so even 10k+ patches can be browsed at
+// once without reading a single patch file.
+//
+// Rescans run on a background thread. Each file's mtime and size are
+// compared with its old record; unchanged files keep their record and only
+// new or changed files are parsed. The new index is written next to the
+// old one and swapped in on the message thread, which then sends a change
+// message. Shared by all plugin instances (juce::SharedResourcePointer).
+//
+// Files whose patches sound the same (PatchIndex::canonicalImage) share
+// one patch record; getPatchId() tells the browser which entries are
+// duplicates of each other.
+//
+// After every index swap the library hands its patch records to
+// PatchThumbnails, which renders audition thumbnails for new patches in
+// the background (cached in PatchLibrary.thumbs).
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <juce_data_structures/juce_data_structures.h>
+#include <juce_events/juce_events.h>
+#include <unordered_map>
+#include "PatchFile.h"
+#include "PatchIndex.h"
+#include "PatchThumbnails.h"
+
+class PatchLibrary : public juce::ChangeBroadcaster,
+                     private juce::Thread,
+                     private juce::AsyncUpdater
+{
+public:
+    struct ScanStats {
+        int parsed   = 0;   // new or changed files
+        int reused   = 0;   // unchanged, records kept
+        int failed   = 0;   // new or changed files that gave no patch
+        int skipped  = 0;   // unchanged files that gave no patch last time
+        int removed  = 0;   // in the old index, gone from disk
+        int distinct = 0;   // patch records after deduplication
+        double seconds = 0.0;
+    };
+
+    PatchLibrary() : juce::Thread("Patch library scan")
+    {
+        juce::PropertiesFile::Options o;
+        o.applicationName     = "ARM2612";
+        o.folderName          = "ARM2612";
+        o.filenameSuffix      = "settings";
+        o.osxLibrarySubFolder = "Application Support";
+        settings  = std::make_unique<juce::PropertiesFile>(o);
+        cacheFile = o.getDefaultFile().getSiblingFile("PatchLibrary.idx");
+        thumbnails = std::make_unique<PatchThumbnails>(cacheFile.getSiblingFile("PatchLibrary.thumbs"));
+
+        folder = juce::File(settings->getValue("libraryFolder"));
+        mapIndex();
+        updateThumbnails();
+        if (folder.isDirectory()) rescan();
+    }
+
+    ~PatchLibrary() override
+    {
+        stopThread(4000);
+        cancelPendingUpdate();
+    }
+
+    // ── Message thread ───────────────────────────────────────────────────────
+    juce::File getFolder() const { return folder; }
+
+    void setFolder(const juce::File& dir)
+    {
+        if (dir == folder) return;
+        stopThread(4000);
+        folder = dir;
+        settings->setValue("libraryFolder", dir.getFullPathName());
+        settings->saveIfNeeded();
+        rescan();
+    }
+
+    void rescan()
+    {
+        if (isThreadRunning()) return;
+        handleUpdateNowIfNeeded();   // swap in a finished scan first
+        scanFolder = folder;
+        startThread(juce::Thread::Priority::low);
+    }
+
+    bool      isScanning() const   { return isThreadRunning(); }
+    ScanStats lastScan() const     { return stats; }
+
+    int size() const { return int(view.size()); }
+
+    // Number of distinct patches; entries with equal ids are duplicates
+    int numPatches() const      { return int(view.numRecords()); }
+    int getPatchId(int i) const { return int(view.entry(size_t(i)).record); }
+
+    const PatchIndex::Record& getRecord(int i) const { return view.record(size_t(i)); }
+
+    juce::String getName(int i) const
+    {
+        const auto s = view.name(size_t(i));
+        return juce::String::fromUTF8(s.data(), int(s.size()));
+    }
+
+    juce::File getFile(int i) const
+    {
+        const auto s = view.path(size_t(i));
+        return juce::File(juce::String::fromUTF8(s.data(), int(s.size())));
+    }
+
+    // Sends its own change messages as thumbnails arrive
+    PatchThumbnails& getThumbnails() { return *thumbnails; }
+
+    // nullptr while the patch has not been rendered yet
+    const PatchThumbnail::Thumbnail* getThumbnail(int i) const
+    {
+        return thumbnails->find(getRecord(i).canonicalHash);
+    }
+
+    void getPatch(int i, YM2612Patch& patch, int& block, int& lfoEnable, int& lfoFreq) const
+    {
+        const auto& r = getRecord(i);
+        patch     = PatchIndex::getPatch(r);
+        block     = r.block;
+        lfoEnable = r.lfoEnable;
+        lfoFreq   = r.lfoFreq;
+    }
+
+private:
+    juce::File newIndexFile() const { return cacheFile.getSiblingFile("PatchLibrary.idx.new"); }
+
+    void mapIndex()
+    {
+        view.close();
+        mapped.reset();
+        if (!cacheFile.existsAsFile()) return;
+
+        mapped = std::make_unique<juce::MemoryMappedFile>(cacheFile, juce::MemoryMappedFile::readOnly, false);
+        if (mapped->getData() == nullptr || !view.open(mapped->getData(), mapped->getSize())) {
+            DBG("Patch library: ignoring unreadable index " << cacheFile.getFullPathName());
+            view.close();
+            mapped.reset();
+        }
+    }
+
+    void updateThumbnails()
+    {
+        std::vector<PatchThumbnails::Request> requests;
+        requests.reserve(view.numRecords());
+        for (size_t r = 0; r < view.numRecords(); ++r)
+            requests.push_back({ view.recordAt(r).canonicalHash, PatchIndex::getImage(view.recordAt(r)) });
+        thumbnails->update(std::move(requests));
+    }
+
+    // ── Scan thread ──────────────────────────────────────────────────────────
+    // Reads the current view (never swapped while this runs) and writes
+    // PatchLibrary.idx.new.
+    void run() override
+    {
+        const auto t0 = juce::Time::getMillisecondCounterHiRes();
+        ScanStats s;
+
+        // path → (first entry, entry count); a bank's voices are consecutive
+        std::unordered_map<std::string_view, std::pair<size_t, size_t>> old;
+        old.reserve(view.size());
+        for (size_t i = 0; i < view.size(); ++i) {
+            auto [it, added] = old.try_emplace(view.path(i), i, 0);
+            ++it->second.second;
+        }
+        std::unordered_map<std::string_view, size_t> oldFailed;
+        oldFailed.reserve(view.numFailed());
+        for (size_t f = 0; f < view.numFailed(); ++f)
+            oldFailed.emplace(view.failedPath(f), f);
+
+        PatchIndex::Builder builder;
+        size_t matched = 0;
+
+        if (scanFolder.isDirectory()) {
+            for (const auto& entry : juce::RangedDirectoryIterator(scanFolder, true, PatchFile::wildcard(),
+                                                                   juce::File::findFiles)) {
+                if (threadShouldExit()) return;
+
+                const auto path  = entry.getFile().getFullPathName().toStdString();
+                const auto mtime = entry.getModificationTime().toMilliseconds();
+                const auto bytes = uint64_t(entry.getFileSize());
+
+                const auto it = old.find(path);
+                if (it != old.end()) {
+                    ++matched;
+                    const auto [first, count] = it->second;
+                    const auto& e = view.entry(first);
+                    if (e.mtimeMs == mtime && e.fileSize == bytes) {
+                        for (size_t i = first; i < first + count; ++i)
+                            builder.add(view.entry(i), view.record(i), path, view.name(i));
+                        ++s.reused;
+                        continue;
+                    }
+                }
+                const auto bad = oldFailed.find(path);
+                if (bad != oldFailed.end()) {
+                    ++matched;
+                    const auto& f = view.failed(bad->second);
+                    if (f.mtimeMs == mtime && f.fileSize == bytes) {
+                        builder.addFailed(mtime, bytes, path);
+                        ++s.skipped;
+                        continue;
+                    }
+                }
+
+                PatchIndex::Entry e {};
+                e.mtimeMs  = mtime;
+                e.fileSize = bytes;
+                size_t voices = 0;
+                const bool ok = parseFile(entry.getFile(), e,
+                    [&](const PatchIndex::Record& r, const std::string& name) {
+                        builder.add(e, r, path, name);
+                        ++voices;
+                        return !threadShouldExit();
+                    });
+                if (threadShouldExit()) return;
+                if (ok) ++s.parsed;
+                else    ++s.failed;
+                if (voices == 0)
+                    builder.addFailed(mtime, bytes, path);   // remembered, so unchanged it is not parsed again
+            }
+        }
+        s.removed  = int(old.size() + oldFailed.size() - matched);
+        s.distinct = int(builder.numRecords());
+
+        const auto data = builder.finish();
+        const auto tmp  = newIndexFile();
+        tmp.getParentDirectory().createDirectory();
+        if (!tmp.replaceWithData(data.data(), data.size())) {
+            DBG("Patch library: cannot write " << tmp.getFullPathName());
+            return;
+        }
+
+        s.seconds = (juce::Time::getMillisecondCounterHiRes() - t0) / 1000.0;
+        const juce::ScopedLock sl(resultLock);
+        pendingStats = s;
+        scanFinished = true;
+        triggerAsyncUpdate();
+    }
+
+    // Decodes straight from a mapping; the same bytes feed the content hash.
+    // onPatch gets one record per patch – every voice of a bank – and may
+    // return false to stop. Returns false if the file is in no known format.
+    static bool parseFile(const juce::File& file, PatchIndex::Entry& e,
+                          const std::function<bool(const PatchIndex::Record&, const std::string&)>& onPatch)
+    {
+        const juce::MemoryMappedFile mappedFile(file, juce::MemoryMappedFile::readOnly, false);
+        const auto* data = static_cast<const uint8_t*>(mappedFile.getData());
+        if (data == nullptr) return false;
+
+        e.contentHash = PatchIndex::hashBytes(data, mappedFile.getSize());
+
+        const bool bank = PatchFile::isBank(file);
+        int voice = 0;
+        PatchIndex::Record r {};
+        const int n = PatchCodecs::decodeAll(file.getFileExtension().toStdString(), data, mappedFile.getSize(),
+            [&](const PatchData& patch) {
+                r = {};
+                PatchIndex::setPatch(r, patch.patch, patch.block, patch.lfoEnable, patch.lfoFreq);
+                return onPatch(r, PatchFile::displayName(patch, file, bank ? voice++ : -1).toStdString());
+            },
+            &e.format);
+        return n >= 0;
+    }
+
+    // ── Message thread ───────────────────────────────────────────────────────
+    void handleAsyncUpdate() override
+    {
+        {
+            const juce::ScopedLock sl(resultLock);
+            if (!scanFinished) return;
+            scanFinished = false;
+            stats = pendingStats;
+        }
+
+        // Unmap before replacing – Windows cannot replace a mapped file
+        view.close();
+        mapped.reset();
+        if (!newIndexFile().moveFileTo(cacheFile))
+            DBG("Patch library: cannot replace " << cacheFile.getFullPathName());
+        mapIndex();
+        updateThumbnails();
+
+        DBG("Patch library: " << size() << " patches (" << numPatches() << " distinct), " << stats.parsed << " parsed, "
+            << stats.reused << " unchanged, " << stats.failed << " failed, " << stats.skipped
+            << " skipped, " << stats.removed << " removed in "
+            << juce::String(stats.seconds, 3) << " s");
+        sendChangeMessage();
+    }
+
+    std::unique_ptr<juce::PropertiesFile>   settings;
+    juce::File                              cacheFile;
+    juce::File                              folder;
+    juce::File                              scanFolder;   // copy for the scan thread
+
+    std::unique_ptr<PatchThumbnails>        thumbnails;
+    std::unique_ptr<juce::MemoryMappedFile> mapped;
+    PatchIndex::View                        view;
+    ScanStats                               stats;
+
+    juce::CriticalSection                   resultLock;
+    ScanStats                               pendingStats;
+    bool                                    scanFinished = false;
+
+    JUCE_DECLARE_NON_COPYABLE(PatchLibrary)
+};
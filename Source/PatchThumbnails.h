@@ -0,0 +1,167 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PatchThumbnails.h  –  renders and caches audition thumbnails for the library
+//
+// update() takes every patch record of the current library index. Records
+// whose canonical hash already has a thumbnail keep it; the rest are split
+// into jobs for a low-priority ThreadPool with one thread per spare core.
+// Each job renders its patches with its own Ym2612Engine (PatchThumbnail)
+// and checks shouldExit() between patches, so cancel() – and a new
+// update() – return quickly.
+//
+// Finished thumbnails reach the message thread through an AsyncUpdater,
+// which sends a change message; when the last job is done the cache file
+// (PatchLibrary.thumbs, next to the index) is rewritten with only the
+// current library's thumbnails.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <juce_events/juce_events.h>
+#include <unordered_map>
+#include <unordered_set>
+#include "PatchIndex.h"
+#include "PatchThumbnail.h"
+
+class PatchThumbnails : public juce::ChangeBroadcaster,
+                        private juce::AsyncUpdater
+{
+public:
+    struct Request {
+        uint64_t                    hash;
+        Ym2612Engine::RegisterImage image;
+    };
+
+    explicit PatchThumbnails(const juce::File& cache)
+        : cacheFile(cache),
+          pool(juce::ThreadPoolOptions{}
+                   .withThreadName("Patch thumbnails")
+                   .withNumberOfThreads(juce::jmax(1, juce::SystemStats::getNumCpus() - 1))
+                   .withDesiredThreadPriority(juce::Thread::Priority::low))
+    {
+        juce::MemoryBlock data;
+        std::vector<PatchThumbnail::Thumbnail> loaded;
+        if (cacheFile.loadFileAsData(data) && PatchThumbnail::read(data.getData(), data.getSize(), loaded))
+            for (const auto& t : loaded) thumbs.emplace(t.hash, t);
+    }
+
+    ~PatchThumbnails() override
+    {
+        cancel();
+        cancelPendingUpdate();
+    }
+
+    // ── Message thread ───────────────────────────────────────────────────────
+    // Call with every record of the library after each index swap
+    void update(std::vector<Request> records)
+    {
+        cancel();
+        handleUpdateNowIfNeeded();   // keep whatever the cancelled jobs finished
+
+        std::unordered_set<uint64_t> wanted;
+        std::vector<Request> missing;
+        for (auto& r : records) {
+            if (!wanted.insert(r.hash).second) continue;
+            if (thumbs.find(r.hash) == thumbs.end()) missing.push_back(r);
+        }
+
+        // Forget thumbnails of patches that left the library
+        const auto before = thumbs.size();
+        for (auto it = thumbs.begin(); it != thumbs.end();)
+            it = wanted.count(it->first) ? std::next(it) : thumbs.erase(it);
+
+        if (missing.empty()) {
+            if (thumbs.size() != before) save();
+            return;
+        }
+
+        remaining = int(missing.size());
+        for (size_t from = 0; from < missing.size(); from += kJobSize) {
+            const auto to = std::min(missing.size(), from + kJobSize);
+            pool.addJob(new RenderJob(*this, { missing.begin() + long(from), missing.begin() + long(to) }), true);
+        }
+    }
+
+    void cancel() { pool.removeAllJobs(true, 4000); remaining = 0; }
+
+    bool isRendering() const { return remaining > 0; }
+    int  pendingCount() const { return remaining; }
+
+    // nullptr until the patch has been rendered
+    const PatchThumbnail::Thumbnail* find(uint64_t hash) const
+    {
+        const auto it = thumbs.find(hash);
+        return it != thumbs.end() ? &it->second : nullptr;
+    }
+
+private:
+    static constexpr size_t kJobSize = 16;
+
+    class RenderJob : public juce::ThreadPoolJob
+    {
+    public:
+        RenderJob(PatchThumbnails& o, std::vector<Request> r)
+            : juce::ThreadPoolJob("Thumbnail render"), owner(o), requests(std::move(r)) {}
+
+        JobStatus runJob() override
+        {
+            std::vector<PatchThumbnail::Thumbnail> done;
+            done.reserve(requests.size());
+            for (const auto& r : requests) {
+                if (shouldExit()) break;
+                done.push_back(PatchThumbnail::render(r.image, r.hash));
+            }
+            owner.deliver(std::move(done));
+            return jobHasFinished;
+        }
+
+    private:
+        PatchThumbnails&     owner;
+        std::vector<Request> requests;
+    };
+
+    // ── Pool threads ─────────────────────────────────────────────────────────
+    void deliver(std::vector<PatchThumbnail::Thumbnail>&& done)
+    {
+        const juce::ScopedLock sl(pendingLock);
+        pending.insert(pending.end(), done.begin(), done.end());
+        triggerAsyncUpdate();
+    }
+
+    // ── Message thread ───────────────────────────────────────────────────────
+    void handleAsyncUpdate() override
+    {
+        std::vector<PatchThumbnail::Thumbnail> ready;
+        {
+            const juce::ScopedLock sl(pendingLock);
+            ready.swap(pending);
+        }
+        if (ready.empty()) return;
+
+        for (const auto& t : ready) thumbs[t.hash] = t;
+        remaining = juce::jmax(0, remaining - int(ready.size()));
+        if (remaining == 0) save();   // also keeps what a cancelled run finished
+        sendChangeMessage();
+    }
+
+    void save()
+    {
+        std::vector<PatchThumbnail::Thumbnail> all;
+        all.reserve(thumbs.size());
+        for (const auto& [hash, t] : thumbs) all.push_back(t);
+        const auto data = PatchThumbnail::write(std::move(all));
+        cacheFile.getParentDirectory().createDirectory();
+        if (!cacheFile.replaceWithData(data.data(), data.size()))
+            DBG("Patch thumbnails: cannot write " << cacheFile.getFullPathName());
+    }
+
+    juce::File                                               cacheFile;
+    std::unordered_map<uint64_t, PatchThumbnail::Thumbnail>  thumbs;
+    int                                                      remaining = 0;
+
+    juce::CriticalSection                                    pendingLock;
+    std::vector<PatchThumbnail::Thumbnail>                   pending;
+
+    juce::ThreadPool                                         pool;   // last: jobs use the members above
+
+    JUCE_DECLARE_NON_COPYABLE(PatchThumbnails)
+};
@@ -1,18 +1,36 @@
 #pragma once
 
+#include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 #include "BuiltInPatches.h"
 #include "PatchSerializer.h"
+#include "PatchLibrary.h"
+#include "PatchSearch.h"
+#include "PatchSimilarity.h"
+#include "PatchCompiler.h"
 
 // =============================================================================
-// PatchesPanel - List of built-in patches with code preview
+// PatchesPanel - Built-in patches, then the user library, with code preview
+//
+// The search box filters the list on every keystroke (PatchSearch): fuzzy
+// name/folder text plus parameter filters such as "alg=4 fb>=5 ssg>0".
+// Library files with the same patch (see PatchLibrary) are grouped into one
+// row, listed under the first file's name with a "+N" duplicate count.
+// Library rows show the patch's audition thumbnail (PatchThumbnails) on the
+// right once it has been rendered. "Similar" renders the synth's current
+// patch the same way and orders the matches by distance between feature
+// vectors (PatchSimilarity); patches without a thumbnail yet sort last.
+// List rows index visibleRows; selectedPatch and onPatchSelected use the
+// full index (built-ins first, then the library groups).
 // =============================================================================
-class PatchesPanel : public juce::Component, public juce::ListBoxModel
+class PatchesPanel : public juce::Component, public juce::ListBoxModel,
+                     private juce::ChangeListener
 {
 public:
     std::function<void()> onClose;
     std::function<void(int)> onPatchSelected;
     std::function<void(const YM2612Patch&, int, int, int)> onPatchLoaded;  // Load patch into synth
+    std::function<void(YM2612Patch&, int&, int&, int&)> getCurrentPatch;   // Synth's patch, for "Similar"
     
     PatchesPanel(const YM2612Patch& currentPatch, int currentBlock, int currentLfoEnable, int currentLfoFreq)
         : patchList("Patches", nullptr), 
@@ -111,6 +129,45 @@ public:
         patchList.setColour(juce::ListBox::outlineColourId, juce::Colour(0xFF252540));
         patchList.selectRow(0);
         addAndMakeVisible(patchList);
+        
+        // Search box above the list
+        searchBox.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
+        searchBox.setTextToShowWhenEmpty("Search: name, folder, alg=4 fb>=5 ssg>0 ...", juce::Colour(0xFF666666));
+        searchBox.setColour(juce::TextEditor::backgroundColourId, juce::Colour(0xFF0D0D1A));
+        searchBox.setColour(juce::TextEditor::textColourId, juce::Colour(0xFFCCCCCC));
+        searchBox.setColour(juce::TextEditor::outlineColourId, juce::Colour(0xFF252540));
+        searchBox.onTextChange = [this]() { applySearch(); };
+        searchBox.onEscapeKey  = [this]() { searchBox.clear(); applySearch(); };
+        addAndMakeVisible(searchBox);
+        
+        similarButton.setButtonText("Similar");
+        similarButton.setClickingTogglesState(true);
+        similarButton.setTooltip("Order the list by how close each patch sounds to the current one");
+        similarButton.onClick = [this]() { setSimilarityOrder(similarButton.getToggleState()); };
+        addAndMakeVisible(similarButton);
+        
+        // Library folder + rescan
+        folderButton.setButtonText("Library folder...");
+        folderButton.onClick = [this]() { chooseLibraryFolder(); };
+        addAndMakeVisible(folderButton);
+        
+        rescanButton.setButtonText("Rescan");
+        rescanButton.onClick = [this]() { library->rescan(); updateLibraryStatus(); };
+        addAndMakeVisible(rescanButton);
+        
+        libraryStatus.setFont(juce::Font("Courier New", 10.0f, juce::Font::plain));
+        libraryStatus.setColour(juce::Label::textColourId, juce::Colour(0xFF888888));
+        addAndMakeVisible(libraryStatus);
+        
+        library->addChangeListener(this);
+        library->getThumbnails().addChangeListener(this);
+        rebuildSearch();
+    }
+    
+    ~PatchesPanel() override
+    {
+        library->getThumbnails().removeChangeListener(this);
+        library->removeChangeListener(this);
     }
 
     void paint(juce::Graphics& g) override
@@ -126,7 +183,7 @@ public:
         // Title
         g.setColour(juce::Colour(0xFF00D4AA));
         g.setFont(juce::Font("Courier New", 14.f, juce::Font::bold));
-        g.drawText("Built-in Patches", getLocalBounds().withHeight(40).reduced(16, 0),
+        g.drawText("Patches", getLocalBounds().withHeight(40).reduced(16, 0),
                    juce::Justification::centredLeft);
     }
 
@@ -166,13 +223,28 @@ public:
         listArea.removeFromLeft(8); // Gap between code and list
         
         codeDisplay.setBounds(bounds);
+        
+        // Search box over the list, library controls under it
+        auto searchRow = listArea.removeFromTop(26);
+        similarButton.setBounds(searchRow.removeFromRight(70));
+        searchRow.removeFromRight(6);
+        searchBox.setBounds(searchRow);
+        listArea.removeFromTop(6);
+        
+        auto libraryArea = listArea.removeFromBottom(48);
+        libraryStatus.setBounds(libraryArea.removeFromBottom(18));
+        libraryArea.removeFromBottom(4);
+        rescanButton.setBounds(libraryArea.removeFromRight(70));
+        libraryArea.removeFromRight(6);
+        folderButton.setBounds(libraryArea);
+        listArea.removeFromBottom(6);
         patchList.setBounds(listArea);
     }
     
     // ListBoxModel methods
     int getNumRows() override
     {
-        return kNumBuiltInPatches;
+        return int(visibleRows.size());
     }
     
     void paintListBoxItem(int rowNumber, juce::Graphics& g, int width, int height, bool rowIsSelected) override
@@ -180,7 +252,11 @@ public:
         if (rowNumber < 0 || rowNumber >= getNumRows())
             return;
             
-        auto& patch = kBuiltInPatches[rowNumber];
+        const int index = int(visibleRows[size_t(rowNumber)]);
+        const bool isLibrary = index >= kNumBuiltInPatches;
+        const auto* group = isLibrary ? &libraryGroups[size_t(index - kNumBuiltInPatches)] : nullptr;
+        const juce::String name = isLibrary ? library->getName(group->front())
+                                            : juce::String(kBuiltInPatches[index].name);
         
         // Background
         if (rowIsSelected)
@@ -190,37 +266,91 @@ public:
         else
             g.fillAll(juce::Colour(0xFF0D0D1A));
         
-        // Patch name (centered)
-        g.setColour(rowIsSelected ? juce::Colour(0xFF00D4AA) : juce::Colour(0xFFCCCCCC));
+        // Patch name (library patches a little dimmer than built-ins), then
+        // duplicate count and thumbnail on the right
         g.setFont(juce::Font("Courier New", 12.f, juce::Font::plain));
-        g.drawText(patch.name, 8, 0, width - 16, height, juce::Justification::centredLeft);
+        auto area = juce::Rectangle<int>(8, 0, width - 16, height);
+        if (isLibrary) {
+            const auto thumbArea = area.removeFromRight(thumbnailWidth).reduced(0, 4);
+            if (const auto* thumb = library->getThumbnail(group->front()))
+                paintThumbnail(g, *thumb, thumbArea.toFloat(), rowIsSelected);
+            area.removeFromRight(6);
+        }
+        
+        if (group != nullptr && group->size() > 1) {
+            g.setColour(juce::Colour(0xFF666666));
+            g.drawText("+" + juce::String(int(group->size()) - 1), area.removeFromRight(32),
+                       juce::Justification::centredRight);
+        }
+        
+        g.setColour(rowIsSelected ? juce::Colour(0xFF00D4AA)
+                                  : juce::Colour(isLibrary ? 0xFFAAAAAA : 0xFFCCCCCC));
+        g.drawText(name, area, juce::Justification::centredLeft);
+    }
+    
+    // Envelope mirrored around the centre line, one bar per bin
+    static void paintThumbnail(juce::Graphics& g, const PatchThumbnail::Thumbnail& thumb,
+                               juce::Rectangle<float> r, bool selected)
+    {
+        const float barWidth = r.getWidth() / PatchThumbnail::kBins;
+        const float centre   = r.getCentreY();
+        const float halfH    = r.getHeight() * 0.5f;
+        const float holdEnd  = float(PatchThumbnail::kHoldSeconds
+                                     / (PatchThumbnail::kHoldSeconds + PatchThumbnail::kReleaseSeconds));
+        
+        g.setColour(juce::Colour(selected ? 0xFF00D4AA : 0xFF3A7A6A));
+        for (int b = 0; b < PatchThumbnail::kBins; ++b) {
+            const float h = juce::jmax(0.5f, thumb.envelope[b] / 255.0f * halfH);
+            g.fillRect(r.getX() + b * barWidth, centre - h, juce::jmax(1.0f, barWidth - 0.5f), 2.0f * h);
+        }
+        // Key-off
+        g.setColour(juce::Colour(0x40FFFFFF));
+        g.drawVerticalLine(juce::roundToInt(r.getX() + holdEnd * r.getWidth()), r.getY(), r.getBottom());
     }
     
     void listBoxItemClicked(int row, const juce::MouseEvent&) override
     {
-        if (row >= 0 && row < getNumRows())
-        {
-            selectedPatch = row;
-            auto& entry = kBuiltInPatches[row];
-            codeDisplay.setText(PatchSerializer::serializePatch(*entry.patch, entry.name,
-                                                                entry.block, entry.lfoEnable, entry.lfoFreq));
-            codeModified = false;
-            validateButton.setEnabled(false);
-            errorLabel.setText("", juce::dontSendNotification);
-            
-            // Load patch into synth immediately
-            if (onPatchLoaded)
-                onPatchLoaded(*entry.patch, entry.block, entry.lfoEnable, entry.lfoFreq);
+        if (row < 0 || row >= getNumRows())
+            return;
+        
+        const int index = int(visibleRows[size_t(row)]);
+        selectedPatch = index;
+        YM2612Patch patch;
+        int block, lfoEnable, lfoFreq;
+        juce::String name, details;   // library: thumbnail levels and duplicates
+        if (index < kNumBuiltInPatches) {
+            auto& entry = kBuiltInPatches[index];
+            patch = *entry.patch;
+            block = entry.block;  lfoEnable = entry.lfoEnable;  lfoFreq = entry.lfoFreq;
+            name  = entry.name;
+        } else {
+            const auto& group = libraryGroups[size_t(index - kNumBuiltInPatches)];
+            library->getPatch(group.front(), patch, block, lfoEnable, lfoFreq);
+            name = library->getName(group.front());
+            if (const auto* thumb = library->getThumbnail(group.front()))
+                details << "Peak " << juce::String(juce::Decibels::gainToDecibels(thumb->peak), 1)
+                        << " dB, RMS " << juce::String(juce::Decibels::gainToDecibels(thumb->rms), 1) << " dB  ";
+            for (size_t i = 1; i < group.size(); ++i)
+                details << (i > 1 ? ", " : "Same patch as: ") << library->getName(group[i]);
         }
+        codeDisplay.setText(PatchSerializer::serializePatch(patch, name, block, lfoEnable, lfoFreq));
+        codeModified = false;
+        validateButton.setEnabled(false);
+        errorLabel.setText(details, juce::dontSendNotification);
+        errorLabel.setColour(juce::Label::textColourId, juce::Colour(0xFF888888));
+        
+        // Load patch into synth immediately
+        if (onPatchLoaded)
+            onPatchLoaded(patch, block, lfoEnable, lfoFreq);
         
         if (onPatchSelected)
-            onPatchSelected(row);
+            onPatchSelected(index);
     }
     
     void listBoxItemDoubleClicked(int row, const juce::MouseEvent&) override
     {
-        if (onPatchSelected)
-            onPatchSelected(row);
+        if (row >= 0 && row < getNumRows() && onPatchSelected)
+            onPatchSelected(int(visibleRows[size_t(row)]));
         if (onClose)
             onClose();
     }
@@ -260,6 +390,168 @@ public:
     }
 
 private:
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override
+    {
+        // More thumbnails rendered: only the rows change, unless they are
+        // ordered by similarity
+        if (source == &library->getThumbnails()) {
+            if (similarityActive) {
+                rebuildSimilarity();
+                applySearch();
+            } else {
+                patchList.repaint();
+                updateLibraryStatus();
+            }
+            return;
+        }
+        
+        // A rescan finished: library indices may have moved
+        if (selectedPatch >= kNumBuiltInPatches)
+            selectedPatch = -1;
+        rebuildSearch();
+    }
+    
+    // Built-ins are tagged "built-in", library patches with their folder
+    // path inside the library, so "bass" also finds everything in Bass/.
+    // A duplicate group is searchable under every member's name and folder.
+    void rebuildSearch()
+    {
+        libraryGroups.assign(size_t(library->numPatches()), {});
+        for (int i = 0; i < library->size(); ++i)
+            libraryGroups[size_t(library->getPatchId(i))].push_back(i);
+        
+        std::vector<PatchSearch::Item> items;
+        items.reserve(size_t(kNumBuiltInPatches) + libraryGroups.size());
+        
+        for (int i = 0; i < kNumBuiltInPatches; ++i) {
+            const auto& entry = kBuiltInPatches[i];
+            PatchSearch::Item item;
+            item.text = std::string(entry.name) + " built-in";
+            PatchIndex::setPatch(item.record, *entry.patch, entry.block, entry.lfoEnable, entry.lfoFreq);
+            items.push_back(std::move(item));
+        }
+        
+        const auto root = library->getFolder();
+        for (const auto& group : libraryGroups) {
+            juce::String text;
+            for (int i : group) {
+                const auto tags = library->getFile(i).getParentDirectory().getRelativePathFrom(root);
+                text << library->getName(i) << " " << (tags == "." ? juce::String() : tags) << " ";
+            }
+            PatchSearch::Item item;
+            item.text   = text.toStdString();
+            item.record = library->getRecord(group.front());
+            items.push_back(std::move(item));
+        }
+        
+        search.build(items);
+        rebuildSimilarity();
+        applySearch();
+    }
+    
+    // Snapshot the synth's patch and render its features once per toggle
+    void setSimilarityOrder(bool on)
+    {
+        similarityActive = on && getCurrentPatch != nullptr;
+        if (similarityActive) {
+            YM2612Patch patch;
+            int block, lfoEnable, lfoFreq;
+            getCurrentPatch(patch, block, lfoEnable, lfoFreq);
+            similarityTarget = PatchThumbnail::render(compilePatch(patch, block, lfoFreq), 0);
+            rebuildSimilarity();
+        }
+        similarButton.setToggleState(similarityActive, juce::dontSendNotification);
+        applySearch();
+    }
+    
+    // Distances for every search item; built-ins have no thumbnails
+    void rebuildSimilarity()
+    {
+        if (!similarityActive) return;
+        std::vector<const float*> features(size_t(kNumBuiltInPatches), nullptr);
+        for (const auto& group : libraryGroups) {
+            const auto* thumb = library->getThumbnail(group.front());
+            features.push_back(thumb != nullptr ? thumb->features : nullptr);
+        }
+        PatchSimilarity similarity;
+        similarity.build(features);
+        similarityDistance = similarity.distances(similarityTarget.features);
+    }
+    
+    void applySearch()
+    {
+        const auto query = searchBox.getText().toStdString();
+        visibleRows = search.search(query);
+        queryError  = PatchSearch::checkQuery(query);
+        if (similarityActive && similarityDistance.size() == search.size())
+            std::stable_sort(visibleRows.begin(), visibleRows.end(), [this](uint32_t a, uint32_t b) {
+                return similarityDistance[a] < similarityDistance[b];
+            });
+        
+        patchList.updateContent();
+        const auto it = std::find(visibleRows.begin(), visibleRows.end(), uint32_t(selectedPatch));
+        if (it != visibleRows.end())
+            patchList.selectRow(int(it - visibleRows.begin()), true, true);
+        else
+            patchList.deselectAllRows();
+        patchList.repaint();
+        updateLibraryStatus();
+    }
+    
+    void updateLibraryStatus()
+    {
+        const auto folder = library->getFolder();
+        juce::String text;
+        if (queryError.size() > 0)
+            text = juce::String(queryError);
+        else if (similarityActive)
+            text << int(visibleRows.size()) << " patches, most similar first";
+        else if (visibleRows.size() != search.size())
+            text << int(visibleRows.size()) << " of " << int(search.size()) << " patches match";
+        else if (folder == juce::File())
+            text = "No library folder";
+        else
+            text << library->size() << " patches (" << library->numPatches() << " distinct) in "
+                 << folder.getFileName() << (library->isScanning() ? "  (scanning...)" : "")
+                 << (library->getThumbnails().isRendering()
+                         ? "  (" + juce::String(library->getThumbnails().pendingCount()) + " to audition)" : "");
+        libraryStatus.setText(text, juce::dontSendNotification);
+        libraryStatus.setColour(juce::Label::textColourId,
+                                juce::Colour(queryError.size() > 0 ? 0xFFFF4444 : 0xFF888888));
+        rescanButton.setEnabled(folder != juce::File());
+    }
+    
+    void chooseLibraryFolder()
+    {
+        chooser = std::make_unique<juce::FileChooser>("Patch library folder", library->getFolder());
+        chooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectDirectories,
+                             [this](const juce::FileChooser& fc) {
+                                 const auto dir = fc.getResult();
+                                 if (dir.isDirectory()) {
+                                     library->setFolder(dir);
+                                     updateLibraryStatus();
+                                 }
+                             });
+    }
+    
+    juce::SharedResourcePointer<PatchLibrary> library;   // shared by all instances
+    std::unique_ptr<juce::FileChooser> chooser;
+    juce::TextButton folderButton;
+    juce::TextButton rescanButton;
+    juce::Label libraryStatus;
+    static constexpr int thumbnailWidth = 64;
+    
+    juce::TextEditor searchBox;
+    PatchSearch search;
+    std::vector<uint32_t> visibleRows;   // full indices of the listed patches
+    std::vector<std::vector<int>> libraryGroups;   // library entries per patch id, file order
+    
+    juce::TextButton similarButton;
+    bool similarityActive = false;
+    PatchThumbnail::Thumbnail similarityTarget {};
+    std::vector<float> similarityDistance;         // per search item
+    std::string queryError;
+    
     juce::ListBox patchList;
     juce::TextEditor codeDisplay;
     juce::TextEditor originalPatchDisplay;
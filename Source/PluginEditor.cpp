@@ -190,16 +190,26 @@ void ARM2612AudioProcessorEditor::setupGlobalControls()
     addAndMakeVisible(octaveSlider);
     
     // Import/Export buttons
-    importBtn.setButtonText("Import .fui");
+    importBtn.setButtonText("Import...");
     importBtn.onClick = [this]() {
         auto chooser = std::make_shared<juce::FileChooser>(
-            "Import Furnace Instrument", juce::File(), "*.fui");
+            "Import Instrument(s) or a folder", juce::File(), PatchFile::wildcard());
         auto flags = juce::FileBrowserComponent::openMode | 
-                     juce::FileBrowserComponent::canSelectFiles;
+                     juce::FileBrowserComponent::canSelectFiles |
+                     juce::FileBrowserComponent::canSelectDirectories |
+                     juce::FileBrowserComponent::canSelectMultipleItems;
         chooser->launchAsync(flags, [this, chooser](const juce::FileChooser& fc) {
+            const auto results = fc.getResults();
+            // Folders, several files and banks (one program per voice) go
+            // through the background importer
+            if (results.size() > 1
+                || (results.size() == 1 && (results[0].isDirectory() || PatchFile::isBank(results[0])))) {
+                importPatchFolders(results);
+                return;
+            }
             auto file = fc.getResult();
             if (file.existsAsFile()) {
-                if (audioProcessor.importFurnaceInstrument(file)) {
+                if (audioProcessor.importInstrument(file)) {
                     // Update the instrument name label
                     juce::String newName = audioProcessor.getInstrumentName();
                     DBG("=== UI UPDATE ===");
@@ -212,35 +222,36 @@ void ARM2612AudioProcessorEditor::setupGlobalControls()
                 } else {
                     juce::AlertWindow::showMessageBoxAsync(
                         juce::AlertWindow::WarningIcon, "Import Failed",
-                        "Could not load Furnace instrument file.");
+                        "Could not read " + file.getFileName() + " as an FM instrument.");
                 }
             }
         });
     };
     addAndMakeVisible(importBtn);
     
-    exportBtn.setButtonText("Export .fui");
+    exportBtn.setButtonText("Export...");
     exportBtn.onClick = [this]() {
         auto chooser = std::make_shared<juce::FileChooser>(
-            "Export Furnace Instrument", juce::File(), "*.fui");
+            "Export Instrument (.fui, .opni, .dmp, .y12 or .tfi)", juce::File(), PatchFile::wildcard());
         auto flags = juce::FileBrowserComponent::saveMode | 
                      juce::FileBrowserComponent::canSelectFiles |
                      juce::FileBrowserComponent::warnAboutOverwriting;
         chooser->launchAsync(flags, [this, chooser](const juce::FileChooser& fc) {
             auto file = fc.getResult();
             if (file != juce::File()) {
-                if (!file.hasFileExtension(".fui"))
+                // The extension picks the format; anything else is saved as .fui
+                if (PatchCodecs::forExtension(file.getFileExtension().toStdString()) == nullptr)
                     file = file.withFileExtension(".fui");
                 // Use current instrument name
                 juce::String name = audioProcessor.getInstrumentName();
-                if (audioProcessor.exportFurnaceInstrument(file, name))
+                if (audioProcessor.exportInstrument(file, name))
                     juce::AlertWindow::showMessageBoxAsync(
                         juce::AlertWindow::InfoIcon, "Export Successful",
                         "Saved: " + file.getFileName());
                 else
                     juce::AlertWindow::showMessageBoxAsync(
                         juce::AlertWindow::WarningIcon, "Export Failed",
-                        "Could not save Furnace instrument file.");
+                        "Could not save " + file.getFileName() + ".");
             }
         });
     };
@@ -262,18 +273,89 @@ void ARM2612AudioProcessorEditor::showSettings()
     auto* root = getTopLevelComponent();
     if (!root) return;
     
-    auto* panel = new SettingsPanel(tooltipsEnabled);
+    auto* panel = new SettingsPanel(tooltipsEnabled, audioProcessor.getOutputRoutingMode(),
+                                    audioProcessor.isVgmCapturing(),
+                                    audioProcessor.getDspProfiler());
     
     panel->onTooltipsChanged = [this](bool enabled) {
         tooltipsEnabled = enabled;
         updateTooltips(enabled);
     };
     
+    panel->onOutputRoutingChanged = [this](int mode) {
+        audioProcessor.setOutputRoutingMode(mode);
+    };
+    
+    panel->onVgmCaptureClicked = [this, safePanel = juce::Component::SafePointer<SettingsPanel>(panel)]() {
+        if (audioProcessor.isVgmCapturing()) {
+            if (!audioProcessor.stopVgmCapture())
+                juce::AlertWindow::showMessageBoxAsync(
+                    juce::AlertWindow::WarningIcon, "VGM Capture",
+                    "Could not finish writing the VGM file.");
+            if (safePanel != nullptr) safePanel->setVgmCapturing(false);
+            return;
+        }
+        
+        auto chooser = std::make_shared<juce::FileChooser>(
+            "Capture VGM", juce::File(), "*.vgm");
+        auto flags = juce::FileBrowserComponent::saveMode |
+                     juce::FileBrowserComponent::canSelectFiles |
+                     juce::FileBrowserComponent::warnAboutOverwriting;
+        chooser->launchAsync(flags, [this, chooser, safePanel](const juce::FileChooser& fc) {
+            auto file = fc.getResult();
+            if (file == juce::File()) return;
+            if (!file.hasFileExtension(".vgm"))
+                file = file.withFileExtension(".vgm");
+            const bool started = audioProcessor.startVgmCapture(file);
+            if (!started)
+                juce::AlertWindow::showMessageBoxAsync(
+                    juce::AlertWindow::WarningIcon, "VGM Capture",
+                    "Could not create " + file.getFileName());
+            if (safePanel != nullptr) safePanel->setVgmCapturing(started);
+        });
+    };
+    
+   #if ARM2612_TRACE
+    panel->setTracing(audioProcessor.isTracing());
+    panel->onTraceClicked = [this, safePanel = juce::Component::SafePointer<SettingsPanel>(panel)]() {
+        if (audioProcessor.isTracing()) {
+            if (!audioProcessor.stopTrace())
+                juce::AlertWindow::showMessageBoxAsync(
+                    juce::AlertWindow::WarningIcon, "Trace",
+                    "Could not finish writing the trace file.");
+            if (safePanel != nullptr) {
+                safePanel->setTracing(false);
+                safePanel->setTraceDropped(audioProcessor.getTraceDroppedEvents());
+            }
+            return;
+        }
+        
+        auto chooser = std::make_shared<juce::FileChooser>(
+            "Record trace (chrome://tracing, ui.perfetto.dev)", juce::File(), "*.json");
+        auto flags = juce::FileBrowserComponent::saveMode |
+                     juce::FileBrowserComponent::canSelectFiles |
+                     juce::FileBrowserComponent::warnAboutOverwriting;
+        chooser->launchAsync(flags, [this, chooser, safePanel](const juce::FileChooser& fc) {
+            auto file = fc.getResult();
+            if (file == juce::File()) return;
+            if (!file.hasFileExtension(".json"))
+                file = file.withFileExtension(".json");
+            juce::String error;
+            const bool started = audioProcessor.startTrace(file, error);
+            if (!started)
+                juce::AlertWindow::showMessageBoxAsync(
+                    juce::AlertWindow::WarningIcon, "Trace", error);
+            if (safePanel != nullptr) safePanel->setTracing(started);
+        });
+    };
+   #endif
+    
     auto* modal = new SettingsModal(panel, []() {});
     modal->setBounds(root->getLocalBounds());
     
-    const int pw = juce::jmin(350, (int)(root->getWidth() * 0.50f));
-    const int ph = juce::jmin(200, (int)(root->getHeight() * 0.40f));
+    const int pw = juce::jmin(360, (int)(root->getWidth() * 0.50f));
+    const int ph = juce::jmin(300 + DspLoadReadout::preferredHeight() + SettingsPanel::traceRowHeight(),
+                              (int)(root->getHeight() * 0.75f));
     
     panel->setBounds(
         (modal->getWidth() - pw) / 2,
@@ -290,6 +372,26 @@ void ARM2612AudioProcessorEditor::showSettings()
     modal->selfReference.reset(modal);
 }
 
+void ARM2612AudioProcessorEditor::importPatchFolders(const juce::Array<juce::File>& sources)
+{
+    // Parsing runs in the background; the editor may be gone when it finishes
+    auto done = [safeThis = juce::Component::SafePointer<ARM2612AudioProcessorEditor>(this)]
+                (int added, int bankFull, PatchBulkImporter::Totals totals, bool cancelled) {
+        juce::String msg;
+        msg << "Added " << added << " program" << (added == 1 ? "" : "s")
+            << " from " << totals.parsed << " instrument" << (totals.parsed == 1 ? "" : "s") << ".";
+        if (totals.failed > 0) msg << "\n" << totals.failed << " file(s) could not be read.";
+        if (bankFull > 0)      msg << "\n" << bankFull << " skipped: the program bank is full.";
+        if (cancelled)         msg << "\nImport was cancelled.";
+        if (safeThis != nullptr)
+            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon, "Bulk Import", msg);
+    };
+
+    if (!audioProcessor.importPatchFolders(sources, done))
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Bulk Import",
+                                               "An import is already running.");
+}
+
 void ARM2612AudioProcessorEditor::showPatches()
 {
     auto* root = getTopLevelComponent();
@@ -302,16 +404,21 @@ void ARM2612AudioProcessorEditor::showPatches()
     
     auto* panel = new PatchesPanel(currentPatch, currentBlock, currentLfoEnable, currentLfoFreq);
     
-    panel->onPatchSelected = [this](int patchIndex) {
-        DBG("Selected patch: " << kBuiltInPatches[patchIndex].name);
+    panel->onPatchSelected = [](int patchIndex) {
+        DBG("Selected patch row: " << patchIndex);
     };
     
     // Wire up patch loading callback
     panel->onPatchLoaded = [this](const YM2612Patch& patch, int block, int lfoEnable, int lfoFreq) {
         audioProcessor.loadPatch(patch, block, lfoEnable, lfoFreq);
+        audioProcessor.setInstrumentMacros({});   // library patches carry no macros
         DBG("Loaded patch into synth");
     };
     
+    panel->getCurrentPatch = [this](YM2612Patch& patch, int& block, int& lfoEnable, int& lfoFreq) {
+        audioProcessor.getCurrentPatch(patch, block, lfoEnable, lfoFreq);
+    };
+    
     auto* modal = new PatchesModal(panel, []() {});
     modal->setBounds(root->getLocalBounds());
     
@@ -48,6 +48,7 @@ public:
 
     void paint(juce::Graphics& g) override
     {
+        ARM2612_TRACE_SCOPE("envelope paint");
         auto bounds = getLocalBounds().toFloat().reduced(2.0f);
         float w = bounds.getWidth(), h = bounds.getHeight();
         float x0 = bounds.getX(), y0 = bounds.getY();
@@ -174,6 +175,7 @@ public:
     
     void showSettings();  // Show settings modal
     void showPatches();   // Show patches modal
+    void importPatchFolders(const juce::Array<juce::File>& sources);    // Bulk patch file import
     void updateTooltips(bool enabled);  // Enable/disable all tooltips
     
     // AudioProcessorValueTreeState::Listener
@@ -181,6 +183,9 @@ public:
 
 private:
     ARM2612AudioProcessor& audioProcessor;
+    
+    // Keeps the patch library (and a running rescan) alive while the editor is open
+    juce::SharedResourcePointer<PatchLibrary> patchLibrary;
 
     // ── Global settings panel ─────────────────────────────────────────────────
     struct LabeledControl {
@@ -238,6 +243,9 @@ private:
 
     void timerCallback() override
     {
+        ARM2612_TRACE_THREAD("message");
+        ARM2612_TRACE_SCOPE("editor timer");
+
         // Pull samples from audio FIFO and push to oscilloscope
         auto& fifo = audioProcessor.getAudioFifo();
         const auto* fifoBuffer = audioProcessor.getAudioFifoBuffer();
@@ -257,6 +265,13 @@ private:
             fifo.finishedRead(size1 + size2);
         }
         
+        audioProcessor.updateKeyboardDisplay();
+        
+        // Follow program changes (host or MIDI) in the name field
+        auto name = audioProcessor.getInstrumentName();
+        if (!instrumentNameLabel.isBeingEdited() && instrumentNameLabel.getText() != name)
+            instrumentNameLabel.setText(name, juce::dontSendNotification);
+
         // Update envelope displays
         for (auto& op : ops) op.envDisplay.repaint();
         midiKeyboard.repaint();
@@ -1,6 +1,7 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
-#include "FurnaceFormat.h"
+#include "PatchFile.h"
+#include "PatchSerializer.h"
 
 // ─────────────────────────────────────────────────────────────────────────────
 //  Parameter layout
@@ -106,26 +107,84 @@ ARM2612AudioProcessor::createParameterLayout()
     return { params.begin(), params.end() };
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  Buses: main stereo output + optional aux outputs for multi-out routing
+// ─────────────────────────────────────────────────────────────────────────────
+juce::AudioProcessor::BusesProperties ARM2612AudioProcessor::createBusesProperties()
+{
+    auto buses = BusesProperties().withOutput("Output", juce::AudioChannelSet::stereo(), true);
+    for (int i = 0; i < OutputRouting::kNumAuxBuses; ++i)
+        buses = buses.withOutput("Aux " + juce::String(i + 1), juce::AudioChannelSet::stereo(), false);
+    return buses;
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 ARM2612AudioProcessor::ARM2612AudioProcessor()
-    : AudioProcessor(BusesProperties()
-                         .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
+    : AudioProcessor(createBusesProperties()),
       apvts(*this, nullptr, "Parameters", createParameterLayout())
 {
+   #if ARM2612_TRACE
+    Tracer::get();   // allocate the event rings here, not on the audio thread
+   #endif
+
+    auto& pv = paramValues;
+    pv.algorithm = apvts.getRawParameterValue(GLOBAL_ALGORITHM);
+    pv.feedback  = apvts.getRawParameterValue(GLOBAL_FEEDBACK);
+    pv.ams       = apvts.getRawParameterValue(GLOBAL_AMS);
+    pv.fms       = apvts.getRawParameterValue(GLOBAL_FMS);
+    pv.octave    = apvts.getRawParameterValue(GLOBAL_OCTAVE);
+    pv.lfoEnable = apvts.getRawParameterValue(GLOBAL_LFO_ENABLE);
+    pv.lfoFreq   = apvts.getRawParameterValue(GLOBAL_LFO_FREQ);
+    for (int op = 0; op < 4; ++op) {
+        pv.op[op] = { apvts.getRawParameterValue(OP_DT_ID[op]),  apvts.getRawParameterValue(OP_MUL_ID[op]),
+                      apvts.getRawParameterValue(OP_TL_ID[op]),  apvts.getRawParameterValue(OP_RS_ID[op]),
+                      apvts.getRawParameterValue(OP_AR_ID[op]),  apvts.getRawParameterValue(OP_AM_ID[op]),
+                      apvts.getRawParameterValue(OP_DR_ID[op]),  apvts.getRawParameterValue(OP_SR_ID[op]),
+                      apvts.getRawParameterValue(OP_SL_ID[op]),  apvts.getRawParameterValue(OP_RR_ID[op]),
+                      apvts.getRawParameterValue(OP_SSG_MODE_ID[op]) };
+    }
+
     synth.addSound(new SynthSound());
     for (int i = 0; i < NUM_VOICES; ++i) {
         auto* v  = new Ym2612Voice();
+        v->setOutputRouting(&outputRouting, i);
+        v->setCapture(&vgmCapture, i);
         voices[i] = v;
         synth.addVoice(v);
     }
+    pushParamsToVoices();   // also seeds the tail length for the default patch
+    synth.capture = &vgmCapture;
+
+    synth.onProgramChange = [this](int, int program) {
+        pendingProgram.store(program);
+        applyPendingProgram();
+    };
 }
 
-ARM2612AudioProcessor::~ARM2612AudioProcessor() {}
+ARM2612AudioProcessor::~ARM2612AudioProcessor()
+{
+    cancelPendingUpdate();
+    vgmRecorder.stop();
+    traceRecorder.stop();
+    bulkImporter.cancel();
+}
 
 void ARM2612AudioProcessor::prepareToPlay(double sampleRate, int)
 {
+    updateOutputRouting();
     synth.setCurrentPlaybackSampleRate(sampleRate);
+    vgmCapture.setSampleRates(sampleRate, Ym2612Voice::CHIP_RATE);
+
+    // The linear resampler outputs the previous chip sample at t=0, i.e. it
+    // runs one chip period late. At the chip's native rate voices write chip
+    // samples straight through and there is no delay.
+    if (Ym2612Voice::isNativeRate(sampleRate))
+        setLatencySamples(0);
+    else
+        setLatencySamples(juce::roundToInt(sampleRate / Ym2612Voice::CHIP_RATE));
+
     midiKeyboardState.reset();
+    mergedMidi.ensureSize(4096);
     pushParamsToVoices();
 }
 
@@ -147,34 +206,37 @@ juce::String ARM2612AudioProcessor::getInstrumentName() const
 void ARM2612AudioProcessor::getCurrentPatch(YM2612Patch& outPatch, int& outBlock, int& outLfoEnable, int& outLfoFreq) const
 {
     // Read current parameter values into patch struct
-    outPatch.ALG = (int)apvts.getRawParameterValue(GLOBAL_ALGORITHM)->load();
-    outPatch.FB  = (int)apvts.getRawParameterValue(GLOBAL_FEEDBACK)->load();
-    outPatch.AMS = (int)apvts.getRawParameterValue(GLOBAL_AMS)->load();
-    outPatch.FMS = (int)apvts.getRawParameterValue(GLOBAL_FMS)->load();
+    const auto& pv = paramValues;
+    auto get = [](const std::atomic<float>* v) { return (int) v->load(); };
+
+    outPatch.ALG = get(pv.algorithm);
+    outPatch.FB  = get(pv.feedback);
+    outPatch.AMS = get(pv.ams);
+    outPatch.FMS = get(pv.fms);
     
     // Read operator parameters
     for (int op = 0; op < 4; ++op)
     {
-        outPatch.op[op].DT  = (int)apvts.getRawParameterValue(OP_DT_ID[op])->load();
-        outPatch.op[op].MUL = (int)apvts.getRawParameterValue(OP_MUL_ID[op])->load();
-        outPatch.op[op].TL  = (int)apvts.getRawParameterValue(OP_TL_ID[op])->load();
-        outPatch.op[op].RS  = (int)apvts.getRawParameterValue(OP_RS_ID[op])->load();
-        outPatch.op[op].AR  = (int)apvts.getRawParameterValue(OP_AR_ID[op])->load();
-        outPatch.op[op].AM  = (int)apvts.getRawParameterValue(OP_AM_ID[op])->load();
-        outPatch.op[op].DR  = (int)apvts.getRawParameterValue(OP_DR_ID[op])->load();
-        outPatch.op[op].SR  = (int)apvts.getRawParameterValue(OP_SR_ID[op])->load();
-        outPatch.op[op].SL  = (int)apvts.getRawParameterValue(OP_SL_ID[op])->load();
-        outPatch.op[op].RR  = (int)apvts.getRawParameterValue(OP_RR_ID[op])->load();
+        const auto& o = pv.op[op];
+        outPatch.op[op].DT  = get(o.dt);
+        outPatch.op[op].MUL = get(o.mul);
+        outPatch.op[op].TL  = get(o.tl);
+        outPatch.op[op].RS  = get(o.rs);
+        outPatch.op[op].AR  = get(o.ar);
+        outPatch.op[op].AM  = get(o.am);
+        outPatch.op[op].DR  = get(o.dr);
+        outPatch.op[op].SR  = get(o.sr);
+        outPatch.op[op].SL  = get(o.sl);
+        outPatch.op[op].RR  = get(o.rr);
         
         // Read SSG from mode choice (0-8): 0=disabled, 1-8=enabled with modes 0-7
-        int ssgModeChoice = (int)apvts.getRawParameterValue(OP_SSG_MODE_ID[op])->load();
-        outPatch.op[op].SSG = ssgModeChoice; // Direct mapping
+        outPatch.op[op].SSG = get(o.ssgMode); // Direct mapping
     }
     
     // Read global parameters
-    outBlock = (int)apvts.getRawParameterValue(GLOBAL_OCTAVE)->load();
-    outLfoEnable = (int)apvts.getRawParameterValue(GLOBAL_LFO_ENABLE)->load();
-    outLfoFreq = (int)apvts.getRawParameterValue(GLOBAL_LFO_FREQ)->load();
+    outBlock     = get(pv.octave);
+    outLfoEnable = get(pv.lfoEnable);
+    outLfoFreq   = get(pv.lfoFreq);
 }
 
 void ARM2612AudioProcessor::loadPatch(const YM2612Patch& patch, int block, int lfoEnable, int lfoFreq)
@@ -215,9 +277,114 @@ void ARM2612AudioProcessor::loadPatch(const YM2612Patch& patch, int block, int l
         apvts.getParameter(OP_SSG_EN_ID[op])->setValueNotifyingHost(ssgEn ? 1.0f : 0.0f);
         apvts.getParameter(OP_SSG_MODE_ID[op])->setValueNotifyingHost(ssgModeChoice / 8.0f);
     }
-    
-    // Push to voices
-    pushParamsToVoices();
+    // Voices pick the new values up on the next processBlock
+}
+
+void ARM2612AudioProcessor::setInstrumentMacros(const std::vector<uint8_t>& macros)
+{
+    if (macros == instrumentMacros) return;
+    storeInstrumentMacros(macros);
+    macroSerial.fetch_add(1);
+}
+
+// Records and compiles the macros without handing them to the voices
+void ARM2612AudioProcessor::storeInstrumentMacros(const std::vector<uint8_t>& macros)
+{
+    instrumentMacros = macros;
+    const juce::SpinLock::ScopedLockType sl(macroLock);
+    macroProgram->compile(macros.data(), macros.size());
+}
+
+// Audio thread: hand a newly compiled program to the voices. A plain copy
+// between two preallocated programs; if the message thread is compiling
+// right now, try again next block.
+void ARM2612AudioProcessor::applyMacroProgram()
+{
+    // The voices run a program change's own macros until it is synced
+    if (programToSync.load() >= 0) return;
+
+    const uint32_t serial = macroSerial.load();
+    if (serial == voiceMacroSerial) return;
+
+    const juce::SpinLock::ScopedTryLockType sl(macroLock);
+    if (!sl.isLocked()) return;
+
+    *voiceMacros     = *macroProgram;
+    voiceMacroSerial = serial;
+    for (auto* v : voices)
+        v->setMacroProgram(voiceMacros->empty() ? nullptr : voiceMacros.get());
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Programs
+// ─────────────────────────────────────────────────────────────────────────────
+void ARM2612AudioProcessor::setCurrentProgram(int index)
+{
+    ProgramBank::Program program;
+    if (!programBank.getProgram(index, program))
+        return;
+
+    currentProgram.store(index);
+    loadPatch(program.patch, program.block, program.lfoEnable, program.lfoFreq);
+    setInstrumentMacros(program.macros);
+    setInstrumentName(program.name);
+}
+
+int ARM2612AudioProcessor::addUserProgram(const juce::String& name, const YM2612Patch& patch,
+                                          int block, int lfoEnable, int lfoFreq,
+                                          const std::vector<uint8_t>& macros)
+{
+    const int index = programBank.addUserProgram(name, patch, block, lfoEnable, lfoFreq, macros);
+    if (index >= 0)
+        updateHostDisplay(ChangeDetails().withProgramChanged(true));
+    return index;
+}
+
+// Audio thread: swap the voices to the pending program's register image and
+// macros. If the bank is being edited right now, leave it pending for the
+// next block.
+void ARM2612AudioProcessor::applyPendingProgram()
+{
+    const int program = pendingProgram.load();
+    if (program < 0) return;
+
+    Ym2612Voice::RegisterImage image;
+    switch (programBank.tryGetProgram(program, image, *voiceMacros)) {
+        case ProgramBank::Fetch::busy:
+            return;
+        case ProgramBank::Fetch::invalid:
+            pendingProgram.store(-1);
+            return;
+        case ProgramBank::Fetch::ok:
+            break;
+    }
+
+    programToSync.store(program);
+    pendingProgram.store(-1);
+    currentProgram.store(program);
+    pushImageToVoices(image);
+    for (auto* v : voices)
+        v->setMacroProgram(voiceMacros->empty() ? nullptr : voiceMacros.get());
+    triggerAsyncUpdate();
+}
+
+// Message thread: mirror the program the audio thread already applied into
+// the APVTS so the editor, host and saved state follow it.
+void ARM2612AudioProcessor::handleAsyncUpdate()
+{
+    int program = programToSync.load();
+    if (program < 0) return;
+
+    ProgramBank::Program p;
+    if (programBank.getProgram(program, p)) {
+        loadPatch(p.patch, p.block, p.lfoEnable, p.lfoFreq);
+        storeInstrumentMacros(p.macros);   // the voices already have them
+        setInstrumentName(p.name);
+    }
+
+    // A newer program may have arrived meanwhile – it re-triggers this update
+    programToSync.compare_exchange_strong(program, -1);
+    updateHostDisplay(ChangeDetails().withProgramChanged(true));
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -225,74 +392,111 @@ bool ARM2612AudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) c
 {
     if (layouts.getMainInputChannelSet() != juce::AudioChannelSet::disabled()) return false;
     auto out = layouts.getMainOutputChannelSet();
-    return out == juce::AudioChannelSet::stereo() || out == juce::AudioChannelSet::mono();
+    if (out != juce::AudioChannelSet::stereo() && out != juce::AudioChannelSet::mono()) return false;
+
+    // Aux outputs: each one off, mono or stereo
+    for (int bus = 1; bus < layouts.outputBuses.size(); ++bus) {
+        auto aux = layouts.getChannelSet(false, bus);
+        if (!aux.isDisabled() && aux != juce::AudioChannelSet::stereo()
+                              && aux != juce::AudioChannelSet::mono())
+            return false;
+    }
+    return true;
 }
 #endif
 
+// Rebuild the bus → buffer channel table from the current layout
+void ARM2612AudioProcessor::updateOutputRouting()
+{
+    auto target = [this](int busIndex) {
+        OutputRouting::Target t;
+        auto* bus = getBus(false, busIndex);
+        if (bus != nullptr && bus->isEnabled()) {
+            t.firstChannel = getChannelIndexInProcessBlockBuffer(false, busIndex, 0);
+            t.numChannels  = bus->getNumberOfChannels();
+        }
+        return t;
+    };
+
+    outputRouting.main = target(0);
+    for (int i = 0; i < OutputRouting::kNumAuxBuses; ++i)
+        outputRouting.aux[size_t(i)] = target(i + 1);
+}
+
+void ARM2612AudioProcessor::setOutputRoutingMode(int mode)
+{
+    outputRouting.mode.store(juce::jlimit(int(OutputRouting::mainOnly),
+                                          int(OutputRouting::perMidiChannel), mode));
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  Push parameters to voices
 // ─────────────────────────────────────────────────────────────────────────────
 void ARM2612AudioProcessor::pushParamsToVoices()
 {
-    // Read global params
-    Ym2612Voice::GlobalParams gp;
-    gp.algorithm = static_cast<int>(apvts.getRawParameterValue(GLOBAL_ALGORITHM)->load());
-    gp.feedback  = static_cast<int>(apvts.getRawParameterValue(GLOBAL_FEEDBACK)->load());
-    
-    // LFO Freq dropdown: 0=Off, 1-8=chip values 0-7
-    int lfoFreqIdx = static_cast<int>(apvts.getRawParameterValue(GLOBAL_LFO_FREQ)->load());
-    gp.lfoEnable = (lfoFreqIdx > 0);
-    gp.lfoFreq   = (lfoFreqIdx > 0) ? (lfoFreqIdx - 1) : 0;
-    
-    gp.ams       = static_cast<int>(apvts.getRawParameterValue(GLOBAL_AMS)->load());
-    gp.fms       = static_cast<int>(apvts.getRawParameterValue(GLOBAL_FMS)->load());
-    gp.octave    = static_cast<int>(apvts.getRawParameterValue(GLOBAL_OCTAVE)->load());
+    // A program change applied on the audio thread owns the voices until the
+    // message thread has copied it into the APVTS (see handleAsyncUpdate)
+    if (programToSync.load() >= 0) return;
+
+    YM2612Patch patch;
+    int block, lfoEnable, lfoFreq;
+    getCurrentPatch(patch, block, lfoEnable, lfoFreq);
+    pushImageToVoices(compilePatch(patch, block, lfoFreq));
+}
 
-    // Read per-operator params
-    Ym2612Voice::OpParams ops[4];
-    for (int op = 0; op < 4; op++) {
-        // TL: Use directly from parameter (0=loud, 127=silent)
-        ops[op].tl  = static_cast<int>(apvts.getRawParameterValue(OP_TL_ID[op])->load());
-
-        ops[op].ar  = static_cast<int>(apvts.getRawParameterValue(OP_AR_ID[op])->load());
-        ops[op].dr  = static_cast<int>(apvts.getRawParameterValue(OP_DR_ID[op])->load());
-        ops[op].sr  = static_cast<int>(apvts.getRawParameterValue(OP_SR_ID[op])->load());
-        ops[op].sl  = static_cast<int>(apvts.getRawParameterValue(OP_SL_ID[op])->load());
-        ops[op].rr  = static_cast<int>(apvts.getRawParameterValue(OP_RR_ID[op])->load());
-        ops[op].mul = static_cast<int>(apvts.getRawParameterValue(OP_MUL_ID[op])->load());
-
-        int uiDT = static_cast<int>(apvts.getRawParameterValue(OP_DT_ID[op])->load());
-        // UI(-3..+3) → chip(0-7): chipValue = displayValue + 3
-        ops[op].dt = (uiDT + 3) & 7;
-
-        ops[op].rs  = static_cast<int>(apvts.getRawParameterValue(OP_RS_ID[op])->load());
-        ops[op].am  = apvts.getRawParameterValue(OP_AM_ID[op])->load() > 0.5f ? 1 : 0;
-        
-        // SSG Mode dropdown: 0=Off/disabled, 1-8=chip modes 0-7
-        int ssgIdx = static_cast<int>(apvts.getRawParameterValue(OP_SSG_MODE_ID[op])->load());
-        ops[op].ssgEnable = (ssgIdx > 0) ? 1 : 0;
-        ops[op].ssgMode   = (ssgIdx > 0) ? (ssgIdx - 1) : 0;
-    }
+void ARM2612AudioProcessor::pushImageToVoices(const Ym2612Voice::RegisterImage& image)
+{
+    for (auto* v : voices)
+        v->setRegisterImage(image);
 
-    // Push to all voices
-    for (int v = 0; v < NUM_VOICES; ++v) {
-        voices[v]->setGlobalParams(gp);
-        for (int op = 0; op < 4; op++)
-            voices[v]->setOpParams(op, ops[op]);
-    }
+    // Every voice now holds the same image, so its estimate is the patch's
+    tailSeconds.store(voices[0]->getTailSeconds());
 }
 
 void ARM2612AudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
                                                   juce::MidiBuffer& midi)
 {
     juce::ScopedNoDenormals noDenormals;
+    ARM2612_TRACE_THREAD("audio");
+    ARM2612_TRACE_SCOPE("processBlock");
+    ARM2612_PROFILE_BEGIN(blockStart);
     for (int i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    midiKeyboardState.processNextMidiBuffer(midi, 0, buffer.getNumSamples(), true);
-    pushParamsToVoices();
-    synth.renderNextBlock(buffer, midi, 0, buffer.getNumSamples());
+    // On-screen keyboard in, host notes out to its display – no locks
+    keyboardBridge.reportHostMidi(midi);
+    juce::MidiBuffer* blockMidi = &midi;
+    if (keyboardBridge.hasPendingNotes()) {
+        mergedMidi.clear();
+        mergedMidi.addEvents(midi, 0, -1, 0);
+        keyboardBridge.addPendingNotes(mergedMidi);
+        blockMidi = &mergedMidi;
+    }
+    vgmCapture.beginBlock(buffer.getNumSamples());
+
+    ARM2612_PROFILE_BEGIN(paramsStart);
+    {
+        ARM2612_TRACE_SCOPE("params");
+        applyPendingProgram();
+        pushParamsToVoices();
+        applyMacroProgram();
+    }
+    ARM2612_PROFILE_END(dspProfiler, params, paramsStart);
+
+    ARM2612_PROFILE_BEGIN(voicesStart);
+    {
+        ARM2612_TRACE_SCOPE("synth");
+        synth.renderNextBlock(buffer, *blockMidi, 0, buffer.getNumSamples());
+    }
+   #if ARM2612_PROFILE
+    // Voice time minus ymfm time = resampling, mixing and Synthesiser overhead
+    uint64_t chipTicks = 0;
+    for (auto* v : voices) chipTicks += v->takeChipTicks();
+    dspProfiler.add(DspProfiler::chip, chipTicks);
+    dspProfiler.add(DspProfiler::resample, DspProfiler::ticks() - voicesStart - chipTicks);
+   #endif
     
+    ARM2612_PROFILE_BEGIN(scopeStart);
     // Push samples to FIFO for oscilloscope
     if (buffer.getNumChannels() > 0)
     {
@@ -324,6 +528,12 @@ void ARM2612AudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
             audioFifo.finishedWrite(size1 + size2);
         }
     }
+    ARM2612_PROFILE_END(dspProfiler, scope, scopeStart);
+
+   #if ARM2612_PROFILE
+    dspProfiler.add(DspProfiler::total, DspProfiler::ticks() - blockStart);
+    dspProfiler.endBlock(buffer.getNumSamples(), getSampleRate());
+   #endif
 }
 
 juce::AudioProcessorEditor* ARM2612AudioProcessor::createEditor()
@@ -331,11 +541,44 @@ juce::AudioProcessorEditor* ARM2612AudioProcessor::createEditor()
     return new ARM2612AudioProcessorEditor(*this);
 }
 
+// Furnace macros travel in the state as base64 of their feature blocks
+static juce::String macrosToBase64(const std::vector<uint8_t>& macros)
+{
+    return macros.empty() ? juce::String() : juce::Base64::toBase64(macros.data(), macros.size());
+}
+
+static std::vector<uint8_t> macrosFromBase64(const juce::String& text)
+{
+    juce::MemoryOutputStream out;
+    if (text.isEmpty() || !juce::Base64::convertFromBase64(out, text)) return {};
+    const auto* bytes = static_cast<const uint8_t*>(out.getData());
+    return { bytes, bytes + out.getDataSize() };
+}
+
 void ARM2612AudioProcessor::getStateInformation(juce::MemoryBlock& dest)
 {
     auto state = apvts.copyState();
     // Add instrument name to state
     state.setProperty("instrumentName", instrumentName, nullptr);
+    state.setProperty("macros", macrosToBase64(instrumentMacros), nullptr);
+
+    state.setProperty("outputRouting", getOutputRoutingMode(), nullptr);
+
+    // Current program + user bank, each program stored as patch code
+    state.setProperty("program", currentProgram.load(), nullptr);
+    juce::ValueTree userBank("UserPrograms");
+    for (int i = programBank.getNumBuiltIns(); i < programBank.size(); ++i) {
+        ProgramBank::Program p;
+        if (!programBank.getProgram(i, p)) continue;
+        juce::ValueTree node("Program");
+        node.setProperty("name", p.name, nullptr);
+        node.setProperty("code", PatchSerializer::serializePatch(p.patch, "USER_PATCH",
+                                                                 p.block, p.lfoEnable, p.lfoFreq), nullptr);
+        if (!p.macros.empty())
+            node.setProperty("macros", macrosToBase64(p.macros), nullptr);
+        userBank.appendChild(node, nullptr);
+    }
+    state.appendChild(userBank, nullptr);
     std::unique_ptr<juce::XmlElement> xml(state.createXml());
     copyXmlToBinary(*xml, dest);
 }
@@ -345,9 +588,30 @@ void ARM2612AudioProcessor::setStateInformation(const void* data, int size)
     std::unique_ptr<juce::XmlElement> xml(getXmlFromBinary(data, size));
     if (xml && xml->hasTagName(apvts.state.getType())) {
         auto state = juce::ValueTree::fromXml(*xml);
+
+        // User bank lives beside the parameters, not inside the APVTS
+        auto userBank = state.getChildWithName("UserPrograms");
+        state.removeChild(userBank, nullptr);
+        programBank.clearUserPrograms();
+        for (const auto& node : userBank) {
+            YM2612Patch patch;
+            int block, lfoEnable, lfoFreq, errorLine, errorCol;
+            juce::String error;
+            if (PatchSerializer::parsePatch(node.getProperty("code").toString(), patch,
+                                            block, lfoEnable, lfoFreq, error, errorLine, errorCol))
+                programBank.addUserProgram(node.getProperty("name").toString(),
+                                           patch, block, lfoEnable, lfoFreq,
+                                           macrosFromBase64(node.getProperty("macros").toString()));
+        }
+
         apvts.replaceState(state);
         // Restore instrument name
         instrumentName = state.getProperty("instrumentName", "YM2612 Instrument").toString();
+        setInstrumentMacros(macrosFromBase64(state.getProperty("macros").toString()));
+        setOutputRoutingMode(state.getProperty("outputRouting", int(OutputRouting::mainOnly)));
+        currentProgram.store(juce::jlimit(0, programBank.size() - 1,
+                                          static_cast<int>(state.getProperty("program", 0))));
+        updateHostDisplay(ChangeDetails().withProgramChanged(true));
     }
 }
 
@@ -359,171 +623,69 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 // ─────────────────────────────────────────────────────────────────────────────
 
 // ─────────────────────────────────────────────────────────────────────────────
-//  Furnace .fui Import/Export
-//
-//  Furnace stores DT in chip format (0-7: 0-3 pos, 4-7 neg).
-//  We display DT as UI format (-3 to +3).
-//  Conversion:  chip→UI:  dt<4 → dt,  dt>=4 → -(dt-4)  (except 4→0 clash: 4→0neg)
-//               Actually Furnace: 0=no detune, 1-3=pos, 4=no(neg), 5-7=neg
-//               Our push: uiDT<0 → chip=4-uiDT,  uiDT>=0 → chip=uiDT
+//  Patch file Import/Export
 //
-//  Furnace ssgEnv: value 0-7 with bit3 set means "enabled" (i.e. values 8-15).
-//  But Furnace source also uses 8 to mean "disabled" in some contexts.
-//  The actual encoding in the FM feature block is:
-//    bit3 (0x08) = SSG-EG enable
-//    bits2:0     = mode 0-7
-//  So: disabled = 0x00,  enabled mode N = 0x08 | N
+//  Every format in PatchCodec.h (.fui, .opni, .dmp, .y12, .tfi) decodes to
+//  the same PatchData in UI units, so import is loadPatch() plus a user
+//  program. Format quirks – slot order, DT and SSG-EG encodings – live in
+//  the codec headers. Furnace macros ride along as raw feature blocks; only
+//  .fui writes them back out.
 // ─────────────────────────────────────────────────────────────────────────────
 
-bool ARM2612AudioProcessor::importFurnaceInstrument(const juce::File& file)
+bool ARM2612AudioProcessor::importInstrument(const juce::File& file)
 {
-    FurnaceFormat::Instrument ins;
-    if (!FurnaceFormat::readFui(file, ins))
+    PatchData data;
+    const auto* codec = PatchFile::read(file, data);
+    if (codec == nullptr)
         return false;
 
-    // Debug logging
-    DBG("=== IMPORT DEBUG ===");
-    DBG("File name: " << file.getFileName());
-    DBG("File name without extension: " << file.getFileNameWithoutExtension());
-    DBG("Instrument name from file: '" << ins.name << "'");
-    DBG("Instrument name is empty: " << (ins.name.isEmpty() ? "YES" : "NO"));
-    
-    // Set instrument name - prefer name from file, fallback to filename
-    juce::String nameToUse = ins.name.isEmpty() ? file.getFileNameWithoutExtension() : ins.name;
-    DBG("Name being set: '" << nameToUse << "'");
-    setInstrumentName(nameToUse);
-
-    auto set = [&](const juce::String& id, float rawValue) {
-        if (auto* p = apvts.getParameter(id))
-            p->setValueNotifyingHost(p->convertTo0to1(rawValue));
-    };
+    const auto name = PatchFile::displayName(data, file);
+    DBG("Imported " << codec->description << " '" << name << "' from " << file.getFileName());
 
-    // Global
-    set(GLOBAL_ALGORITHM, float(ins.alg & 7));
-    set(GLOBAL_FEEDBACK,  float(ins.fb  & 7));
-    set(GLOBAL_AMS,       float(ins.ams & 3));
-    set(GLOBAL_FMS,       float(ins.fms & 7));
-    
-    // LFO: Furnace has separate enable flag (bit in opCount byte, not saved in our format)
-    // For now, assume LFO is disabled on import. User can enable via dropdown.
-    set(GLOBAL_LFO_FREQ, 0.0f);  // index 0 = Off
-
-    // YM2612 operator slot mapping:
-    // Furnace stores in slot order: [0]=OP1, [1]=OP3, [2]=OP2, [3]=OP4
-    // Our UI displays in order: OP1, OP2, OP3, OP4
-    // So we need to remap: Furnace[0]→UI[0], Furnace[2]→UI[1], Furnace[1]→UI[2], Furnace[3]→UI[3]
-    const int slotMap[4] = { 0, 2, 1, 3 };  // Map UI op index to Furnace slot index
-
-    // Per-operator
-    for (int uiOp = 0; uiOp < 4; uiOp++) {
-        int furnaceSlot = slotMap[uiOp];
-        const auto& fop = ins.op[furnaceSlot];
-
-        // tl: Keep same as Furnace (0=loud, 127=silent) - no inversion
-        set(OP_TL_ID[uiOp],  float(fop.tl));
-        set(OP_AR_ID[uiOp],  float(fop.ar));
-        set(OP_DR_ID[uiOp],  float(fop.dr));
-        set(OP_SR_ID[uiOp],  float(fop.d2r));   // d2r = sustain rate
-        set(OP_SL_ID[uiOp],  float(fop.sl));
-        set(OP_RR_ID[uiOp],  float(fop.rr));
-        set(OP_MUL_ID[uiOp], float(fop.mult));
-        set(OP_RS_ID[uiOp],  float(fop.rs));
-
-        // dt chip(0-7) → UI(-3..+3)
-        // Furnace displays detune as: displayValue = chipValue - 3
-        // So: chip 0→display -3, chip 3→display 0, chip 5→display +2, chip 7→display +4 (capped at +3)
-        int chipDT = int(fop.dt) & 7;
-        int uiDT = chipDT - 3;
-        if (uiDT > 3) uiDT = 3;   // Clamp to valid range
-        if (uiDT < -3) uiDT = -3;
-        set(OP_DT_ID[uiOp], float(uiDT));
-
-        set(OP_AM_ID[uiOp], fop.am != 0 ? 1.0f : 0.0f);
-        
-        // SSG-EG: Furnace ssgEnv bit3=enable, bits2:0=mode
-        // Map to dropdown: 0=Off, 1-8=modes 0-7
-        bool ssgEn   = (fop.ssgEnv & 0x08) != 0;
-        int ssgMode  = fop.ssgEnv & 0x07;
-        int dropdownIdx = ssgEn ? (ssgMode + 1) : 0;
-        set(OP_SSG_MODE_ID[uiOp], float(dropdownIdx));
-    }
+    setInstrumentName(name);
+    loadPatch(data.patch, data.block, data.lfoEnable, data.lfoFreq);
+    setInstrumentMacros(data.macros);
 
-    pushParamsToVoices();
+    // Make the imported instrument reachable as a host/MIDI program too
+    const int program = addUserProgram(name, data.patch, data.block, data.lfoEnable, data.lfoFreq, data.macros);
+    if (program >= 0)
+        currentProgram.store(program);
     return true;
 }
 
-bool ARM2612AudioProcessor::exportFurnaceInstrument(
-    const juce::File& file, const juce::String& patchName)
+bool ARM2612AudioProcessor::importPatchFolders(const juce::Array<juce::File>& sources,
+                                               BulkImportDone onDone)
 {
-    auto gi = [&](const juce::String& id) {
-        return static_cast<int>(apvts.getRawParameterValue(id)->load());
+    if (bulkImporter.isRunning()) return false;
+
+    auto added    = std::make_shared<int>(0);
+    auto bankFull = std::make_shared<int>(0);
+
+    bulkImporter.onPatches = [this, added, bankFull](std::vector<ImportedPatch>&& patches) {
+        for (const auto& p : patches) {
+            if (programBank.addUserProgram(p.name, p.patch, p.block, p.lfoEnable, p.lfoFreq, p.macros) >= 0) ++*added;
+            else                                                                                               ++*bankFull;
+        }
+        updateHostDisplay(ChangeDetails().withProgramChanged(true));
     };
+    bulkImporter.onFinished = [added, bankFull, onDone](PatchBulkImporter::Totals totals, bool cancelled) {
+        if (onDone) onDone(*added, *bankFull, totals, cancelled);
+    };
+    return bulkImporter.start(sources);
+}
+
+bool ARM2612AudioProcessor::exportInstrument(const juce::File& file, const juce::String& patchName)
+{
+    PatchData data;
+    getCurrentPatch(data.patch, data.block, data.lfoEnable, data.lfoFreq);
+    data.macros = instrumentMacros;   // written by .fui, dropped by the other formats
 
-    FurnaceFormat::Instrument ins;
     // Use stored instrument name, fallback to provided name, fallback to filename
-    ins.name = instrumentName.isEmpty() ? 
+    const juce::String nameToWrite = instrumentName.isEmpty() ?
                (patchName.isEmpty() ? file.getFileNameWithoutExtension() : patchName) :
                instrumentName;
-    
-    // Debug logging
-    DBG("=== EXPORT DEBUG ===");
-    DBG("File name: " << file.getFileName());
-    DBG("File name without extension: " << file.getFileNameWithoutExtension());
-    DBG("instrumentName member: '" << instrumentName << "'");
-    DBG("patchName parameter: '" << patchName << "'");
-    DBG("Name being written to file: '" << ins.name << "'");
-    
-    ins.alg        = uint8_t(gi(GLOBAL_ALGORITHM) & 7);
-    ins.fb         = uint8_t(gi(GLOBAL_FEEDBACK)  & 7);
-    ins.fms        = uint8_t(gi(GLOBAL_FMS)       & 7);
-    ins.ams        = uint8_t(gi(GLOBAL_AMS)       & 3);
-    ins.fms2       = 0;
-    ins.ams2       = 0;
-    ins.ops        = 4;
-    ins.opllPreset = 0;
-    ins.block      = 0;
-
-    // YM2612 operator slot mapping (reverse of import):
-    // Our UI order: OP1, OP2, OP3, OP4 (indices 0, 1, 2, 3)
-    // Furnace slot order: OP1, OP3, OP2, OP4 (slots 0, 1, 2, 3)
-    // So we need to write: UI[0]→Furnace[0], UI[1]→Furnace[2], UI[2]→Furnace[1], UI[3]→Furnace[3]
-    const int slotMap[4] = { 0, 2, 1, 3 };  // Map UI op index to Furnace slot index
-
-    for (int uiOp = 0; uiOp < 4; uiOp++) {
-        int furnaceSlot = slotMap[uiOp];
-        FurnaceFormat::Op& fop = ins.op[furnaceSlot];
-        fop.enable = true;
-
-        // tl: Write directly as stored in parameter (0=loud, 127=silent)
-        fop.tl   = uint8_t(gi(OP_TL_ID[uiOp]));
-
-        fop.ar   = uint8_t(gi(OP_AR_ID[uiOp]));
-        fop.dr   = uint8_t(gi(OP_DR_ID[uiOp]));
-        fop.d2r  = uint8_t(gi(OP_SR_ID[uiOp]));   // sustain rate
-        fop.sl   = uint8_t(gi(OP_SL_ID[uiOp]));
-        fop.rr   = uint8_t(gi(OP_RR_ID[uiOp]));
-        fop.mult = uint8_t(gi(OP_MUL_ID[uiOp]));
-        fop.rs   = uint8_t(gi(OP_RS_ID[uiOp]));
-        fop.am   = uint8_t(gi(OP_AM_ID[uiOp]));
-
-        // dt: UI(-3..+3) → chip(0-7)
-        // Furnace: chipValue = displayValue + 3
-        int uiDT = gi(OP_DT_ID[uiOp]);
-        fop.dt = uint8_t((uiDT + 3) & 7);  // Clamp to 0-7
-
-        // SSG-EG: dropdown index 0=Off, 1-8=modes 0-7 → Furnace ssgEnv
-        int dropdownIdx = gi(OP_SSG_MODE_ID[uiOp]);
-        if (dropdownIdx == 0) {
-            fop.ssgEnv = 0x00;  // disabled
-        } else {
-            int mode = dropdownIdx - 1;  // 1→0, 2→1, ..., 8→7
-            fop.ssgEnv = uint8_t(0x08 | (mode & 0x07));  // enabled with mode
-        }
-
-        fop.kvs = 2;
-        fop.dam = fop.dvb = fop.egt = fop.ksl = 0;
-        fop.sus = fop.vib = fop.ws  = fop.ksr = fop.dt2 = 0;
-    }
+    data.name = nameToWrite.toStdString();
 
-    return FurnaceFormat::writeFui(file, ins);
+    DBG("Exporting '" << nameToWrite << "' to " << file.getFileName());
+    return PatchFile::write(file, data);
 }
@@ -4,7 +4,14 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include "Ym2612Voice.h"
 #include "SynthSound.h"
+#include "Ym2612Synth.h"
 #include "BuiltInPatches.h"
+#include "ProgramBank.h"
+#include "OutputRouting.h"
+#include "VgmRecorder.h"
+#include "TraceRecorder.h"
+#include "PatchBulkImporter.h"
+#include "KeyboardBridge.h"
 
 static constexpr int NUM_VOICES = 6;
 
@@ -68,7 +75,8 @@ inline juce::StringArray getSsgModeNames()
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-class ARM2612AudioProcessor : public juce::AudioProcessor
+class ARM2612AudioProcessor : public juce::AudioProcessor,
+                              private juce::AsyncUpdater
 {
 public:
     ARM2612AudioProcessor();
@@ -90,23 +98,34 @@ public:
     bool   acceptsMidi()  const override { return true;  }
     bool   producesMidi() const override { return false; }
     bool   isMidiEffect() const override { return false; }
-    double getTailLengthSeconds() const override { return 0.5; }
+    double getTailLengthSeconds() const override { return tailSeconds.load(); }
 
-    int  getNumPrograms()    override { return 1; }
-    int  getCurrentProgram() override { return 0; }
-    void setCurrentProgram(int) override {}
-    const juce::String getProgramName(int) override { return {}; }
+    // Programs = built-in patches followed by the user bank (see ProgramBank)
+    int  getNumPrograms()    override { return programBank.size(); }
+    int  getCurrentProgram() override { return currentProgram.load(); }
+    void setCurrentProgram(int index) override;
+    const juce::String getProgramName(int index) override { return programBank.getName(index); }
     void changeProgramName(int, const juce::String&) override {}
 
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
-    // Furnace .fui file import/export
-    bool importFurnaceInstrument(const juce::File& file);
-    bool exportFurnaceInstrument(const juce::File& file, const juce::String& name);
+    // Patch file import/export in any PatchCodec.h format (.fui, .opni,
+    // .dmp, .y12, .tfi). Export picks the format from the file extension.
+    bool importInstrument(const juce::File& file);
+    bool exportInstrument(const juce::File& file, const juce::String& name);
+
+    // Bulk patch file import into the user programs, parsed on a background
+    // thread. onDone runs on the message thread: programs added, patches that
+    // did not fit in the bank, and the parser totals.
+    using BulkImportDone = std::function<void(int added, int bankFull, PatchBulkImporter::Totals, bool cancelled)>;
+    bool importPatchFolders(const juce::Array<juce::File>& sources, BulkImportDone onDone);
+    void cancelBulkImport() { bulkImporter.cancel(); }
 
     juce::AudioProcessorValueTreeState apvts;
     juce::MidiKeyboardState& getMidiKeyboardState() { return midiKeyboardState; }
+    // Editor timer: shows host notes on the on-screen keyboard
+    void updateKeyboardDisplay() { keyboardBridge.updateDisplay(); }
     
     // Instrument name (not automated, stored in state)
     void setInstrumentName(const juce::String& name);
@@ -115,6 +134,35 @@ public:
     // Patch loading/retrieval
     void getCurrentPatch(YM2612Patch& outPatch, int& outBlock, int& outLfoEnable, int& outLfoFreq) const;
     void loadPatch(const YM2612Patch& patch, int block, int lfoEnable, int lfoFreq);
+
+    // Furnace macros of the current instrument as raw feature blocks (see
+    // MacroProgram.h); empty = none. Not automated, stored in state.
+    void setInstrumentMacros(const std::vector<uint8_t>& macros);
+    const std::vector<uint8_t>& getInstrumentMacros() const { return instrumentMacros; }
+
+    // Multi-out: OutputRouting::Mode, takes effect from the next note
+    void setOutputRoutingMode(int mode);
+    int  getOutputRoutingMode() const { return outputRouting.mode.load(); }
+
+    // VGM capture: everything the voices write to the chip, logged to a file
+    // on a background thread. Voice n plays on hardware channel n.
+    bool startVgmCapture(const juce::File& file) { return vgmRecorder.start(file); }
+    bool stopVgmCapture()                        { return vgmRecorder.stop(); }
+    bool isVgmCapturing() const                  { return vgmRecorder.isRecording(); }
+
+    // Per-stage processBlock timing (all zero unless built with ARM2612_PROFILE)
+    DspProfiler& getDspProfiler() { return dspProfiler; }
+
+    // Audio + message thread timeline as a Chrome trace (ARM2612_TRACE builds)
+    bool startTrace(const juce::File& file, juce::String& error) { return traceRecorder.start(file, error); }
+    bool stopTrace()                                             { return traceRecorder.stop(); }
+    bool isTracing() const                                       { return traceRecorder.isRecording(); }
+    uint64_t getTraceDroppedEvents() const                       { return traceRecorder.droppedEvents(); }
+
+    // Appends a patch to the user bank; returns its program index or -1 if full
+    int addUserProgram(const juce::String& name, const YM2612Patch& patch,
+                       int block, int lfoEnable, int lfoFreq,
+                       const std::vector<uint8_t>& macros = {});
     
     // Oscilloscope support - FIFO for audio samples
     juce::AbstractFifo& getAudioFifo() { return audioFifo; }
@@ -124,16 +172,73 @@ public:
 private:
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    juce::Synthesiser synth;
+    Ym2612Synth synth;
     juce::MidiKeyboardState midiKeyboardState;
+    KeyboardBridge keyboardBridge { midiKeyboardState };
+    juce::MidiBuffer mergedMidi;   // host + on-screen keyboard, preallocated
     std::array<Ym2612Voice*, NUM_VOICES> voices {};
+    OutputRouting outputRouting;
     juce::String instrumentName { "ARM2612 Patch" };
     
+    DspProfiler dspProfiler;
+    VgmCapture  vgmCapture;
+    VgmRecorder vgmRecorder { vgmCapture, Ym2612Voice::YM_CLOCK };
+    TraceRecorder traceRecorder;
+    PatchBulkImporter bulkImporter;
+
     // Audio FIFO for oscilloscope
     juce::AbstractFifo audioFifo { 8192 };
     std::array<float, 8192> audioFifoBuffer {};
 
+    // Programs: a MIDI Program Change is applied to the voices on the audio
+    // thread straight from the precompiled bank, then mirrored into the APVTS
+    // on the message thread. While programToSync >= 0 the voices keep the
+    // program's image instead of re-reading the (not yet updated) parameters.
+    ProgramBank       programBank;
+    std::atomic<int>  currentProgram { 0 };
+    std::atomic<int>  pendingProgram { -1 };   // received, not yet applied
+    std::atomic<int>  programToSync  { -1 };   // applied, APVTS not yet updated
+
+    static BusesProperties createBusesProperties();
+    void updateOutputRouting();
+
+    void applyPendingProgram();
+    void handleAsyncUpdate() override;
+
+    // Macros: compiled on the message thread into macroProgram, then copied
+    // by the audio thread into voiceMacros – the one the voices read – when
+    // macroSerial moves. A program change copies the bank's precompiled
+    // macros into voiceMacros directly. Both programs are allocated once, here.
+    std::vector<uint8_t>          instrumentMacros;
+    std::unique_ptr<MacroProgram> macroProgram { std::make_unique<MacroProgram>() };
+    std::unique_ptr<MacroProgram> voiceMacros  { std::make_unique<MacroProgram>() };
+    juce::SpinLock                macroLock;
+    std::atomic<uint32_t>         macroSerial { 0 };
+    uint32_t                      voiceMacroSerial = 0;   // audio thread
+
+    void applyMacroProgram();
+    void storeInstrumentMacros(const std::vector<uint8_t>& macros);
+
+    // Release tail of the current patch, recomputed whenever the patch changes
+    std::atomic<double> tailSeconds { 0.5 };
+
+    // Raw parameter values, looked up once so the audio thread never searches
+    // the APVTS by ID string
+    struct ParamValues {
+        std::atomic<float>* algorithm = nullptr;
+        std::atomic<float>* feedback  = nullptr;
+        std::atomic<float>* ams       = nullptr;
+        std::atomic<float>* fms       = nullptr;
+        std::atomic<float>* octave    = nullptr;
+        std::atomic<float>* lfoEnable = nullptr;
+        std::atomic<float>* lfoFreq   = nullptr;
+        struct Op {
+            std::atomic<float> *dt, *mul, *tl, *rs, *ar, *am, *dr, *sr, *sl, *rr, *ssgMode;
+        } op[4] {};
+    } paramValues;
+
     void pushParamsToVoices();
+    void pushImageToVoices(const Ym2612Voice::RegisterImage& image);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ARM2612AudioProcessor)
 };
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "BuiltInPatches.h"
+#include "MacroProgram.h"
+#include "PatchCompiler.h"
+#include "Ym2612Voice.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ProgramBank  –  host/MIDI programs backed by precompiled register images
+//
+// Slots [0, kNumBuiltInPatches) hold kBuiltInPatches; user programs are
+// appended after them. Every slot lives in a fixed array that is allocated
+// once, so the audio thread can fetch an image on Program Change with a
+// non-blocking try-lock and a struct copy. If the message thread happens to
+// be editing the bank at that moment, the audio thread simply retries on
+// the next block. A program's Furnace macros (raw feature blocks, see
+// MacroProgram.h) are compiled when it is stored, into a MacroProgram the
+// slot keeps from then on, so Program Change swaps them in with the image.
+// ─────────────────────────────────────────────────────────────────────────────
+class ProgramBank
+{
+public:
+    static constexpr int kMaxPrograms = 128;   // MIDI Program Change range
+
+    struct Program {
+        juce::String               name;
+        YM2612Patch                patch {};
+        int                        block     = 0;
+        int                        lfoEnable = 0;
+        int                        lfoFreq   = 0;
+        std::vector<uint8_t>       macros;
+        Ym2612Voice::RegisterImage image;
+    };
+
+    ProgramBank()
+    {
+        for (int i = 0; i < kNumBuiltInPatches; ++i) {
+            const auto& e = kBuiltInPatches[i];
+            store(i, e.name, *e.patch, e.block, e.lfoEnable, e.lfoFreq, {});
+        }
+        numPrograms.store(kNumBuiltInPatches);
+    }
+
+    int size() const                 { return numPrograms.load(); }
+    int getNumBuiltIns() const       { return kNumBuiltInPatches; }
+    bool isUserProgram(int i) const  { return i >= kNumBuiltInPatches && i < size(); }
+
+    // ── Message thread ────────────────────────────────────────────────────────
+    bool getProgram(int index, Program& out) const
+    {
+        const juce::SpinLock::ScopedLockType sl(lock);
+        if (index < 0 || index >= numPrograms.load()) return false;
+        out = programs[size_t(index)];
+        return true;
+    }
+
+    juce::String getName(int index) const
+    {
+        const juce::SpinLock::ScopedLockType sl(lock);
+        if (index < 0 || index >= numPrograms.load()) return {};
+        return programs[size_t(index)].name;
+    }
+
+    // Appends a user program; returns its index, or -1 if the bank is full.
+    // An identical program (same name, register image and macros) is not
+    // duplicated.
+    int addUserProgram(const juce::String& name, const YM2612Patch& patch,
+                       int block, int lfoEnable, int lfoFreq,
+                       const std::vector<uint8_t>& macros = {})
+    {
+        const juce::SpinLock::ScopedLockType sl(lock);
+        const int n = numPrograms.load();
+        const auto image = compilePatch(patch, block, lfoFreq);
+
+        for (int i = kNumBuiltInPatches; i < n; ++i)
+            if (programs[size_t(i)].name == name && programs[size_t(i)].image == image
+                && programs[size_t(i)].macros == macros)
+                return i;
+
+        if (n >= kMaxPrograms) return -1;
+        store(n, name, patch, block, lfoEnable, lfoFreq, macros);
+        numPrograms.store(n + 1);
+        return n;
+    }
+
+    void clearUserPrograms()
+    {
+        const juce::SpinLock::ScopedLockType sl(lock);
+        numPrograms.store(kNumBuiltInPatches);
+    }
+
+    // ── Audio thread ──────────────────────────────────────────────────────────
+    enum class Fetch { ok, busy, invalid };
+
+    // Copies the program's image and compiled macros (cleared when it has
+    // none) – plain copies into storage the caller owns
+    Fetch tryGetProgram(int index, Ym2612Voice::RegisterImage& image, MacroProgram& macros) const
+    {
+        const juce::SpinLock::ScopedTryLockType sl(lock);
+        if (!sl.isLocked()) return Fetch::busy;
+        if (index < 0 || index >= numPrograms.load()) return Fetch::invalid;
+        image = programs[size_t(index)].image;
+        if (programs[size_t(index)].macros.empty())
+            macros.clear();
+        else
+            macros = *compiledMacros[size_t(index)];
+        return Fetch::ok;
+    }
+
+private:
+    // Message thread, under the lock (or before the bank is shared)
+    void store(int index, const juce::String& name, const YM2612Patch& patch,
+               int block, int lfoEnable, int lfoFreq, const std::vector<uint8_t>& macros)
+    {
+        auto& p = programs[size_t(index)];
+        p.name      = name;
+        p.patch     = patch;
+        p.block     = block;
+        p.lfoEnable = lfoEnable;
+        p.lfoFreq   = lfoFreq;
+        p.macros    = macros;
+        p.image     = compilePatch(patch, block, lfoFreq);
+
+        if (!macros.empty()) {
+            auto& compiled = compiledMacros[size_t(index)];
+            if (compiled == nullptr) compiled = std::make_unique<MacroProgram>();
+            compiled->compile(macros.data(), macros.size());
+        }
+    }
+
+    std::array<Program, kMaxPrograms> programs;
+    std::array<std::unique_ptr<MacroProgram>, kMaxPrograms> compiledMacros;   // allocated per slot on first use
+    std::atomic<int>                  numPrograms { 0 };
+    mutable juce::SpinLock            lock;
+
+    JUCE_DECLARE_NON_COPYABLE(ProgramBank)
+};
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <juce_gui_basics/juce_gui_basics.h>
+#include "DspLoadReadout.h"
+#include "Tracer.h"
 
 // =============================================================================
 // SettingsPanel - Panel for plugin settings
@@ -10,8 +12,13 @@ class SettingsPanel : public juce::Component
 public:
     std::function<void()> onClose;
     std::function<void(bool)> onTooltipsChanged;
+    std::function<void(int)> onOutputRoutingChanged;
+    std::function<void()> onVgmCaptureClicked;
+    std::function<void()> onTraceClicked;
     
-    SettingsPanel(bool tooltipsEnabled)
+    SettingsPanel(bool tooltipsEnabled, int outputRoutingMode, bool vgmCapturing,
+                  DspProfiler& profiler)
+        : dspLoad(profiler)
     {
         setInterceptsMouseClicks(true, true);
         
@@ -24,6 +31,54 @@ public:
         };
         addAndMakeVisible(tooltipsToggle);
         
+        // Multi-out routing (item IDs = OutputRouting::Mode + 1)
+        routingLabel.setText("Multi-out", juce::dontSendNotification);
+        routingLabel.setColour(juce::Label::textColourId, juce::Colour(0xFF888888));
+        addAndMakeVisible(routingLabel);
+        
+        routingBox.addItem("Main output only", 1);
+        routingBox.addItem("One bus per voice", 2);
+        routingBox.addItem("One bus per MIDI channel", 3);
+        routingBox.setSelectedId(outputRoutingMode + 1, juce::dontSendNotification);
+        routingBox.onChange = [this]() {
+            if (onOutputRoutingChanged)
+                onOutputRoutingChanged(routingBox.getSelectedId() - 1);
+        };
+        addAndMakeVisible(routingBox);
+        
+        // VGM capture (start asks for a file, stop finishes it)
+        vgmLabel.setText("VGM", juce::dontSendNotification);
+        vgmLabel.setColour(juce::Label::textColourId, juce::Colour(0xFF888888));
+        addAndMakeVisible(vgmLabel);
+        
+        setVgmCapturing(vgmCapturing);
+        vgmButton.onClick = [this]() {
+            if (onVgmCaptureClicked)
+                onVgmCaptureClicked();
+        };
+        addAndMakeVisible(vgmButton);
+        
+       #if ARM2612_TRACE
+        // Timeline trace (tracing builds only)
+        traceLabel.setText("Trace", juce::dontSendNotification);
+        traceLabel.setColour(juce::Label::textColourId, juce::Colour(0xFF888888));
+        addAndMakeVisible(traceLabel);
+        
+        setTracing(false);
+        traceButton.onClick = [this]() {
+            if (onTraceClicked)
+                onTraceClicked();
+        };
+        addAndMakeVisible(traceButton);
+        
+        traceStatus.setColour(juce::Label::textColourId, juce::Colour(0xFF888888));
+        traceStatus.setFont(juce::Font(11.f));
+        addAndMakeVisible(traceStatus);
+       #endif
+        
+        // Live DSP load (per-stage timing, profiling builds only)
+        addAndMakeVisible(dspLoad);
+        
         // Close button
         closeButton.setButtonText("Close");
         closeButton.onClick = [this]() {
@@ -33,6 +88,34 @@ public:
         addAndMakeVisible(closeButton);
     }
 
+    void setVgmCapturing(bool capturing)
+    {
+        vgmButton.setButtonText(capturing ? "Stop capture" : "Capture to .vgm...");
+        vgmButton.setColour(juce::TextButton::buttonColourId,
+                            capturing ? juce::Colour(0xFF8B1E2E) : getLookAndFeel().findColour(juce::TextButton::buttonColourId));
+    }
+
+    void setTracing(bool tracing)
+    {
+        traceButton.setButtonText(tracing ? "Stop trace" : "Record trace to .json...");
+        traceButton.setColour(juce::TextButton::buttonColourId,
+                              tracing ? juce::Colour(0xFF8B1E2E) : getLookAndFeel().findColour(juce::TextButton::buttonColourId));
+    }
+
+    // Result of the last finished trace
+    void setTraceDropped(uint64_t dropped)
+    {
+        traceStatus.setText(dropped == 0 ? "Last trace: no events dropped"
+                                         : "Last trace: " + juce::String((juce::int64) dropped)
+                                               + " events dropped (rings full or too many threads)",
+                            juce::dontSendNotification);
+        traceStatus.setColour(juce::Label::textColourId,
+                              dropped == 0 ? juce::Colour(0xFF888888) : juce::Colour(0xFFE0A040));
+    }
+
+    // Extra panel height taken by the trace row and its status line
+    static constexpr int traceRowHeight() { return ARM2612_TRACE ? 52 : 0; }
+
     void paint(juce::Graphics& g) override
     {
         // Panel background
@@ -60,6 +143,34 @@ public:
         // Tooltips toggle
         tooltipsToggle.setBounds(bounds.removeFromTop(30));
         
+        bounds.removeFromTop(8); // Spacing
+        
+        // Multi-out routing
+        auto routingRow = bounds.removeFromTop(26);
+        routingLabel.setBounds(routingRow.removeFromLeft(80));
+        routingBox.setBounds(routingRow);
+        
+        bounds.removeFromTop(8); // Spacing
+        
+        // VGM capture
+        auto vgmRow = bounds.removeFromTop(26);
+        vgmLabel.setBounds(vgmRow.removeFromLeft(80));
+        vgmButton.setBounds(vgmRow);
+        
+       #if ARM2612_TRACE
+        bounds.removeFromTop(8); // Spacing
+        
+        auto traceRow = bounds.removeFromTop(26);
+        traceLabel.setBounds(traceRow.removeFromLeft(80));
+        traceButton.setBounds(traceRow);
+        traceStatus.setBounds(bounds.removeFromTop(18).withTrimmedLeft(80));
+       #endif
+        
+        bounds.removeFromTop(12); // Spacing
+        
+        // DSP load readout
+        dspLoad.setBounds(bounds.removeFromTop(DspLoadReadout::preferredHeight()));
+        
         bounds.removeFromTop(16); // Spacing before button
         
         // Close button at bottom
@@ -69,6 +180,14 @@ public:
 
 private:
     juce::ToggleButton tooltipsToggle;
+    juce::Label routingLabel;
+    juce::ComboBox routingBox;
+    juce::Label vgmLabel;
+    juce::TextButton vgmButton;
+    juce::Label traceLabel;
+    juce::TextButton traceButton;
+    juce::Label traceStatus;
+    DspLoadReadout dspLoad;
     juce::TextButton closeButton;
 };
 
@@ -0,0 +1,86 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// TraceRecorder.h  –  background thread that drains Tracer into a JSON trace
+//
+// Only does anything in ARM2612_TRACE builds. While running, the audio and
+// message threads record into their own rings and this thread writes them
+// out every 20 ms, so a capture can run as long as needed.
+//
+// The rings are process-wide with a single consumer, so only one recorder –
+// of any plugin instance – runs at a time; start() fails while another does.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <juce_core/juce_core.h>
+#include "Tracer.h"
+#include "TraceWriter.h"
+
+class TraceRecorder : private juce::Thread
+{
+public:
+    TraceRecorder() : juce::Thread("Trace writer") {}
+    ~TraceRecorder() override { stop(); }
+
+    // Message thread. Opens the file and starts recording events.
+    bool start(const juce::File& file, juce::String& error)
+    {
+        stop();
+
+        if (!Tracer::get().claimWriter()) {
+            error = "Another ARM2612 instance is already recording a trace.";
+            return false;
+        }
+        std::string openError;
+        if (!writer.open(file.getFullPathName().toStdString(), openError)) {
+            Tracer::get().releaseWriter();
+            error = "Could not create " + file.getFileName();
+            DBG("Trace: " << openError);
+            return false;
+        }
+        if (!startThread(juce::Thread::Priority::low)) {
+            Tracer::get().releaseWriter();
+            error = "Could not start the trace writer thread.";
+            return false;
+        }
+        return true;
+    }
+
+    // Message thread. Finishes and closes the file; returns false on I/O error.
+    bool stop()
+    {
+        if (!isThreadRunning()) return true;
+        stopThread(2000);
+        Tracer::get().releaseWriter();
+        return lastResult;
+    }
+
+    bool isRecording() const { return isThreadRunning(); }
+
+    // Events lost by the last finished recording: rings full, or more live
+    // threads than the tracer has slots
+    uint64_t droppedEvents() const { return lastDropped; }
+
+private:
+    void run() override
+    {
+        auto& tracer = Tracer::get();
+        ARM2612_TRACE_THREAD("trace writer");
+
+        tracer.start();
+        while (!threadShouldExit()) {
+            writer.drain(tracer);
+            wait(20);
+        }
+        tracer.stop();
+        writer.drain(tracer);
+
+        lastDropped = tracer.droppedEvents();
+        lastResult  = writer.finish(tracer);
+    }
+
+    TraceWriter writer;
+    bool        lastResult  = true;
+    uint64_t    lastDropped = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(TraceRecorder)
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// VgmRecorder.h  –  background thread that drains VgmCapture into a .vgm
+//
+// The audio thread only pushes into the capture's ring; all file I/O
+// happens here. The ring is drained every few milliseconds, so at 64k
+// entries it rides out long stalls of this thread without dropping writes.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <juce_core/juce_core.h>
+#include "VgmCapture.h"
+#include "VgmWriter.h"
+
+class VgmRecorder : private juce::Thread
+{
+public:
+    explicit VgmRecorder(VgmCapture& c, uint32_t ym2612Clock)
+        : juce::Thread("VGM capture"), capture(c), clock(ym2612Clock) {}
+
+    ~VgmRecorder() override { stop(); }
+
+    // Message thread. Opens the file and starts capturing from the next block.
+    bool start(const juce::File& file)
+    {
+        stop();
+
+        std::string error;
+        if (!writer.open(file.getFullPathName().toStdString(), clock, error)) {
+            DBG("VGM capture: " << error);
+            return false;
+        }
+        return startThread(juce::Thread::Priority::low);
+    }
+
+    // Message thread. Finishes and closes the file; returns false on I/O error.
+    bool stop()
+    {
+        if (!isThreadRunning()) return true;
+        stopThread(2000);
+        return lastResult;
+    }
+
+    bool isRecording() const { return isThreadRunning(); }
+
+private:
+    void run() override
+    {
+        capture.start();
+        while (!threadShouldExit()) {
+            drain();
+            wait(10);
+        }
+        capture.stop();
+        drain();
+
+        if (capture.droppedWrites() > 0)
+            DBG("VGM capture: " << capture.droppedWrites() << " register writes dropped (ring full)");
+        lastResult = writer.finish(capture.currentChipTime());
+    }
+
+    void drain()
+    {
+        VgmCapture::Write w;
+        while (capture.pop(w))
+            writer.write(w.chipTime, w.port, w.reg, w.value);
+    }
+
+    VgmCapture&    capture;
+    const uint32_t clock;
+    VgmWriter      writer;
+    bool           lastResult = true;
+
+    JUCE_DECLARE_NON_COPYABLE(VgmRecorder)
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <functional>
+#include "VgmCapture.h"
+
+/**
+ * Ym2612Synth – juce::Synthesiser that forwards MIDI Program Change.
+ *
+ * juce::Synthesiser already splits the block at every MIDI event, so a
+ * program change reported here lands sample-accurately between the voice
+ * renders before and after it. The callback runs on the audio thread and
+ * must not allocate or block.
+ *
+ * The same split positions drive the VGM capture clock: writes made while
+ * voices render, or while a note-on between renders is handled, are
+ * stamped with the sample position they belong to, and each render span is
+ * flushed to the capture in time order once every voice has rendered it.
+ */
+class Ym2612Synth : public juce::Synthesiser
+{
+public:
+    std::function<void(int midiChannel, int programNumber)> onProgramChange;
+
+    void handleProgramChange(int midiChannel, int programNumber) override
+    {
+        if (onProgramChange)
+            onProgramChange(midiChannel, programNumber);
+    }
+
+    VgmCapture* capture = nullptr;
+
+protected:
+    using juce::Synthesiser::renderVoices;
+
+    void renderVoices(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) override
+    {
+        if (capture != nullptr) capture->setBlockOffset(startSample);
+        juce::Synthesiser::renderVoices(buffer, startSample, numSamples);
+        if (capture != nullptr) {
+            capture->flush();
+            capture->setBlockOffset(startSample + numSamples);
+        }
+    }
+};
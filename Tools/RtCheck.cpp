@@ -0,0 +1,192 @@
+#include "RtCheck.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__GLIBC__)
+ #define ARM2612_RTCHECK_GLIBC 1
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <malloc.h>
+ #include <pthread.h>
+ #include <unistd.h>
+#elif defined(__APPLE__)
+ #include <execinfo.h>
+ #include <unistd.h>
+#endif
+
+#ifndef ARM2612_RTCHECK_GLIBC
+ #define ARM2612_RTCHECK_GLIBC 0
+#endif
+
+namespace RtCheck {
+namespace {
+
+constexpr int kFullReports = 8;
+
+thread_local int  tlsDepth     = 0;       // > 0 inside ScopedAudioThread
+thread_local bool tlsReporting = false;   // guards against re-entry while reporting
+
+std::atomic<uint64_t> nAlloc { 0 }, nFree { 0 }, nContended { 0 }, nLocks { 0 };
+std::atomic<int>      nReports { 0 };
+std::atomic<bool>     strictLocks { false };
+
+// Async-signal-safe style output: no stdio buffers, no allocation
+void say(const char* s)
+{
+   #if ARM2612_RTCHECK_GLIBC || defined(__APPLE__)
+    const ssize_t ignored = ::write(2, s, std::strlen(s));
+    (void) ignored;
+   #else
+    std::fputs(s, stderr);
+   #endif
+}
+
+void report(const char* what, bool violation)
+{
+    if (!violation || tlsReporting) return;
+    tlsReporting = true;
+
+    const int n = nReports.fetch_add(1);
+    if (n < kFullReports) {
+        say("\n*** RT violation on audio thread: ");
+        say(what);
+        say("\n");
+       #if ARM2612_RTCHECK_GLIBC || defined(__APPLE__)
+        void* frames[48];
+        const int depth = ::backtrace(frames, 48);
+        ::backtrace_symbols_fd(frames, depth, 2);
+       #endif
+    } else if (n == kFullReports) {
+        say("*** further RT violations are counted but not traced\n");
+    }
+
+    tlsReporting = false;
+}
+
+inline bool inRegion() { return tlsDepth > 0 && !tlsReporting; }
+
+void onAlloc(const char* what)
+{
+    if (!inRegion()) return;
+    nAlloc.fetch_add(1, std::memory_order_relaxed);
+    report(what, true);
+}
+
+void onFree(const char* what, const void* p)
+{
+    if (p == nullptr || !inRegion()) return;
+    nFree.fetch_add(1, std::memory_order_relaxed);
+    report(what, true);
+}
+
+} // namespace
+
+void prime()
+{
+   #if ARM2612_RTCHECK_GLIBC || defined(__APPLE__)
+    void* frames[4];
+    ::backtrace(frames, 4);   // loads the unwinder, which allocates once
+   #endif
+   #if ARM2612_RTCHECK_GLIBC
+    pthread_mutex_t m = PTHREAD_MUTEX_INITIALIZER;
+    pthread_mutex_lock(&m);   // resolves the real lock functions
+    pthread_mutex_unlock(&m);
+   #endif
+}
+
+void setStrictLocks(bool strict) { strictLocks.store(strict); }
+
+Counts counts()
+{
+    return { nAlloc.load(), nFree.load(), nContended.load(), nLocks.load() };
+}
+
+void reset()
+{
+    nAlloc = nFree = nContended = nLocks = 0;
+    nReports = 0;
+}
+
+uint64_t violations()
+{
+    const auto c = counts();
+    return c.allocations + c.deallocations + c.contendedLocks + (strictLocks.load() ? c.locks : 0);
+}
+
+ScopedAudioThread::ScopedAudioThread()  { ++tlsDepth; }
+ScopedAudioThread::~ScopedAudioThread() { --tlsDepth; }
+
+} // namespace RtCheck
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Interposers
+// ─────────────────────────────────────────────────────────────────────────────
+#if ARM2612_RTCHECK_GLIBC
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void  __libc_free(void*);
+
+void* malloc(size_t n) noexcept             { RtCheck::onAlloc("malloc");  return __libc_malloc(n); }
+void* calloc(size_t n, size_t s) noexcept   { RtCheck::onAlloc("calloc");  return __libc_calloc(n, s); }
+void* realloc(void* p, size_t n) noexcept   { RtCheck::onAlloc("realloc"); return __libc_realloc(p, n); }
+void* memalign(size_t a, size_t n) noexcept { RtCheck::onAlloc("memalign"); return __libc_memalign(a, n); }
+void* aligned_alloc(size_t a, size_t n) noexcept { RtCheck::onAlloc("aligned_alloc"); return __libc_memalign(a, n); }
+void  free(void* p) noexcept                { RtCheck::onFree("free", p);  __libc_free(p); }
+
+int posix_memalign(void** out, size_t a, size_t n) noexcept
+{
+    RtCheck::onAlloc("posix_memalign");
+    *out = __libc_memalign(a, n);
+    return *out != nullptr ? 0 : ENOMEM;
+}
+
+int pthread_mutex_lock(pthread_mutex_t* m) noexcept
+{
+    using Fn = int (*)(pthread_mutex_t*);
+    static const Fn realLock    = reinterpret_cast<Fn>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+    static const Fn realTryLock = reinterpret_cast<Fn>(dlsym(RTLD_NEXT, "pthread_mutex_trylock"));
+
+    if (RtCheck::inRegion()) {
+        if (realTryLock(m) == 0) {
+            RtCheck::nLocks.fetch_add(1, std::memory_order_relaxed);
+            RtCheck::report("pthread_mutex_lock (uncontended)", RtCheck::strictLocks.load());
+            return 0;
+        }
+        RtCheck::nContended.fetch_add(1, std::memory_order_relaxed);
+        RtCheck::report("pthread_mutex_lock blocked (held by another thread)", true);
+    }
+    return realLock(m);
+}
+} // extern "C"
+
+#else
+
+// operator new/delete only – malloc itself cannot be interposed portably
+void* operator new(std::size_t n)
+{
+    RtCheck::onAlloc("operator new");
+    if (void* p = std::malloc(n == 0 ? 1 : n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return operator new(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept
+{
+    RtCheck::onAlloc("operator new");
+    return std::malloc(n == 0 ? 1 : n);
+}
+void* operator new[](std::size_t n, const std::nothrow_t& t) noexcept { return operator new(n, t); }
+void  operator delete(void* p) noexcept                 { RtCheck::onFree("operator delete", p); std::free(p); }
+void  operator delete[](void* p) noexcept               { operator delete(p); }
+void  operator delete(void* p, std::size_t) noexcept    { operator delete(p); }
+void  operator delete[](void* p, std::size_t) noexcept  { operator delete(p); }
+
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// RtCheck.h  –  catches allocations and blocking locks on the audio thread
+//
+// Linking RtCheck.cpp into a tool replaces the allocator entry points and,
+// on glibc, pthread_mutex_lock. Inside a ScopedAudioThread region on the
+// current thread:
+//
+//   malloc / calloc / realloc / free / operator new / delete  → violation
+//   pthread_mutex_lock on a mutex another thread holds        → violation
+//   pthread_mutex_lock that succeeds at once                  → counted; a
+//                                                               violation in
+//                                                               strict mode
+//
+// Every violation prints a stack trace to stderr (the first few in full,
+// then just a count). Intended for test tools only – never link it into the
+// plugin. Allocator and mutex interception need glibc; other platforms only
+// see operator new/delete.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <cstdint>
+
+namespace RtCheck {
+
+struct Counts {
+    uint64_t allocations    = 0;
+    uint64_t deallocations  = 0;
+    uint64_t contendedLocks = 0;
+    uint64_t locks          = 0;   // uncontended acquisitions
+};
+
+// Call once at startup, before any region, so lazy loader work is done
+void prime();
+
+// Uncontended locks become violations too
+void setStrictLocks(bool strict);
+
+// Totals since the last reset
+Counts counts();
+void   reset();
+
+// Number of counted events that are violations under the current mode
+uint64_t violations();
+
+class ScopedAudioThread
+{
+public:
+    ScopedAudioThread();
+    ~ScopedAudioThread();
+    ScopedAudioThread(const ScopedAudioThread&) = delete;
+    ScopedAudioThread& operator=(const ScopedAudioThread&) = delete;
+};
+
+} // namespace RtCheck
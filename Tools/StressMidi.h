@@ -0,0 +1,136 @@
+#pragma once
+
+// ─────────────────────────────────────────────────────────────────────────────
+// StressMidi.h  –  dense synthetic MIDI for driving the processor in tools
+//
+// Each scenario fills one block's MidiBuffer at a time, so the caller can
+// run any block size. Everything is seeded, so a run is repeatable.
+//
+//   chords     full six-voice chords every 100 ms
+//   steal      a new note every 15 ms, released 16 notes later – the
+//              synth is stealing on almost every note-on
+//   retrigger  one key hammered on/off every 2 ms (several per block)
+//   programs   MIDI program change plus a note every 40 ms
+//   automation chords, and every block the host moves eight parameters
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <deque>
+
+namespace StressMidi {
+
+enum class Kind { chords, steal, retrigger, programs, automation };
+
+struct Scenario {
+    const char* name;
+    Kind        kind;
+};
+
+inline const std::vector<Scenario>& scenarios()
+{
+    static const std::vector<Scenario> all = {
+        { "chords",     Kind::chords     },
+        { "steal",      Kind::steal      },
+        { "retrigger",  Kind::retrigger  },
+        { "programs",   Kind::programs   },
+        { "automation", Kind::automation },
+    };
+    return all;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+class Generator
+{
+public:
+    Generator(Kind k, double sampleRate, int numPrograms)
+        : kind(k), rate(sampleRate), programs(juce::jmax(1, numPrograms)), random(0x2612) {}
+
+    bool automates() const { return kind == Kind::automation; }
+
+    // Adds the events falling in [blockStart, blockStart + numSamples)
+    void fill(juce::MidiBuffer& midi, juce::int64 blockStart, int numSamples)
+    {
+        const juce::int64 end = blockStart + numSamples;
+        const juce::int64 period = periodSamples();
+
+        while (nextEvent < end) {
+            emit(midi, int(nextEvent - blockStart));
+            nextEvent += period;
+        }
+    }
+
+    // Host-style automation: what a plugin wrapper does on the audio thread
+    void automate(juce::AudioProcessor& processor, int blockIndex)
+    {
+        const auto& params = processor.getParameters();
+        if (params.isEmpty()) return;
+        for (int i = 0; i < 8; ++i) {
+            auto* p = params[(blockIndex * 8 + i) % params.size()];
+            const float v = random.nextFloat();
+            p->setValue(v);
+            p->sendValueChangedMessageToListeners(v);
+        }
+    }
+
+private:
+    juce::int64 periodSamples() const
+    {
+        double ms = 100.0;
+        switch (kind) {
+            case Kind::chords:     ms = 100.0; break;
+            case Kind::steal:      ms = 15.0;  break;
+            case Kind::retrigger:  ms = 2.0;   break;
+            case Kind::programs:   ms = 40.0;  break;
+            case Kind::automation: ms = 100.0; break;
+        }
+        return juce::jmax<juce::int64>(1, juce::roundToInt(rate * ms / 1000.0));
+    }
+
+    void on(juce::MidiBuffer& m, int pos, int note)
+    {
+        m.addEvent(juce::MidiMessage::noteOn(1, note, juce::uint8(40 + random.nextInt(88))), pos);
+        held.push_back(note);
+    }
+
+    void off(juce::MidiBuffer& m, int pos)
+    {
+        m.addEvent(juce::MidiMessage::noteOff(1, held.front()), pos);
+        held.pop_front();
+    }
+
+    void emit(juce::MidiBuffer& m, int pos)
+    {
+        switch (kind) {
+            case Kind::chords:
+            case Kind::automation: {
+                while (!held.empty()) off(m, pos);
+                const int root = 36 + random.nextInt(36);
+                for (int i = 0; i < 6; ++i) on(m, pos, root + i * 4);
+                break;
+            }
+            case Kind::steal:
+                on(m, pos, 30 + random.nextInt(60));
+                if (held.size() > 16) off(m, pos);
+                break;
+            case Kind::retrigger:
+                if (!held.empty()) off(m, pos);
+                else               on(m, pos, 60);
+                break;
+            case Kind::programs:
+                while (!held.empty()) off(m, pos);
+                m.addEvent(juce::MidiMessage::programChange(1, (step++) % programs), pos);
+                on(m, pos, 48 + random.nextInt(24));
+                break;
+        }
+    }
+
+    Kind             kind;
+    double           rate;
+    int              programs;
+    juce::Random     random;
+    juce::int64      nextEvent = 0;
+    int              step      = 0;
+    std::deque<int>  held;
+};
+
+} // namespace StressMidi
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// WavWriter.h  –  minimal 16-bit PCM RIFF/WAVE writer for the CLI tools
+//
+// Samples are interleaved floats in [-1, 1]; anything outside is clipped.
+// write16() takes a whole render; Stream appends chunk by chunk.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace WavWriter {
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Stream  –  incremental writer for renders of unknown length
+//
+// The header is written with zero sizes and patched in close(), so only the
+// caller's chunk is ever held in memory.
+// ─────────────────────────────────────────────────────────────────────────────
+class Stream
+{
+public:
+    ~Stream() { close(); }
+
+    bool open(const std::string& path, int numChannels, uint32_t sampleRate)
+    {
+        m_file     = std::fopen(path.c_str(), "wb");
+        m_channels = numChannels;
+        m_rate     = sampleRate;
+        m_bytes    = 0;
+        m_ok       = (m_file != nullptr) && writeHeader();
+        return m_ok;
+    }
+
+    // Appends interleaved frames
+    bool write(const float* interleaved, size_t numFrames)
+    {
+        m_scratch.clear();
+        for (size_t i = 0; i < numFrames * size_t(m_channels); ++i) {
+            const long v = std::lround(std::clamp(interleaved[i], -1.0f, 1.0f) * 32767.0f);
+            push16(m_scratch, uint16_t(int16_t(v)));
+        }
+        m_ok = m_ok && std::fwrite(m_scratch.data(), 1, m_scratch.size(), m_file) == m_scratch.size();
+        m_bytes += uint32_t(m_scratch.size());
+        return m_ok;
+    }
+
+    bool close()
+    {
+        if (m_file == nullptr) return m_ok;
+        m_ok = m_ok && std::fseek(m_file, 0, SEEK_SET) == 0 && writeHeader();
+        m_ok = (std::fclose(m_file) == 0) && m_ok;
+        m_file = nullptr;
+        return m_ok;
+    }
+
+private:
+    static void push16(std::vector<uint8_t>& out, uint16_t v) { out.push_back(uint8_t(v)); out.push_back(uint8_t(v >> 8)); }
+
+    bool writeHeader()
+    {
+        const uint16_t blockAlign = uint16_t(m_channels * 2);
+
+        std::vector<uint8_t> out;
+        auto tag = [&](const char* t) { for (int k = 0; k < 4; ++k) out.push_back(uint8_t(t[k])); };
+        auto w16 = [&](uint16_t v)    { push16(out, v); };
+        auto w32 = [&](uint32_t v)    { w16(uint16_t(v)); w16(uint16_t(v >> 16)); };
+
+        tag("RIFF"); w32(36 + m_bytes);
+        tag("WAVE");
+        tag("fmt "); w32(16);
+        w16(1);                              // PCM
+        w16(uint16_t(m_channels));
+        w32(m_rate);
+        w32(m_rate * blockAlign);
+        w16(blockAlign);
+        w16(16);
+        tag("data"); w32(m_bytes);
+
+        return std::fwrite(out.data(), 1, out.size(), m_file) == out.size();
+    }
+
+    FILE*                m_file     = nullptr;
+    int                  m_channels = 2;
+    uint32_t             m_rate     = 44100;
+    uint32_t             m_bytes    = 0;
+    bool                 m_ok       = false;
+    std::vector<uint8_t> m_scratch;
+};
+
+// Whole render in one call
+inline bool write16(const std::string& path, const std::vector<float>& interleaved,
+                    int numChannels, uint32_t sampleRate)
+{
+    Stream s;
+    if (!s.open(path, numChannels, sampleRate)) return false;
+    s.write(interleaved.data(), interleaved.size() / size_t(numChannels));
+    return s.close();
+}
+
+} // namespace WavWriter
@@ -0,0 +1,224 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// arm2612-batch  –  offline MIDI → WAV/FLAC renderer, parallel across files
+//
+//   arm2612-batch [--patch N|name|file] [--rate 48000] [--format wav|flac]
+//                 [--bits 16|24] [--voices 6] [--tail seconds] [--jobs N]
+//                 [--out-dir dir] song.mid [other.mid=patch ...]
+//
+// Every .mid file becomes one audio file named after it in --out-dir. A
+// file can pick its own patch with "file.mid=<patch>"; otherwise --patch
+// applies (default: built-in patch 0). Patches are built-in indices or
+// names, or instrument files in any format PatchCodec.h reads.
+//
+// Rendering goes through OfflineRenderer (chip-rate voices + one sinc
+// conversion), streamed in chunks to the writer, so memory per job stays
+// constant. Files render concurrently on a thread pool – one job per core
+// unless --jobs says otherwise. No audio device is opened.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include <atomic>
+#include <cstdio>
+
+#include "OfflineRenderer.h"
+#include "PatchFile.h"
+#include "PatchCompiler.h"
+
+struct PatchSpec {
+    juce::String               label;
+    Ym2612Voice::RegisterImage image;
+    double                     tailSeconds = 0.0;
+};
+
+// Built-in index or name, or a patch file. Returns false if unresolvable.
+static bool resolvePatch(const juce::String& spec, PatchSpec& out)
+{
+    auto fromPatch = [&](const YM2612Patch& p, int block, int lfoFreq, const juce::String& label) {
+        out.label       = label;
+        out.image       = compilePatch(p, block, lfoFreq);
+        out.tailSeconds = Ym2612Engine::estimateReleaseSeconds(out.image);
+        return true;
+    };
+
+    if (PatchCodecs::forExtension(spec.fromLastOccurrenceOf(".", false, false).toStdString()) != nullptr) {
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(spec);
+        PatchData data;
+        if (PatchFile::read(file, data) == nullptr) return false;
+        return fromPatch(data.patch, data.block, data.lfoFreq, file.getFileName());
+    }
+
+    for (int i = 0; i < kNumBuiltInPatches; ++i) {
+        const auto& e = kBuiltInPatches[i];
+        if (spec.equalsIgnoreCase(e.name) || (spec.containsOnly("0123456789") && spec.getIntValue() == i))
+            return fromPatch(*e.patch, e.block, e.lfoFreq, e.name);
+    }
+    return false;
+}
+
+struct Options {
+    double       rate     = 48000.0;
+    juce::String format   = "wav";
+    int          bits     = 16;
+    int          voices   = 6;
+    double       tail     = -1.0;     // < 0: use the patch's release estimate
+    juce::File   outDir   = juce::File::getCurrentWorkingDirectory();
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+class RenderJob : public juce::ThreadPoolJob
+{
+public:
+    RenderJob(juce::File midiFileToRender, PatchSpec patchToUse, const Options& o,
+              std::atomic<int>& failureCount)
+        : juce::ThreadPoolJob(midiFileToRender.getFileName()),
+          midiFile(std::move(midiFileToRender)), patch(std::move(patchToUse)),
+          options(o), failures(failureCount) {}
+
+    JobStatus runJob() override
+    {
+        const auto t0 = juce::Time::getMillisecondCounterHiRes();
+        juce::String error;
+        double seconds = 0.0;
+
+        if (!render(seconds, error)) {
+            ++failures;
+            std::fprintf(stderr, "FAIL %s: %s\n", midiFile.getFileName().toRawUTF8(), error.toRawUTF8());
+        } else {
+            const double cpu = (juce::Time::getMillisecondCounterHiRes() - t0) / 1000.0;
+            std::printf("%-32s %-16s %7.2f s audio in %6.2f s (%.1fx realtime)\n",
+                        midiFile.getFileName().toRawUTF8(), patch.label.toRawUTF8(),
+                        seconds, cpu, cpu > 0.0 ? seconds / cpu : 0.0);
+        }
+        return jobHasFinished;
+    }
+
+private:
+    bool render(double& seconds, juce::String& error)
+    {
+        // ── MIDI: merge all tracks, ticks → seconds → samples ─────────────────
+        juce::FileInputStream in(midiFile);
+        juce::MidiFile mf;
+        if (!in.openedOk() || !mf.readFrom(in)) { error = "not a readable MIDI file"; return false; }
+        mf.convertTimestampTicksToSeconds();
+
+        juce::MidiMessageSequence seq;
+        for (int t = 0; t < mf.getNumTracks(); ++t)
+            seq.addSequence(*mf.getTrack(t), 0.0);
+        seq.sort();
+
+        juce::MidiBuffer midi;
+        double end = 0.0;
+        for (const auto* ev : seq) {
+            const auto& m = ev->message;
+            if (m.isMetaEvent() || m.isSysEx()) continue;
+            midi.addEvent(m, juce::roundToInt(m.getTimeStamp() * options.rate));
+            end = juce::jmax(end, m.getTimeStamp());
+        }
+
+        seconds = end + (options.tail >= 0.0 ? options.tail : patch.tailSeconds);
+        const int numSamples = juce::roundToInt(seconds * options.rate);
+
+        // ── Writer ────────────────────────────────────────────────────────────
+        std::unique_ptr<juce::AudioFormat> format;
+        if (options.format == "flac") format = std::make_unique<juce::FlacAudioFormat>();
+        else                          format = std::make_unique<juce::WavAudioFormat>();
+
+        const auto outFile = options.outDir.getChildFile(midiFile.getFileNameWithoutExtension())
+                                           .withFileExtension(options.format);
+        outFile.deleteFile();
+        auto stream = std::make_unique<juce::FileOutputStream>(outFile);
+        if (!stream->openedOk()) { error = "cannot write " + outFile.getFullPathName(); return false; }
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(
+            format->createWriterFor(stream.get(), options.rate, 2, options.bits, {}, 0));
+        if (writer == nullptr) { error = "unsupported format/bit depth"; return false; }
+        stream.release();   // owned by the writer now
+
+        // ── Render ────────────────────────────────────────────────────────────
+        OfflineRenderer renderer(options.voices);
+        renderer.setRegisterImage(patch.image);
+        const bool ok = renderer.renderTo(midi, numSamples, options.rate,
+            [&](const float* const* ch, int n) {
+                return writer->writeFromFloatArrays(ch, 2, n) && !shouldExit();
+            });
+        if (!ok) error = "write failed";
+        return ok;
+    }
+
+    juce::File        midiFile;
+    PatchSpec         patch;
+    const Options&    options;
+    std::atomic<int>& failures;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+static void usage()
+{
+    std::fprintf(stderr,
+        "usage: arm2612-batch [--patch N|name|file] [--rate 48000] [--format wav|flac]\n"
+        "                     [--bits 16|24] [--voices 6] [--tail seconds] [--jobs N]\n"
+        "                     [--out-dir dir] song.mid [other.mid=patch ...]\n");
+}
+
+int main(int argc, char** argv)
+{
+    Options      options;
+    juce::String defaultPatch = "0";
+    int          jobs = juce::SystemStats::getNumCpus();
+    juce::StringArray inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        const juce::String a = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if      (a == "--patch"   && hasValue) defaultPatch    = argv[++i];
+        else if (a == "--rate"    && hasValue) options.rate    = juce::String(argv[++i]).getDoubleValue();
+        else if (a == "--format"  && hasValue) options.format  = juce::String(argv[++i]).toLowerCase();
+        else if (a == "--bits"    && hasValue) options.bits    = juce::String(argv[++i]).getIntValue();
+        else if (a == "--voices"  && hasValue) options.voices  = juce::String(argv[++i]).getIntValue();
+        else if (a == "--tail"    && hasValue) options.tail    = juce::String(argv[++i]).getDoubleValue();
+        else if (a == "--jobs"    && hasValue) jobs            = juce::String(argv[++i]).getIntValue();
+        else if (a == "--out-dir" && hasValue) options.outDir  = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        else if (!a.startsWith("--"))          inputs.add(a);
+        else { usage(); return 2; }
+    }
+
+    if (inputs.isEmpty() || options.rate <= 0.0 || options.voices < 1 || jobs < 1
+        || (options.format != "wav" && options.format != "flac")) {
+        usage();
+        return 2;
+    }
+    if (!options.outDir.createDirectory()) {
+        std::fprintf(stderr, "cannot create %s\n", options.outDir.getFullPathName().toRawUTF8());
+        return 2;
+    }
+
+    // Resolve every patch up front so a typo fails before any rendering
+    std::vector<std::pair<juce::File, PatchSpec>> work;
+    for (const auto& input : inputs) {
+        const auto path = input.upToFirstOccurrenceOf("=", false, false);
+        const auto spec = input.contains("=") ? input.fromFirstOccurrenceOf("=", false, false) : defaultPatch;
+        PatchSpec patch;
+        if (!resolvePatch(spec, patch)) {
+            std::fprintf(stderr, "unknown patch '%s'\n", spec.toRawUTF8());
+            return 2;
+        }
+        work.emplace_back(juce::File::getCurrentWorkingDirectory().getChildFile(path), patch);
+    }
+
+    std::atomic<int> failures { 0 };
+    const auto t0 = juce::Time::getMillisecondCounterHiRes();
+    {
+        juce::ThreadPool pool(juce::ThreadPoolOptions{}.withNumberOfThreads(jobs));
+        for (auto& [file, patch] : work)
+            pool.addJob(new RenderJob(file, patch, options, failures), true);
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep(20);
+    }
+
+    std::printf("%d file(s), %d failed, %.2f s wall time on %d job(s)\n",
+                (int) work.size(), failures.load(),
+                (juce::Time::getMillisecondCounterHiRes() - t0) / 1000.0, jobs);
+    return failures.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,309 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// arm2612-bench  –  render throughput and note-on cost of the DSP core
+//
+//   arm2612-bench [--quick] [--full] [--out results.json] [--label text]
+//
+// Render sweeps (held notes, one Ym2612Engine per voice, mixed into a shared
+// stereo block exactly like juce::Synthesiser does):
+//   patches × host rates  at  6 voices, 512-sample blocks
+//   voice counts 1-64     at  first patch, 48 kHz, 512-sample blocks
+//   block sizes 32-4096   at  6 voices, first patch, 48 kHz
+// --full runs the whole patch × rate × voices × block cross product instead.
+//
+// Per-operation timings:
+//   startNote          chip reset + full register write + frequency + key on
+//   writeAllRegisters  re-send of one register image
+//   pushParams         compilePatch + setRegisterImage on every voice – the
+//                      work ARM2612AudioProcessor::pushParamsToVoices does
+//                      after reading the APVTS
+//   macroTick          one 60 Hz step of a volume + arp + pitch + op TL macro
+//                      set: frame build, changed-register writes, frequency
+//
+// Every figure is the median of several repetitions. Results go to stdout as
+// a table and, with --out, to a JSON file for comparing commits.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Ym2612Engine.h"
+#include "PatchCompiler.h"
+#include "MacroProgram.h"
+
+#ifndef ARM2612_BENCH_REVISION
+ #define ARM2612_BENCH_REVISION "unknown"
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kVoiceCounts[] = { 1, 2, 4, 6, 8, 16, 32, 64 };
+static constexpr int kBlockSizes[]  = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+static constexpr double kRates[]    = { 44100.0, 48000.0, Ym2612Engine::CHIP_RATE, 96000.0 };
+
+static constexpr int kDefaultVoices = 6;      // NUM_VOICES in the plugin
+static constexpr int kDefaultBlock  = 512;
+static constexpr double kDefaultRate = 48000.0;
+
+struct Settings {
+    double seconds     = 1.0;   // audio rendered per repetition
+    int    repetitions = 5;
+    int    opIterations = 20000;
+};
+
+struct RenderResult {
+    int    patch;
+    double rate;
+    int    voices;
+    int    block;
+    double nsPerSample;        // per output frame, all voices
+    double nsPerVoiceSample;
+    double voiceSamplesPerSec;
+    double realtimeFactor;     // audio seconds rendered per CPU second
+};
+
+struct OpResult {
+    std::string name;
+    int         patch;
+    double      nsPerCall;
+};
+
+static double median(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+static double elapsedNs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+}
+
+// Keeps the optimiser from discarding rendered audio
+static volatile double g_sink = 0.0;
+
+// ─────────────────────────────────────────────────────────────────────────────
+static RenderResult benchRender(const Settings& s, int patch, double rate, int voices, int block)
+{
+    const PatchEntry& e = kBuiltInPatches[patch];
+    const auto image = compilePatch(*e.patch, e.block, e.lfoFreq);
+
+    std::vector<std::unique_ptr<Ym2612Engine>> engines;
+    for (int v = 0; v < voices; ++v) {
+        engines.push_back(std::make_unique<Ym2612Engine>());
+        engines.back()->setRegisterImage(image);
+    }
+
+    std::vector<float> left(static_cast<size_t>(block)), right(static_cast<size_t>(block));
+    float* dst[2] = { left.data(), right.data() };
+
+    const int numBlocks = std::max(1, int(s.seconds * rate) / block);
+    std::vector<double> runs;
+
+    for (int r = 0; r <= s.repetitions; ++r) {    // r == 0 is warm-up
+        for (int v = 0; v < voices; ++v)
+            engines[size_t(v)]->startNote(36 + (v * 7) % 48, rate, 2);
+
+        const auto t0 = Clock::now();
+        for (int b = 0; b < numBlocks; ++b) {
+            std::fill(left.begin(), left.end(), 0.0f);
+            std::fill(right.begin(), right.end(), 0.0f);
+            for (auto& eng : engines)
+                eng->render(dst, block, 1.0f);
+        }
+        const double ns = elapsedNs(t0);
+        g_sink = g_sink + left[0] + right[size_t(block - 1)];
+        if (r > 0) runs.push_back(ns);
+    }
+
+    const double frames = double(numBlocks) * block;
+    const double ns     = median(runs);
+
+    RenderResult res;
+    res.patch              = patch;
+    res.rate               = rate;
+    res.voices             = voices;
+    res.block              = block;
+    res.nsPerSample        = ns / frames;
+    res.nsPerVoiceSample   = ns / (frames * voices);
+    res.voiceSamplesPerSec = frames * voices / (ns * 1e-9);
+    res.realtimeFactor     = (frames / rate) / (ns * 1e-9);
+    return res;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+template <typename Fn>
+static double timeOp(const Settings& s, Fn&& fn)
+{
+    std::vector<double> runs;
+    for (int r = 0; r <= s.repetitions; ++r) {
+        const auto t0 = Clock::now();
+        for (int i = 0; i < s.opIterations; ++i)
+            fn(i);
+        if (r > 0) runs.push_back(elapsedNs(t0) / s.opIterations);
+    }
+    return median(runs);
+}
+
+static void benchOps(const Settings& s, int patch, std::vector<OpResult>& out)
+{
+    const PatchEntry& e     = kBuiltInPatches[patch];
+    const PatchEntry& other = kBuiltInPatches[(patch + 1) % kNumBuiltInPatches];
+    const auto image = compilePatch(*e.patch, e.block, e.lfoFreq);
+
+    Ym2612Engine engine;
+    engine.setRegisterImage(image);
+
+    out.push_back({ "startNote", patch, timeOp(s, [&](int i) {
+        engine.startNote(36 + i % 48, kDefaultRate, 2);
+    }) });
+
+    out.push_back({ "writeAllRegisters", patch, timeOp(s, [&](int) {
+        engine.writeAllRegisters();
+    }) });
+
+    // Alternate between two patches so setRegisterImage never short-circuits
+    std::vector<std::unique_ptr<Ym2612Engine>> voices;
+    for (int v = 0; v < kDefaultVoices; ++v)
+        voices.push_back(std::make_unique<Ym2612Engine>());
+
+    out.push_back({ "pushParams", patch, timeOp(s, [&](int i) {
+        const PatchEntry& p = (i & 1) ? other : e;
+        const auto img = compilePatch(*p.patch, p.block, p.lfoFreq);
+        for (auto& v : voices)
+            v->setRegisterImage(img);
+    }) });
+
+    // A typical tracker instrument: volume decay, octave arp, vibrato, and
+    // a TL sweep on the first operator
+    auto program = std::make_unique<MacroProgram>();
+    int16_t values[16];
+    MacroProgram::Macro m;
+    for (int i = 0; i < 16; ++i) values[i] = int16_t(127 - i * 4);
+    m.target = MacroProgram::Target::volume;  m.length = 16;  program->add(m, values);
+    values[0] = 0;  values[1] = 12;  values[2] = 7;
+    m.target = MacroProgram::Target::arp;     m.length = 3;   m.loop = 0;  program->add(m, values);
+    for (int i = 0; i < 8; ++i) values[i] = int16_t(i < 4 ? 16 : -16);
+    m.target = MacroProgram::Target::pitch;   m.length = 8;   m.relative = true;  program->add(m, values);
+    for (int i = 0; i < 16; ++i) values[i] = int16_t(i * 6);
+    m = MacroProgram::Macro();
+    m.target = MacroProgram::Target::opField; m.reg = 1;  m.mask = 0x7F;  m.length = 16;  m.loop = 0;
+    program->add(m, values);
+
+    MacroPlayer player;
+    engine.startNote(60, kDefaultRate, 2);
+    player.start(program.get(), 60);
+    out.push_back({ "macroTick", patch, timeOp(s, [&](int) {
+        player.tick(engine);
+    }) });
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+static std::string jsonEscape(const std::string& in)
+{
+    std::string s;
+    for (char c : in) {
+        if (c == '"' || c == '\\') { s += '\\'; s += c; }
+        else if (static_cast<unsigned char>(c) < 0x20) s += ' ';
+        else s += c;
+    }
+    return s;
+}
+
+static bool writeJson(const std::string& path, const std::string& label, const Settings& s,
+                      const std::vector<RenderResult>& render, const std::vector<OpResult>& ops)
+{
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (f == nullptr) return false;
+
+    std::fprintf(f, "{\n  \"schema\": 1,\n");
+    std::fprintf(f, "  \"revision\": \"%s\",\n", jsonEscape(ARM2612_BENCH_REVISION).c_str());
+    std::fprintf(f, "  \"label\": \"%s\",\n", jsonEscape(label).c_str());
+    std::fprintf(f, "  \"secondsPerRun\": %g,\n  \"repetitions\": %d,\n", s.seconds, s.repetitions);
+
+    std::fprintf(f, "  \"render\": [\n");
+    for (size_t i = 0; i < render.size(); ++i) {
+        const auto& r = render[i];
+        std::fprintf(f,
+            "    { \"patch\": \"%s\", \"rate\": %g, \"voices\": %d, \"block\": %d, "
+            "\"nsPerSample\": %.3f, \"nsPerVoiceSample\": %.3f, \"voiceSamplesPerSec\": %.0f, "
+            "\"realtimeFactor\": %.2f }%s\n",
+            jsonEscape(kBuiltInPatches[r.patch].name).c_str(), r.rate, r.voices, r.block,
+            r.nsPerSample, r.nsPerVoiceSample, r.voiceSamplesPerSec, r.realtimeFactor,
+            i + 1 < render.size() ? "," : "");
+    }
+    std::fprintf(f, "  ],\n  \"ops\": [\n");
+    for (size_t i = 0; i < ops.size(); ++i) {
+        const auto& o = ops[i];
+        std::fprintf(f, "    { \"op\": \"%s\", \"patch\": \"%s\", \"nsPerCall\": %.1f }%s\n",
+                     o.name.c_str(), jsonEscape(kBuiltInPatches[o.patch].name).c_str(), o.nsPerCall,
+                     i + 1 < ops.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+int main(int argc, char** argv)
+{
+    Settings    s;
+    bool        full = false;
+    std::string outPath, label;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if      (a == "--quick") { s.seconds = 0.1; s.repetitions = 3; s.opIterations = 2000; }
+        else if (a == "--full")                 full    = true;
+        else if (a == "--out"   && hasValue)    outPath = argv[++i];
+        else if (a == "--label" && hasValue)    label   = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: arm2612-bench [--quick] [--full] [--out results.json] [--label text]\n");
+            return 2;
+        }
+    }
+
+    std::vector<RenderResult> render;
+    auto run = [&](int patch, double rate, int voices, int block) {
+        render.push_back(benchRender(s, patch, rate, voices, block));
+        const auto& r = render.back();
+        std::printf("%-14s %6.0f Hz %3d voices %5d block  %8.2f ns/sample  %7.2f ns/voice-sample  %7.1fx realtime\n",
+                    kBuiltInPatches[patch].name, rate, voices, block,
+                    r.nsPerSample, r.nsPerVoiceSample, r.realtimeFactor);
+    };
+
+    if (full) {
+        for (int p = 0; p < kNumBuiltInPatches; ++p)
+            for (double rate : kRates)
+                for (int voices : kVoiceCounts)
+                    for (int block : kBlockSizes)
+                        run(p, rate, voices, block);
+    } else {
+        for (int p = 0; p < kNumBuiltInPatches; ++p)
+            for (double rate : kRates)
+                run(p, rate, kDefaultVoices, kDefaultBlock);
+        for (int voices : kVoiceCounts)
+            run(0, kDefaultRate, voices, kDefaultBlock);
+        for (int block : kBlockSizes)
+            run(0, kDefaultRate, kDefaultVoices, block);
+    }
+
+    std::vector<OpResult> ops;
+    for (int p = 0; p < kNumBuiltInPatches; ++p)
+        benchOps(s, p, ops);
+    for (const auto& o : ops)
+        std::printf("%-18s %-14s %9.1f ns/call\n", o.name.c_str(), kBuiltInPatches[o.patch].name, o.nsPerCall);
+
+    if (!outPath.empty()) {
+        if (!writeJson(outPath, label, s, render, ops)) {
+            std::fprintf(stderr, "could not write %s\n", outPath.c_str());
+            return 1;
+        }
+        std::printf("wrote %s\n", outPath.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// arm2612-codec-bench  –  decode / encode throughput of every patch codec
+//
+//   arm2612-codec-bench [--patches N] [--repetitions N]
+//
+// Each codec encodes N patches (the built-ins, renamed and varied) into one
+// contiguous buffer, then decodes them straight out of it – the same
+// zero-copy path the library scanner takes over a memory mapping. Reports
+// the median of the repetitions as patches/s and MB/s. Bank codecs then
+// stream all N patches (as many as the format holds) out of one bank file.
+// A .opm voice is about 270 bytes, so --patches 20000 makes a 5 MB bank.
+// The .fur module (read only) is the zlib-compressed test skeleton when
+// built with zlib, so its MB/s counts compressed bytes.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "FurModule.h"
+#include "PatchCodec.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double median(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+int main(int argc, char** argv)
+{
+    int patches     = 100000;
+    int repetitions = 5;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a == "--patches" && i + 1 < argc)           patches = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--repetitions" && i + 1 < argc)  repetitions = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::printf("usage: %s [--patches N] [--repetitions N]\n", argv[0]);
+            return a == "--help" || a == "-h" ? 0 : 1;
+        }
+    }
+
+    // Input: the built-ins with varied levels so no two patches are alike
+    std::vector<PatchData> input(static_cast<size_t>(patches));
+    for (int i = 0; i < patches; ++i) {
+        const auto& e = kBuiltInPatches[i % kNumBuiltInPatches];
+        auto& d = input[size_t(i)];
+        d.name  = std::string(e.name) + " " + std::to_string(i);
+        d.patch = *e.patch;
+        d.block = e.block;
+        d.patch.op[i % 4].TL = (d.patch.op[i % 4].TL + i) & 0x7F;
+    }
+
+    std::printf("%-6s %8s %14s %10s %14s %10s\n",
+                "codec", "bytes", "decode/s", "MB/s", "encode/s", "MB/s");
+
+    int failures = 0;
+    for (const auto& codec : PatchCodecs::all()) {
+        std::vector<uint8_t> buffer;
+        std::vector<size_t>  offsets;
+        std::vector<double>  encodeNs, decodeNs;
+
+        for (int rep = 0; rep < repetitions; ++rep) {
+            buffer.clear();
+            offsets.clear();
+            const auto t0 = Clock::now();
+            for (const auto& d : input) {
+                const auto bytes = codec.encode(d);
+                offsets.push_back(buffer.size());
+                buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+            }
+            encodeNs.push_back(std::chrono::duration<double, std::nano>(Clock::now() - t0).count());
+        }
+        offsets.push_back(buffer.size());
+
+        int decoded = 0;
+        for (int rep = 0; rep < repetitions; ++rep) {
+            decoded = 0;
+            PatchData out;
+            const auto t0 = Clock::now();
+            for (size_t i = 0; i + 1 < offsets.size(); ++i)
+                decoded += codec.decode(buffer.data() + offsets[i], offsets[i + 1] - offsets[i], out) ? 1 : 0;
+            decodeNs.push_back(std::chrono::duration<double, std::nano>(Clock::now() - t0).count());
+        }
+        if (decoded != patches) {
+            std::fprintf(stderr, "%s: only %d of %d patches decoded\n", codec.extension, decoded, patches);
+            ++failures;
+        }
+
+        const double bytes  = double(buffer.size());
+        const double dec    = median(decodeNs) * 1e-9;
+        const double enc    = median(encodeNs) * 1e-9;
+        std::printf("%-6s %8.1f %14.0f %10.1f %14.0f %10.1f\n",
+                    codec.extension, bytes / patches,
+                    patches / dec, bytes / dec / 1e6,
+                    patches / enc, bytes / enc / 1e6);
+    }
+
+    // Banks: one file holding as many voices as the format allows (GYB stops
+    // at 510), decoded through the streaming callback
+    std::printf("\n%-6s %8s %10s %12s %14s %10s\n",
+                "bank", "voices", "MB", "decode ms", "voices/s", "MB/s");
+    for (const auto& bank : PatchCodecs::banks()) {
+        const auto file = bank.encode != nullptr ? bank.encode(input) : FurModule::writeSkeleton(input, true);
+        int voices = 0;
+        std::vector<double> decodeNs;
+        for (int rep = 0; rep < repetitions; ++rep) {
+            voices = 0;
+            const auto t0 = Clock::now();
+            bank.decode(file.data(), file.size(), [&voices](const PatchData&) { ++voices; return true; });
+            decodeNs.push_back(std::chrono::duration<double, std::nano>(Clock::now() - t0).count());
+        }
+        if (voices == 0) {
+            std::fprintf(stderr, "%s: bank did not decode\n", bank.extension);
+            ++failures;
+            continue;
+        }
+
+        const double dec = median(decodeNs) * 1e-9;
+        std::printf("%-6s %8d %10.2f %12.2f %14.0f %10.1f\n",
+                    bank.extension, voices, file.size() / 1e6, dec * 1e3,
+                    voices / dec, file.size() / dec / 1e6);
+    }
+    return failures == 0 ? 0 : 1;
+}
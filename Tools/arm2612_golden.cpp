@@ -0,0 +1,313 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// arm2612-golden  –  golden-render regression check for the voice path
+//
+//   arm2612-golden [--update] [--mode exact|rms] [--tol-db 0.5]
+//                  [--golden file] [--filter text] [--dump-dir dir]
+//
+// Renders fixed MIDI sequences through every built-in patch, at several host
+// rates and block sizes, using the same juce::Synthesiser + Ym2612Voice path
+// as the plugin. Each case is reduced to
+//   - a 64-bit FNV-1a hash of the float output (bit-exact check)
+//   - the RMS level of every 20 ms window in dBFS (tolerance check)
+// and compared against the golden file.
+//
+//   --mode exact   every hash must match (default – any DSP change fails)
+//   --mode rms     window levels must stay within --tol-db; use this to
+//                  vet an intentional DSP change before re-running --update
+//   --update       rewrite the golden file from the current build
+//   --dump-dir     also write each case as a 16-bit WAV for listening/diffing
+//
+// Exit code 0 = all cases pass, 1 = mismatch, 2 = usage / missing golden.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Ym2612Voice.h"
+#include "SynthSound.h"
+#include "PatchCompiler.h"
+#include "WavWriter.h"
+
+#ifndef ARM2612_GOLDEN_FILE
+ #define ARM2612_GOLDEN_FILE "golden-renders.txt"
+#endif
+
+static constexpr int    kNumVoices     = 6;      // NUM_VOICES in the plugin
+static constexpr double kCaseSeconds   = 1.0;
+static constexpr double kWindowSeconds = 0.02;
+static constexpr double kRates[]       = { 44100.0, 48000.0, Ym2612Voice::CHIP_RATE, 96000.0 };
+static constexpr int    kBlockSizes[]  = { 32, 512, 4096 };
+
+// ─── Fixed sequences ─────────────────────────────────────────────────────────
+struct Event {
+    double time;       // seconds
+    enum Type { noteOn, noteOff, nextPatch } type;
+    int    note     = 0;
+    int    velocity = 100;
+};
+
+struct Sequence {
+    const char*        name;
+    std::vector<Event> events;
+};
+
+static std::vector<Sequence> makeSequences()
+{
+    std::vector<Sequence> seqs;
+
+    // Monophonic scale – note-on/off timing and release tails
+    Sequence scale { "scale", {} };
+    const int steps[] = { 60, 62, 64, 65, 67, 69, 71, 72 };
+    for (int i = 0; i < 8; ++i) {
+        scale.events.push_back({ i * 0.1,        Event::noteOn,  steps[i], 70 + i * 7 });
+        scale.events.push_back({ i * 0.1 + 0.08, Event::noteOff, steps[i] });
+    }
+    seqs.push_back(scale);
+
+    // Eight-note cluster on six voices – voice stealing
+    Sequence cluster { "cluster", {} };
+    for (int i = 0; i < 8; ++i)
+        cluster.events.push_back({ 0.01 * i, Event::noteOn, 36 + i * 5, 127 - i * 9 });
+    for (int i = 0; i < 8; ++i)
+        cluster.events.push_back({ 0.4, Event::noteOff, 36 + i * 5 });
+    seqs.push_back(cluster);
+
+    // Patch swap while notes are held – dirty-flag register rewrite
+    Sequence swap { "patch_swap", {} };
+    swap.events.push_back({ 0.0,  Event::noteOn,  48, 110 });
+    swap.events.push_back({ 0.05, Event::noteOn,  55, 90 });
+    swap.events.push_back({ 0.2,  Event::nextPatch });
+    swap.events.push_back({ 0.45, Event::noteOff, 48 });
+    swap.events.push_back({ 0.45, Event::noteOff, 55 });
+    seqs.push_back(swap);
+
+    return seqs;
+}
+
+// ─── Rendering ───────────────────────────────────────────────────────────────
+static Ym2612Voice::RegisterImage imageFor(int patch)
+{
+    const PatchEntry& e = kBuiltInPatches[patch % kNumBuiltInPatches];
+    return compilePatch(*e.patch, e.block, e.lfoFreq);
+}
+
+static juce::AudioBuffer<float> renderCase(const Sequence& seq, int patch, double rate, int blockSize)
+{
+    juce::Synthesiser synth;
+    std::vector<Ym2612Voice*> voices;
+    synth.addSound(new SynthSound());
+    for (int i = 0; i < kNumVoices; ++i) {
+        auto* v = new Ym2612Voice();
+        v->setRegisterImage(imageFor(patch));
+        voices.push_back(v);
+        synth.addVoice(v);
+    }
+    synth.setCurrentPlaybackSampleRate(rate);
+
+    const int total = juce::roundToInt(kCaseSeconds * rate);
+    juce::AudioBuffer<float> out(2, total);
+    out.clear();
+
+    // Pre-sort events into absolute sample positions
+    std::vector<std::pair<int, Event>> timeline;
+    for (const auto& e : seq.events)
+        timeline.emplace_back(juce::roundToInt(e.time * rate), e);
+    std::stable_sort(timeline.begin(), timeline.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    size_t next = 0;
+    for (int pos = 0; pos < total; pos += blockSize) {
+        const int n = juce::jmin(blockSize, total - pos);
+        juce::MidiBuffer midi;
+
+        while (next < timeline.size() && timeline[next].first < pos + n) {
+            const auto& [at, e] = timeline[next++];
+            const int offset = at - pos;
+            if (e.type == Event::noteOn)
+                midi.addEvent(juce::MidiMessage::noteOn(1, e.note, juce::uint8(e.velocity)), offset);
+            else if (e.type == Event::noteOff)
+                midi.addEvent(juce::MidiMessage::noteOff(1, e.note), offset);
+            else {
+                // Mirrors pushParamsToVoices: the new image lands at the block start
+                for (auto* v : voices) v->setRegisterImage(imageFor(patch + 1));
+            }
+        }
+
+        juce::AudioBuffer<float> block(out.getArrayOfWritePointers(), 2, pos, n);
+        synth.renderNextBlock(block, midi, 0, n);
+    }
+    return out;
+}
+
+// ─── Fingerprint ─────────────────────────────────────────────────────────────
+struct Fingerprint {
+    uint64_t           hash = 0;
+    std::vector<float> windowDb;
+};
+
+static Fingerprint fingerprint(const juce::AudioBuffer<float>& buf, double rate)
+{
+    Fingerprint fp;
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (int i = 0; i < buf.getNumSamples(); ++i)
+        for (int c = 0; c < buf.getNumChannels(); ++c) {
+            uint32_t bits;
+            const float s = buf.getSample(c, i);
+            std::memcpy(&bits, &s, sizeof bits);
+            for (int b = 0; b < 4; ++b) {
+                h ^= (bits >> (8 * b)) & 0xFF;
+                h *= 0x100000001b3ull;
+            }
+        }
+    fp.hash = h;
+
+    const int window = juce::jmax(1, juce::roundToInt(kWindowSeconds * rate));
+    for (int start = 0; start < buf.getNumSamples(); start += window) {
+        const int n = juce::jmin(window, buf.getNumSamples() - start);
+        const float l   = buf.getRMSLevel(0, start, n);
+        const float r   = buf.getRMSLevel(1, start, n);
+        const float rms = std::sqrt(0.5f * (l * l + r * r));
+        fp.windowDb.push_back(std::round(juce::Decibels::gainToDecibels(rms, -120.0f) * 100.0f) / 100.0f);
+    }
+    return fp;
+}
+
+// ─── Golden file: one line per case ──────────────────────────────────────────
+//   <case-id> <hash hex> <n> <db_0> ... <db_n-1>
+static std::map<std::string, Fingerprint> loadGolden(const juce::File& file)
+{
+    std::map<std::string, Fingerprint> golden;
+    juce::StringArray lines;
+    file.readLines(lines);
+    for (const auto& line : lines) {
+        if (line.startsWith("#") || line.trim().isEmpty()) continue;
+        auto tok = juce::StringArray::fromTokens(line, " ", {});
+        if (tok.size() < 3) continue;
+        Fingerprint fp;
+        fp.hash = std::strtoull(tok[1].toRawUTF8(), nullptr, 16);
+        const int n = tok[2].getIntValue();
+        for (int i = 0; i < n && 3 + i < tok.size(); ++i)
+            fp.windowDb.push_back(tok[3 + i].getFloatValue());
+        golden[tok[0].toStdString()] = fp;
+    }
+    return golden;
+}
+
+static juce::String formatLine(const std::string& id, const Fingerprint& fp)
+{
+    juce::String s = juce::String(id) + " " + juce::String::toHexString((juce::int64) fp.hash).paddedLeft('0', 16)
+                   + " " + juce::String((int) fp.windowDb.size());
+    for (float db : fp.windowDb)
+        s << " " << juce::String(db, 2);
+    return s;
+}
+
+static juce::String caseId(const Sequence& seq, int patch, double rate, int block)
+{
+    return juce::String(seq.name) + "/" + juce::String(kBuiltInPatches[patch].name).replaceCharacter(' ', '_')
+         + "/" + juce::String(juce::roundToInt(rate)) + "/" + juce::String(block);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+int main(int argc, char** argv)
+{
+    bool         update  = false;
+    bool         rmsMode = false;
+    float        tolDb   = 0.5f;
+    juce::String goldenPath = ARM2612_GOLDEN_FILE, filter;
+    juce::File   dumpDir;
+
+    for (int i = 1; i < argc; ++i) {
+        const juce::String a = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if      (a == "--update")                 update     = true;
+        else if (a == "--mode"     && hasValue)   rmsMode    = (juce::String(argv[++i]) == "rms");
+        else if (a == "--tol-db"   && hasValue)   tolDb      = juce::String(argv[++i]).getFloatValue();
+        else if (a == "--golden"   && hasValue)   goldenPath = argv[++i];
+        else if (a == "--filter"   && hasValue)   filter     = argv[++i];
+        else if (a == "--dump-dir" && hasValue)   dumpDir    = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: arm2612-golden [--update] [--mode exact|rms] [--tol-db 0.5]\n"
+                                 "                      [--golden file] [--filter text] [--dump-dir dir]\n");
+            return 2;
+        }
+    }
+
+    const juce::File goldenFile = juce::File::getCurrentWorkingDirectory().getChildFile(goldenPath);
+    std::map<std::string, Fingerprint> golden;
+    if (!update) {
+        if (!goldenFile.existsAsFile()) {
+            std::fprintf(stderr, "no golden file at %s – run with --update first\n",
+                         goldenFile.getFullPathName().toRawUTF8());
+            return 2;
+        }
+        golden = loadGolden(goldenFile);
+    }
+    if (dumpDir != juce::File())
+        dumpDir.createDirectory();
+
+    juce::StringArray newLines { "# arm2612-golden – regenerate with: arm2612-golden --update" };
+    int failures = 0, checked = 0;
+
+    for (const auto& seq : makeSequences())
+        for (int p = 0; p < kNumBuiltInPatches; ++p)
+            for (double rate : kRates)
+                for (int block : kBlockSizes) {
+                    const auto id = caseId(seq, p, rate, block);
+                    if (filter.isNotEmpty() && !id.contains(filter)) continue;
+
+                    const auto audio = renderCase(seq, p, rate, block);
+                    const auto fp    = fingerprint(audio, rate);
+                    newLines.add(formatLine(id.toStdString(), fp));
+                    ++checked;
+
+                    if (dumpDir != juce::File()) {
+                        std::vector<float> inter(size_t(audio.getNumSamples()) * 2);
+                        for (int i = 0; i < audio.getNumSamples(); ++i)
+                            for (int c = 0; c < 2; ++c)
+                                inter[size_t(i * 2 + c)] = audio.getSample(c, i);
+                        WavWriter::write16(dumpDir.getChildFile(id.replaceCharacter('/', '_') + ".wav")
+                                               .getFullPathName().toStdString(),
+                                           inter, 2, uint32_t(rate + 0.5));
+                    }
+                    if (update) continue;
+
+                    const auto it = golden.find(id.toStdString());
+                    juce::String problem;
+                    if (it == golden.end()) {
+                        problem = "missing from golden file";
+                    } else if (!rmsMode) {
+                        if (it->second.hash != fp.hash) problem = "hash differs";
+                    } else if (it->second.windowDb.size() != fp.windowDb.size()) {
+                        problem = "length differs";
+                    } else {
+                        float worst = 0.0f;
+                        for (size_t w = 0; w < fp.windowDb.size(); ++w)
+                            worst = juce::jmax(worst, std::abs(fp.windowDb[w] - it->second.windowDb[w]));
+                        if (worst > tolDb) problem = "window level off by " + juce::String(worst, 2) + " dB";
+                    }
+                    if (problem.isNotEmpty()) {
+                        ++failures;
+                        std::printf("FAIL %s: %s\n", id.toRawUTF8(), problem.toRawUTF8());
+                    }
+                }
+
+    if (update) {
+        goldenFile.getParentDirectory().createDirectory();
+        if (!goldenFile.replaceWithText(newLines.joinIntoString("\n") + "\n")) {
+            std::fprintf(stderr, "could not write %s\n", goldenFile.getFullPathName().toRawUTF8());
+            return 2;
+        }
+        std::printf("wrote %d cases to %s\n", checked, goldenFile.getFullPathName().toRawUTF8());
+        return 0;
+    }
+
+    std::printf("%d/%d cases pass (%s mode)\n", checked - failures, checked, rmsMode ? "rms" : "exact");
+    return failures == 0 ? 0 : 1;
+}
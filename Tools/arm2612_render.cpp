@@ -0,0 +1,94 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// arm2612-render  –  render one note of a built-in patch to a WAV file
+//
+//   arm2612-render [--patch N|name] [--note 60] [--velocity 1.0]
+//                  [--hold 1.0] [--rate 53267] [--mono] out.wav
+//
+// Uses the same Ym2612Engine as the plugin voices. --hold is the key-down
+// time in seconds; the patch's release tail is rendered after it.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Ym2612Engine.h"
+#include "PatchCompiler.h"
+#include "WavWriter.h"
+
+static void usage()
+{
+    std::fprintf(stderr,
+        "usage: arm2612-render [--patch N|name] [--note 60] [--velocity 1.0]\n"
+        "                      [--hold 1.0] [--rate 53267] [--mono] out.wav\n\n"
+        "patches:\n");
+    for (int i = 0; i < kNumBuiltInPatches; ++i)
+        std::fprintf(stderr, "  %d  %s\n", i, kBuiltInPatches[i].name);
+}
+
+static int findPatch(const std::string& s)
+{
+    for (int i = 0; i < kNumBuiltInPatches; ++i)
+        if (s == kBuiltInPatches[i].name) return i;
+    char* end = nullptr;
+    const long n = std::strtol(s.c_str(), &end, 10);
+    if (end != s.c_str() && *end == '\0' && n >= 0 && n < kNumBuiltInPatches) return int(n);
+    return -1;
+}
+
+int main(int argc, char** argv)
+{
+    int         patch    = 0;
+    int         note     = 60;
+    float       velocity = 1.0f;
+    double      hold     = 1.0;
+    double      rate     = Ym2612Engine::CHIP_RATE;
+    int         channels = 2;
+    std::string outPath;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if      (a == "--patch"    && hasValue) patch    = findPatch(argv[++i]);
+        else if (a == "--note"     && hasValue) note     = std::atoi(argv[++i]);
+        else if (a == "--velocity" && hasValue) velocity = float(std::atof(argv[++i]));
+        else if (a == "--hold"     && hasValue) hold     = std::atof(argv[++i]);
+        else if (a == "--rate"     && hasValue) rate     = std::atof(argv[++i]);
+        else if (a == "--mono")                 channels = 1;
+        else if (!a.empty() && a[0] != '-')     outPath  = a;
+        else { usage(); return 2; }
+    }
+    if (outPath.empty() || patch < 0 || rate <= 0.0 || hold < 0.0) { usage(); return 2; }
+
+    const PatchEntry& e = kBuiltInPatches[patch];
+    Ym2612Engine engine;
+    engine.setRegisterImage(compilePatch(*e.patch, e.block, e.lfoFreq));
+
+    const int holdSamples = int(hold * rate);
+    const int tailSamples = int(engine.getTailSeconds() * rate) + 1;
+    const int total       = holdSamples + tailSamples;
+
+    std::vector<float> planar(size_t(total) * size_t(channels), 0.0f);
+    float* dst[2] = { planar.data(), channels == 2 ? planar.data() + total : nullptr };
+
+    engine.startNote(note, rate, channels);
+    engine.render(dst, holdSamples, velocity);
+    engine.stopNote();
+    float* tail[2] = { dst[0] + holdSamples, dst[1] ? dst[1] + holdSamples : nullptr };
+    engine.render(tail, tailSamples, velocity);
+
+    std::vector<float> interleaved(planar.size());
+    for (int i = 0; i < total; ++i)
+        for (int c = 0; c < channels; ++c)
+            interleaved[size_t(i * channels + c)] = planar[size_t(c * total + i)];
+
+    if (!WavWriter::write16(outPath, interleaved, channels, uint32_t(rate + 0.5))) {
+        std::fprintf(stderr, "could not write %s\n", outPath.c_str());
+        return 1;
+    }
+    std::printf("%s: \"%s\" note %d, %d samples @ %.0f Hz\n",
+                outPath.c_str(), e.name, note, total, rate);
+    return 0;
+}
@@ -0,0 +1,152 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// arm2612-rtcheck  –  real-time safety check of the plugin's processBlock
+//
+//   arm2612-rtcheck [--strict] [--quick] [--seconds 0.5] [--no-ui-thread]
+//
+// Runs the real ARM2612AudioProcessor over every built-in program, every
+// StressMidi scenario, several host rates and block sizes. Each processBlock
+// call (and the host-style automation before it) runs inside an
+// RtCheck::ScopedAudioThread, so any allocation, free or blocked mutex on
+// that path is a violation and is printed with a stack trace.
+//
+// A second thread plays the part of the UI meanwhile: it plays the on-screen
+// keyboard and moves parameters, so locks shared with the message thread
+// actually get contended. --strict also fails uncontended lock acquisitions.
+//
+// Exit code 0 = clean, 1 = violations, 2 = usage.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include "PluginProcessor.h"
+#include "RtCheck.h"
+#include "StressMidi.h"
+
+static constexpr double kRates[]      = { 44100.0, 48000.0, Ym2612Voice::CHIP_RATE, 96000.0 };
+static constexpr int    kBlockSizes[] = { 16, 128, 1024 };
+
+// Fake UI: on-screen keyboard and knob moves from another thread
+class UiThread
+{
+public:
+    explicit UiThread(ARM2612AudioProcessor& p) : processor(p) {}
+    ~UiThread() { stop(); }
+
+    void start() { running = true; thread = std::thread([this] { run(); }); }
+    void stop()  { running = false; if (thread.joinable()) thread.join(); }
+
+private:
+    void run()
+    {
+        juce::Random r(7);
+        auto& keyboard = processor.getMidiKeyboardState();
+        while (running) {
+            const int note = 48 + r.nextInt(24);
+            keyboard.noteOn(1, note, 0.8f);
+            if (auto* p = processor.apvts.getParameter(OP_TL_ID[r.nextInt(4)]))
+                p->setValueNotifyingHost(r.nextFloat());
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            keyboard.noteOff(1, note, 0.0f);
+            processor.updateKeyboardDisplay();
+        }
+    }
+
+    ARM2612AudioProcessor& processor;
+    std::atomic<bool>      running { false };
+    std::thread            thread;
+};
+
+static void usage()
+{
+    std::fprintf(stderr, "usage: arm2612-rtcheck [--strict] [--quick] [--seconds 0.5] [--no-ui-thread]\n");
+}
+
+int main(int argc, char** argv)
+{
+    bool   strict   = false;
+    bool   quick    = false;
+    bool   uiThread = true;
+    double seconds  = 0.5;
+
+    for (int i = 1; i < argc; ++i) {
+        const juce::String a = argv[i];
+        if      (a == "--strict")                      strict   = true;
+        else if (a == "--quick")                       quick    = true;
+        else if (a == "--no-ui-thread")                uiThread = false;
+        else if (a == "--seconds" && i + 1 < argc)     seconds  = juce::String(argv[++i]).getDoubleValue();
+        else { usage(); return 2; }
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    RtCheck::prime();
+    RtCheck::setStrictLocks(strict);
+
+    ARM2612AudioProcessor processor;
+    const int numPrograms = quick ? 2 : kNumBuiltInPatches;
+    int       numCases    = 0;
+    uint64_t  numBlocks   = 0;
+
+    for (double rate : kRates) {
+        for (int blockSize : kBlockSizes) {
+            if (quick && blockSize != 128) continue;
+
+            processor.setRateAndBufferSizeDetails(rate, blockSize);
+            processor.prepareToPlay(rate, blockSize);
+
+            juce::AudioBuffer<float> buffer(2, blockSize);
+            juce::MidiBuffer         midi;
+            midi.ensureSize(8192);
+
+            for (int program = 0; program < numPrograms; ++program) {
+                for (const auto& scenario : StressMidi::scenarios()) {
+                    processor.setCurrentProgram(program);
+                    StressMidi::Generator gen(scenario.kind, rate, numPrograms);
+
+                    UiThread ui(processor);
+                    if (uiThread) ui.start();
+
+                    const auto before = RtCheck::violations();
+                    const int  blocks = juce::roundToInt(seconds * rate / blockSize);
+                    for (int b = 0; b < blocks; ++b) {
+                        midi.clear();
+                        gen.fill(midi, juce::int64(b) * blockSize, blockSize);
+                        {
+                            RtCheck::ScopedAudioThread audio;
+                            if (gen.automates()) gen.automate(processor, b);
+                            processor.processBlock(buffer, midi);
+                        }
+                        // Let AsyncUpdater work (program sync) happen like on a message thread
+                        if (scenario.kind == StressMidi::Kind::programs)
+                            juce::MessageManager::getInstance()->runDispatchLoopUntil(1);
+                    }
+
+                    ui.stop();
+                    ++numCases;
+                    numBlocks += uint64_t(blocks);
+
+                    if (RtCheck::violations() != before)
+                        std::printf("FAIL  %-10s program %2d  %6.0f Hz  block %4d  (%llu new violations)\n",
+                                    scenario.name, program, rate, blockSize,
+                                    (unsigned long long) (RtCheck::violations() - before));
+                }
+            }
+            processor.releaseResources();
+        }
+    }
+
+    const auto c = RtCheck::counts();
+    std::printf("\n%d cases, %llu blocks: %llu allocations, %llu frees, %llu blocked locks, "
+                "%llu uncontended locks%s\n",
+                numCases, (unsigned long long) numBlocks,
+                (unsigned long long) c.allocations, (unsigned long long) c.deallocations,
+                (unsigned long long) c.contendedLocks, (unsigned long long) c.locks,
+                strict ? " (strict: counted as violations)" : "");
+
+    const bool ok = RtCheck::violations() == 0;
+    std::printf("%s\n", ok ? "OK – audio thread is real-time safe" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// arm2612-stress  –  worst-case processBlock time under dense MIDI
+//
+//   arm2612-stress [--rate 48000] [--seconds 5] [--program 0]
+//                  [--blocks 32,64,...] [--budget 70] [--out stress.csv]
+//
+// Drives the real ARM2612AudioProcessor with every StressMidi scenario
+// (chords, voice stealing, retriggers, program changes, per-block host
+// automation) at each block size, and times every processBlock call. The
+// report is the distribution of block times against the real-time deadline
+// (blockSize / rate): p50, p99, p99.9, max, and the number of blocks that
+// overran. Averages hide dropouts; the max column is the one that matters.
+//
+// The first 8 blocks of each run are warm-up and not counted. --budget N
+// exits 1 when any worst block exceeds N % of its deadline. --out writes
+// the same rows as CSV.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "PluginProcessor.h"
+#include "StressMidi.h"
+
+using Clock = std::chrono::steady_clock;
+
+static const std::vector<int> kDefaultBlockSizes = { 32, 64, 128, 256, 512, 1024, 2048 };
+static constexpr int kWarmupBlocks = 8;
+
+struct Settings {
+    double           rate    = 48000.0;
+    double           seconds = 5.0;
+    int              program = 0;
+    std::vector<int> blockSizes = kDefaultBlockSizes;
+    double           budgetPercent = 0.0;   // 0 = report only
+    juce::String     outPath;
+};
+
+struct Row {
+    const char* scenario;
+    int         block;
+    double      deadlineUs;
+    double      p50Us, p90Us, p99Us, p999Us, maxUs;
+    int         overruns;
+    int         blocks;
+};
+
+// v is reordered
+static double percentile(std::vector<double>& v, double p)
+{
+    const size_t k = std::min(v.size() - 1, size_t(p * double(v.size() - 1) + 0.5));
+    std::nth_element(v.begin(), v.begin() + long(k), v.end());
+    return v[k];
+}
+
+static Row runScenario(ARM2612AudioProcessor& processor, const Settings& s,
+                       const StressMidi::Scenario& scenario, int blockSize)
+{
+    processor.setCurrentProgram(s.program);
+    processor.setRateAndBufferSizeDetails(s.rate, blockSize);
+    processor.prepareToPlay(s.rate, blockSize);
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer         midi;
+    midi.ensureSize(8192);
+
+    StressMidi::Generator gen(scenario.kind, s.rate, kNumBuiltInPatches);
+    const int numBlocks = kWarmupBlocks + std::max(1, juce::roundToInt(s.seconds * s.rate / blockSize));
+
+    std::vector<double> us;
+    us.reserve(size_t(numBlocks));
+
+    for (int b = 0; b < numBlocks; ++b) {
+        midi.clear();
+        gen.fill(midi, juce::int64(b) * blockSize, blockSize);
+
+        // Host automation happens on the audio thread, so it is timed too
+        const auto t0 = Clock::now();
+        if (gen.automates()) gen.automate(processor, b);
+        processor.processBlock(buffer, midi);
+        const auto t1 = Clock::now();
+
+        if (b >= kWarmupBlocks)
+            us.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+
+        // Deliver the program-change AsyncUpdater between blocks, as a host would
+        if (scenario.kind == StressMidi::Kind::programs)
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(0);
+    }
+    processor.releaseResources();
+
+    Row r;
+    r.scenario   = scenario.name;
+    r.block      = blockSize;
+    r.deadlineUs = 1.0e6 * blockSize / s.rate;
+    r.blocks     = int(us.size());
+    r.overruns   = int(std::count_if(us.begin(), us.end(), [&](double t) { return t > r.deadlineUs; }));
+    r.maxUs      = *std::max_element(us.begin(), us.end());
+    r.p50Us      = percentile(us, 0.50);
+    r.p90Us      = percentile(us, 0.90);
+    r.p99Us      = percentile(us, 0.99);
+    r.p999Us     = percentile(us, 0.999);
+    return r;
+}
+
+static bool writeCsv(const juce::String& path, const Settings& s, const std::vector<Row>& rows)
+{
+    FILE* f = std::fopen(path.toRawUTF8(), "w");
+    if (f == nullptr) return false;
+    std::fprintf(f, "scenario,rate,block,blocks,deadline_us,p50_us,p90_us,p99_us,p999_us,max_us,max_pct,overruns\n");
+    for (const auto& r : rows)
+        std::fprintf(f, "%s,%.0f,%d,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.1f,%d\n",
+                     r.scenario, s.rate, r.block, r.blocks, r.deadlineUs,
+                     r.p50Us, r.p90Us, r.p99Us, r.p999Us, r.maxUs,
+                     100.0 * r.maxUs / r.deadlineUs, r.overruns);
+    std::fclose(f);
+    return true;
+}
+
+static void usage()
+{
+    std::fprintf(stderr,
+        "usage: arm2612-stress [--rate 48000] [--seconds 5] [--program 0]\n"
+        "                      [--blocks 32,64,...] [--budget 70] [--out stress.csv]\n");
+}
+
+int main(int argc, char** argv)
+{
+    Settings s;
+    for (int i = 1; i < argc; ++i) {
+        const juce::String a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if      (a == "--rate"    && hasValue) s.rate          = juce::String(argv[++i]).getDoubleValue();
+        else if (a == "--seconds" && hasValue) s.seconds       = juce::String(argv[++i]).getDoubleValue();
+        else if (a == "--program" && hasValue) s.program       = juce::String(argv[++i]).getIntValue();
+        else if (a == "--budget"  && hasValue) s.budgetPercent = juce::String(argv[++i]).getDoubleValue();
+        else if (a == "--out"     && hasValue) s.outPath       = argv[++i];
+        else if (a == "--blocks"  && hasValue) {
+            s.blockSizes.clear();
+            for (const auto& t : juce::StringArray::fromTokens(argv[++i], ",", ""))
+                if (t.getIntValue() > 0) s.blockSizes.push_back(t.getIntValue());
+        }
+        else { usage(); return 2; }
+    }
+    if (s.rate <= 0.0 || s.seconds <= 0.0 || s.blockSizes.empty()
+        || s.program < 0 || s.program >= kNumBuiltInPatches) { usage(); return 2; }
+
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    ARM2612AudioProcessor processor;
+
+    std::printf("arm2612-stress  %.0f Hz, %.1f s per run, program %d (%s)\n\n",
+                s.rate, s.seconds, s.program, kBuiltInPatches[s.program].name);
+    std::printf("%-10s %6s %9s %8s %8s %8s %8s %8s %7s %8s\n",
+                "scenario", "block", "deadline", "p50", "p90", "p99", "p99.9", "max", "max%", "overruns");
+
+    std::vector<Row> rows;
+    for (int blockSize : s.blockSizes) {
+        for (const auto& scenario : StressMidi::scenarios()) {
+            const Row r = runScenario(processor, s, scenario, blockSize);
+            std::printf("%-10s %6d %7.1fus %6.1fus %6.1fus %6.1fus %6.1fus %6.1fus %6.1f%% %8d\n",
+                        r.scenario, r.block, r.deadlineUs, r.p50Us, r.p90Us, r.p99Us, r.p999Us,
+                        r.maxUs, 100.0 * r.maxUs / r.deadlineUs, r.overruns);
+            rows.push_back(r);
+        }
+        std::printf("\n");
+    }
+
+    // Worst block per block size, across scenarios
+    bool overBudget = false;
+    std::printf("worst case per block size:\n");
+    for (int blockSize : s.blockSizes) {
+        const Row* worst = nullptr;
+        for (const auto& r : rows)
+            if (r.block == blockSize && (worst == nullptr || r.maxUs / r.deadlineUs > worst->maxUs / worst->deadlineUs))
+                worst = &r;
+        const double pct = 100.0 * worst->maxUs / worst->deadlineUs;
+        const bool   bad = s.budgetPercent > 0.0 && pct > s.budgetPercent;
+        overBudget = overBudget || bad;
+        std::printf("  %5d  %6.1fus of %7.1fus  (%5.1f%%, %s)%s\n",
+                    blockSize, worst->maxUs, worst->deadlineUs, pct, worst->scenario,
+                    bad ? "  OVER BUDGET" : "");
+    }
+
+    if (s.outPath.isNotEmpty() && !writeCsv(s.outPath, s, rows)) {
+        std::fprintf(stderr, "cannot write %s\n", s.outPath.toRawUTF8());
+        return 2;
+    }
+    return overBudget ? 1 : 0;
+}
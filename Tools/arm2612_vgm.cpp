@@ -0,0 +1,124 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// arm2612-vgm  –  play the YM2612 part of a .vgm / .vgz log into a WAV file
+//
+//   arm2612-vgm [--loops 0] [--rate 53267] [--info] song.vgz out.wav
+//
+// The log is streamed (memory-mapped .vgm, incrementally inflated .vgz) and
+// rendered as fast as possible at the chip's rate. --rate converts the
+// output with linear interpolation; leave it at the chip rate for the
+// untouched chip samples. --loops plays the loop section that many extra
+// times. Other chips in the file (PSG etc.) are silent.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "VgmPlayer.h"
+#include "WavWriter.h"
+
+static void usage()
+{
+    std::fprintf(stderr, "usage: arm2612-vgm [--loops 0] [--rate 53267] [--info] song.vgm|song.vgz out.wav\n");
+}
+
+int main(int argc, char** argv)
+{
+    int         loops    = 0;
+    double      rate     = 0.0;   // 0 = chip rate
+    bool        infoOnly = false;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if      (a == "--loops" && hasValue) loops    = std::atoi(argv[++i]);
+        else if (a == "--rate"  && hasValue) rate     = std::atof(argv[++i]);
+        else if (a == "--info")              infoOnly = true;
+        else if (!a.empty() && a[0] != '-')  paths.push_back(a);
+        else { usage(); return 2; }
+    }
+    if (paths.size() != (infoOnly ? 1u : 2u) || loops < 0 || rate < 0.0) { usage(); return 2; }
+
+    std::string error;
+    auto source = openVgmFile(paths[0], error);
+    VgmPlayer player;
+    if (source == nullptr || !player.open(std::move(source), error)) {
+        std::fprintf(stderr, "%s: %s\n", paths[0].c_str(), error.c_str());
+        return 1;
+    }
+    player.setLoopCount(loops);
+
+    const auto& info = player.info();
+    std::printf("VGM %x.%02x  YM2612 %u Hz (chip rate %u)  %.2f s%s\n",
+                info.version >> 8, info.version & 0xFF, info.ym2612Clock, player.chipRate(),
+                double(info.totalSamples) / VgmPlayer::kVgmRate,
+                info.hasLoop() ? ", loops" : "");
+    if (infoOnly) return 0;
+
+    const double   chipRate = player.chipRate();
+    const uint32_t outRate  = rate > 0.0 ? uint32_t(rate) : player.chipRate();
+    const double   step     = chipRate / outRate;   // chip samples per output sample
+
+    WavWriter::Stream wav;
+    if (!wav.open(paths[1], 2, outRate)) {
+        std::fprintf(stderr, "cannot write %s\n", paths[1].c_str());
+        return 1;
+    }
+
+    constexpr int kChunk = 4096;
+    std::vector<float> left(kChunk + 1), right(kChunk + 1), interleaved;
+    interleaved.reserve(size_t(kChunk) * 2 * 4);
+
+    // Linear conversion state: the last chip frame of the previous chunk sits
+    // at index 0 so interpolation is continuous across chunk boundaries.
+    double pos     = 0.0;
+    int    carried = 0;
+    uint64_t frames = 0;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (;;) {
+        std::fill(left.begin() + carried, left.end(), 0.0f);
+        std::fill(right.begin() + carried, right.end(), 0.0f);
+        const int got   = player.render(left.data() + carried, right.data() + carried, kChunk);
+        const int avail = carried + got;
+        if (got == 0) break;
+
+        interleaved.clear();
+        if (step == 1.0) {
+            for (int i = carried; i < avail; ++i) { interleaved.push_back(left[i]); interleaved.push_back(right[i]); }
+        } else {
+            for (; pos + 1.0 < avail; pos += step) {
+                const int   i = int(pos);
+                const float f = float(pos - i);
+                interleaved.push_back(left[i]  + (left[i + 1]  - left[i])  * f);
+                interleaved.push_back(right[i] + (right[i + 1] - right[i]) * f);
+            }
+            left[0] = left[avail - 1];
+            right[0] = right[avail - 1];
+            pos -= avail - 1;
+            carried = 1;
+        }
+
+        frames += interleaved.size() / 2;
+        if (!wav.write(interleaved.data(), interleaved.size() / 2)) {
+            std::fprintf(stderr, "write failed: %s\n", paths[1].c_str());
+            return 1;
+        }
+        if (got < kChunk) break;
+    }
+
+    if (!wav.close()) {
+        std::fprintf(stderr, "write failed: %s\n", paths[1].c_str());
+        return 1;
+    }
+
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const double audio = double(frames) / outRate;
+    std::printf("%s: %.2f s at %u Hz in %.2f s (%.0fx realtime)\n",
+                paths[1].c_str(), audio, outRate, secs, secs > 0.0 ? audio / secs : 0.0);
+    return 0;
+}
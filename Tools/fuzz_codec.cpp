@@ -0,0 +1,263 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// arm2612-fuzz-<ext>  –  fuzz target for one patch or bank codec (ARM2612_FUZZ_CODEC)
+//
+//   arm2612-fuzz-dmp [--iterations N] [--seed S] [file ...]
+//
+// Every input that decodes is encoded, decoded and encoded again. The two
+// decodes must agree on every voice's patch and octave offset and the two
+// encodes must be byte-identical; anything else aborts. Built with
+// -DARM2612_FUZZ_LIBFUZZER=ON (clang) this is a libFuzzer target; otherwise
+// the main() below replays the files given, then feeds random bytes and
+// byte-flipped copies of those files and of the built-in patches. Run under ASan/UBSan to
+// catch out-of-bounds reads as well. Read-only banks (.fur) take their
+// round trip through the test writer of their reader instead. Furnace macro
+// blocks must survive the round trip too, and are compiled and played for a
+// few ticks. Before fuzzing, a fixed DT macro and the patch compiler are
+// checked against the chip's detune encoding.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "FurModule.h"
+#include "MacroProgram.h"
+#include "PatchCodec.h"
+#include "PatchCompiler.h"
+#include "VgmCapture.h"
+
+#ifndef ARM2612_FUZZ_CODEC
+ #error "ARM2612_FUZZ_CODEC must name a codec extension"
+#endif
+
+// The codec under test, single-instrument or bank, as decode-to-list and
+// encode-from-list so both kinds share the round-trip check
+struct Target {
+    const char* extension;
+    bool (*decode)(const uint8_t*, size_t, std::vector<PatchData>&);
+    std::vector<uint8_t> (*encode)(const std::vector<PatchData>&);
+};
+
+static const PatchCodec*     singleCodec() { return PatchCodecs::forExtension(ARM2612_FUZZ_CODEC); }
+static const PatchBankCodec* bankCodec()   { return PatchCodecs::bankForExtension(ARM2612_FUZZ_CODEC); }
+
+static std::vector<uint8_t> writeFur(const std::vector<PatchData>& voices)
+{
+    return FurModule::writeSkeleton(voices, false);
+}
+
+static const Target& target()
+{
+    static const Target t = [] {
+        if (singleCodec() != nullptr)
+            return Target { singleCodec()->extension,
+                [](const uint8_t* data, size_t size, std::vector<PatchData>& out) {
+                    out.resize(1);
+                    return singleCodec()->decode(data, size, out[0]);
+                },
+                [](const std::vector<PatchData>& in) { return singleCodec()->encode(in.at(0)); } };
+        if (bankCodec() != nullptr && bankCodec()->encode == nullptr && bankCodec()->format != PatchIndex::Format::fur) {
+            std::fprintf(stderr, "no writer for '%s'\n", ARM2612_FUZZ_CODEC);
+            std::abort();
+        }
+        if (bankCodec() != nullptr)
+            return Target { bankCodec()->extension,
+                [](const uint8_t* data, size_t size, std::vector<PatchData>& out) {
+                    out.clear();
+                    return bankCodec()->decode(data, size, [&](const PatchData& v) {
+                        out.push_back(v);
+                        return true;
+                    }) >= 0;
+                },
+                bankCodec()->encode != nullptr ? bankCodec()->encode : writeFur };
+        std::fprintf(stderr, "unknown codec '%s'\n", ARM2612_FUZZ_CODEC);
+        std::abort();
+    }();
+    return t;
+}
+
+static bool samePatch(const YM2612Patch& a, const YM2612Patch& b)
+{
+    if (a.ALG != b.ALG || a.FB != b.FB || a.AMS != b.AMS || a.FMS != b.FMS) return false;
+    for (int i = 0; i < 4; ++i) {
+        const auto& x = a.op[i];
+        const auto& y = b.op[i];
+        if (x.DT != y.DT || x.MUL != y.MUL || x.TL != y.TL || x.RS != y.RS || x.AR != y.AR
+            || x.AM != y.AM || x.DR != y.DR || x.SR != y.SR || x.SL != y.SL || x.RR != y.RR
+            || x.SSG != y.SSG)
+            return false;
+    }
+    return true;
+}
+
+static void fail(const char* what)
+{
+    std::fprintf(stderr, "%s codec: %s\n", target().extension, what);
+    std::abort();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    std::vector<PatchData> first;
+    if (!target().decode(data, size, first)) return 0;
+
+    const auto bytes = target().encode(first);
+    std::vector<PatchData> second;
+    if (!target().decode(bytes.data(), bytes.size(), second))  fail("cannot read its own output");
+    if (first.size() != second.size())                         fail("voice count changed in a round trip");
+    for (size_t i = 0; i < first.size(); ++i) {
+        if (!samePatch(first[i].patch, second[i].patch))       fail("patch changed in a round trip");
+        if (first[i].block != second[i].block)                 fail("octave offset changed in a round trip");
+        if (first[i].macros != second[i].macros)               fail("macros changed in a round trip");
+    }
+    if (target().encode(second) != bytes)                      fail("second encode differs");
+
+    static MacroProgram program;
+    for (const auto& voice : first) {
+        if (voice.macros.empty()) continue;
+        program.compile(voice.macros.data(), voice.macros.size());
+        Ym2612Engine engine;
+        MacroPlayer  player;
+        engine.startNote(60, 44100.0, 2);
+        player.start(&program, 60);
+        for (int t = 0; t < 300; ++t) {
+            if (t == 200) player.release();
+            player.tick(engine);
+        }
+    }
+    return 0;
+}
+
+#ifndef ARM2612_FUZZ_LIBFUZZER
+
+static void runOne(const std::vector<uint8_t>& input)
+{
+    // A fresh heap copy of exactly the input size, so ASan sees overreads
+    std::unique_ptr<uint8_t[]> copy(new uint8_t[input.empty() ? 1 : input.size()]);
+    if (!input.empty()) std::memcpy(copy.get(), input.data(), input.size());
+    LLVMFuzzerTestOneInput(copy.get(), input.size());
+}
+
+// An OP1 DT macro 0, 3, 6 (Furnace: -3, none, +3) must reach register 0x30
+// bits 4-6 as the chip's sign-magnitude detune 7, 0, 3, and the patch
+// compiler must write every DT the way the codecs do
+static void checkDetuneMacro()
+{
+    YM2612Patch patch = *kBuiltInPatches[0].patch;
+    for (int dt = -3; dt <= 3; ++dt) {
+        patch.op[0].DT = dt;
+        uint8_t r[7];
+        PatchCodecs::opToRegisters(patch.op[0], r);
+        if (compilePatch(patch, 0, 0).op[0][0] != r[0]) fail("compilePatch and the codecs disagree on DT");
+    }
+
+    const uint8_t features[] = { 'O', '1', 14, 0,
+                                 8, 0,                          // header length
+                                 9, 3, 255, 255, 0, 0, 0, 1,    // DT, 3 steps, no loop / release
+                                 0, 3, 6,
+                                 255 };
+    static MacroProgram program;
+    if (program.compile(features, sizeof(features)) != 1) fail("DT macro not compiled");
+
+    VgmCapture capture;
+    capture.start();
+    capture.beginBlock(1);
+    Ym2612Engine engine;
+    engine.setCapture(&capture, 0);
+    engine.setRegisterImage(compilePatch(*kBuiltInPatches[0].patch, 0, 0));
+    engine.startNote(60, 44100.0, 2);
+
+    MacroPlayer player;
+    player.start(&program, 60);
+    int reg30 = -1;
+    for (const int expected : { 7, 0, 3 }) {
+        player.tick(engine);
+        capture.flush();
+        VgmCapture::Write w;
+        while (capture.pop(w))
+            if (w.port == 0 && w.reg == 0x30) reg30 = w.value;
+        if (reg30 < 0 || ((reg30 >> 4) & 7) != expected) fail("DT macro wrote the wrong detune");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    long     iterations = 200000;
+    uint32_t seed       = 2612;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a == "--iterations" && i + 1 < argc)  iterations = std::atol(argv[++i]);
+        else if (a == "--seed" && i + 1 < argc)   seed = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+        else if (a == "--help" || a == "-h") {
+            std::printf("usage: %s [--iterations N] [--seed S] [file ...]\n", argv[0]);
+            return 0;
+        }
+        else files.push_back(a);
+    }
+
+    checkDetuneMacro();
+
+    // Seeds: the files given, every built-in patch in this format, with a
+    // name; for banks also all of them in one bank
+    std::vector<std::vector<uint8_t>> seeds;
+    for (const auto& f : files) {
+        std::ifstream in(f, std::ios::binary);
+        if (!in) { std::fprintf(stderr, "cannot open %s\n", f.c_str()); return 1; }
+        seeds.emplace_back(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        runOne(seeds.back());
+    }
+
+    std::vector<PatchData> all;
+    for (const auto& e : kBuiltInPatches) {
+        PatchData d;
+        d.name  = e.name;
+        d.patch = *e.patch;
+        d.block = e.block;
+        all.push_back(d);
+        seeds.push_back(target().encode({ d }));
+    }
+    if (bankCodec() != nullptr) seeds.push_back(target().encode(all));
+    if (bankCodec() != nullptr && bankCodec()->format == PatchIndex::Format::fur) {
+        seeds.push_back(FurModule::writeSkeleton(all, true));           // zlib, when built with it
+        seeds.push_back(FurModule::writeSkeleton({ all.front() }, true));
+    }
+
+    std::mt19937 rng(seed);
+    long decoded = 0;
+    for (long n = 0; n < iterations; ++n) {
+        std::vector<uint8_t> input;
+        if (n % 4 == 0) {
+            // Random bytes, mostly around the sizes the formats use
+            input.resize(rng() % 160);
+            for (auto& b : input) b = uint8_t(rng());
+        } else {
+            input = seeds[rng() % seeds.size()];
+            const int flips = 1 + int(rng() % 4);
+            for (int k = 0; k < flips && !input.empty(); ++k)
+                input[rng() % input.size()] = uint8_t(rng());
+            switch (rng() % 8) {
+                case 0: input.resize(rng() % (input.size() + 1)); break;            // truncate
+                case 1: input.resize(input.size() + 1 + rng() % 8, uint8_t(rng())); break;   // extend
+                default: break;
+            }
+        }
+        std::vector<PatchData> probe;
+        if (target().decode(input.data(), input.size(), probe)) ++decoded;
+        runOne(input);
+    }
+
+    std::printf("%s: %zu file(s), %ld inputs, %ld decoded, no failures\n",
+                target().extension, files.size(), iterations, decoded);
+    return 0;
+}
+
+#endif
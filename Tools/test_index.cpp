@@ -0,0 +1,223 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// arm2612-test-index  –  PatchIndex regression checks (registered with ctest)
+//
+//   arm2612-test-index
+//
+// Builds an index in memory and reads it back through PatchIndex::View:
+//   - round trip: entries, names, paths, patches, register images and the
+//     failed-file section come back as written
+//   - truncation: every shorter prefix of the file, and a file whose string
+//     references point past the table, is rejected on open
+//   - dedup: patches that differ only where canonicalImage() says the chip
+//     cannot hear it share one record; audible differences do not
+// Prints each failed check and exits non-zero if there was one.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "BuiltInPatches.h"
+#include "PatchCompiler.h"
+#include "PatchIndex.h"
+
+static int g_failures = 0;
+
+static void check(bool ok, const char* what)
+{
+    if (ok) return;
+    std::fprintf(stderr, "FAIL: %s\n", what);
+    ++g_failures;
+}
+
+static bool samePatch(const YM2612Patch& a, const YM2612Patch& b)
+{
+    if (a.ALG != b.ALG || a.FB != b.FB || a.AMS != b.AMS || a.FMS != b.FMS) return false;
+    for (int i = 0; i < 4; ++i) {
+        const auto& x = a.op[i];
+        const auto& y = b.op[i];
+        if (x.DT != y.DT || x.MUL != y.MUL || x.TL != y.TL || x.RS != y.RS || x.AR != y.AR
+            || x.AM != y.AM || x.DR != y.DR || x.SR != y.SR || x.SL != y.SL || x.RR != y.RR
+            || x.SSG != y.SSG)
+            return false;
+    }
+    return true;
+}
+
+static PatchIndex::Entry fileEntry(int64_t mtimeMs, uint64_t size, PatchIndex::Format format)
+{
+    PatchIndex::Entry e {};
+    e.mtimeMs     = mtimeMs;
+    e.fileSize    = size;
+    e.contentHash = uint64_t(mtimeMs) * 31 + size;
+    e.format      = format;
+    return e;
+}
+
+static PatchIndex::Record record(const PatchEntry& p)
+{
+    PatchIndex::Record r {};
+    PatchIndex::setPatch(r, *p.patch, p.block, p.lfoEnable, p.lfoFreq);
+    return r;
+}
+
+// ─── Round trip ──────────────────────────────────────────────────────────────
+static std::vector<uint8_t> buildLibrary()
+{
+    PatchIndex::Builder b;
+    for (int i = 0; i < kNumBuiltInPatches; ++i) {
+        const auto& p = kBuiltInPatches[i];
+        b.add(fileEntry(1000 + i, 100 + uint64_t(i), PatchIndex::Format::fui), record(p),
+              "lib/" + std::string(p.name) + ".fui", p.name);
+    }
+    b.addFailed(42, 7, "lib/readme.txt.fui");
+    b.addFailed(43, 0, "lib/empty.dmp");
+    check(b.size() == size_t(kNumBuiltInPatches), "builder entry count");
+    check(b.numFailed() == 2, "builder failed count");
+    return b.finish();
+}
+
+static void checkRoundTrip(const std::vector<uint8_t>& bytes)
+{
+    PatchIndex::View v;
+    check(v.open(bytes.data(), bytes.size()), "a freshly built index opens");
+    check(v.size() == size_t(kNumBuiltInPatches), "entry count survives");
+    check(v.numRecords() == size_t(kNumBuiltInPatches), "distinct built-ins keep their own records");
+
+    for (size_t i = 0; i < v.size() && i < size_t(kNumBuiltInPatches); ++i) {
+        const auto& p = kBuiltInPatches[i];
+        const auto& e = v.entry(i);
+        check(v.name(i) == p.name, "name survives");
+        check(v.path(i) == "lib/" + std::string(p.name) + ".fui", "path survives");
+        check(e.mtimeMs == int64_t(1000 + i) && e.fileSize == 100 + i, "file fields survive");
+        check(e.format == PatchIndex::Format::fui, "format survives");
+        check(samePatch(PatchIndex::getPatch(v.record(i)), *p.patch), "patch survives");
+        check(v.record(i).block == p.block, "octave offset survives");
+        check(PatchIndex::getImage(v.record(i)) == compilePatch(*p.patch, p.block, p.lfoFreq),
+              "register image survives");
+    }
+
+    check(v.numFailed() == 2, "failed count survives");
+    if (v.numFailed() == 2) {
+        check(v.failedPath(0) == "lib/readme.txt.fui" && v.failed(0).mtimeMs == 42
+              && v.failed(0).fileSize == 7, "first failed file survives");
+        check(v.failedPath(1) == "lib/empty.dmp" && v.failed(1).mtimeMs == 43
+              && v.failed(1).fileSize == 0, "second failed file survives");
+    }
+}
+
+// ─── Truncation and corruption ───────────────────────────────────────────────
+static void checkRejects(const std::vector<uint8_t>& bytes)
+{
+    bool anyOpened = false;
+    for (size_t n = 0; n < bytes.size(); ++n) {
+        const std::vector<uint8_t> prefix(bytes.begin(), bytes.begin() + std::ptrdiff_t(n));
+        PatchIndex::View v;
+        if (v.open(prefix.data(), prefix.size())) {
+            std::fprintf(stderr, "  %zu of %zu bytes opened\n", n, bytes.size());
+            anyOpened = true;
+            break;
+        }
+    }
+    check(!anyOpened, "every truncated index is rejected");
+
+    PatchIndex::Header h;
+    std::memcpy(&h, bytes.data(), sizeof(h));
+
+    auto corrupt = bytes;
+    PatchIndex::Entry e;
+    std::memcpy(&e, corrupt.data() + sizeof(h), sizeof(e));
+    e.nameOffset = uint32_t(h.stringsSize);
+    std::memcpy(corrupt.data() + sizeof(h), &e, sizeof(e));
+    PatchIndex::View v;
+    check(!v.open(corrupt.data(), corrupt.size()), "a name past the string table is rejected");
+
+    corrupt = bytes;
+    PatchIndex::Failed f;
+    std::memcpy(&f, corrupt.data() + h.failedOffset, sizeof(f));
+    f.pathLength = uint16_t(h.stringsSize);
+    std::memcpy(corrupt.data() + h.failedOffset, &f, sizeof(f));
+    check(!v.open(corrupt.data(), corrupt.size()), "a failed path past the string table is rejected");
+
+    corrupt = bytes;
+    h.version = PatchIndex::kVersion + 1;
+    std::memcpy(corrupt.data(), &h, sizeof(h));
+    check(!v.open(corrupt.data(), corrupt.size()), "another version is rejected");
+}
+
+// ─── Dedup ───────────────────────────────────────────────────────────────────
+static void checkDedup()
+{
+    // Algorithm 4: OP2 and OP4 are carriers, OP1 and OP3 modulate
+    YM2612Patch base = *kBuiltInPatches[0].patch;
+    base.ALG = 4;
+    base.op[0].TL = 127;
+    base.op[2].TL = 127;
+
+    YM2612Patch silentDiffers = base;                  // only silent modulators and OP1 FB change
+    silentDiffers.FB = (base.FB + 3) & 7;
+    silentDiffers.op[0].MUL = (base.op[0].MUL + 5) & 15;
+    silentDiffers.op[0].AR  = 3;
+    silentDiffers.op[2].DT  = base.op[2].DT == 2 ? -2 : 2;
+    silentDiffers.op[2].RR  = (base.op[2].RR + 1) & 15;
+
+    YM2612Patch lfoDepthOnly = base;                   // LFO off: AMS, FMS and AM are inaudible
+    lfoDepthOnly.AMS = (base.AMS + 1) & 3;
+    lfoDepthOnly.FMS = (base.FMS + 1) & 7;
+    lfoDepthOnly.op[1].AM = !base.op[1].AM;
+
+    YM2612Patch carrierDiffers = base;                 // a carrier level is audible
+    carrierDiffers.op[1].TL = (base.op[1].TL + 10) & 127;
+
+    auto canonical = [](const YM2612Patch& p, int lfoFreq) {
+        return PatchIndex::canonicalImage(compilePatch(p, 0, lfoFreq));
+    };
+    check(canonical(base, 0) == canonical(silentDiffers, 0), "silent modulators are canonicalised away");
+    check(canonical(base, 0) == canonical(lfoDepthOnly, 0), "LFO depths are canonicalised away with the LFO off");
+    check(!(canonical(base, 4) == canonical(lfoDepthOnly, 4)), "LFO depths count with the LFO on");
+    check(!(canonical(base, 0) == canonical(carrierDiffers, 0)), "carrier levels count");
+
+    auto rec = [](const YM2612Patch& p, int lfoEnable, int lfoFreq) {
+        PatchIndex::Record r {};
+        PatchIndex::setPatch(r, p, 0, lfoEnable, lfoFreq);
+        return r;
+    };
+
+    PatchIndex::Builder b;
+    b.add(fileEntry(1, 1, PatchIndex::Format::fui), rec(base, 0, 0),           "a.fui", "Base");
+    b.add(fileEntry(2, 2, PatchIndex::Format::dmp), rec(silentDiffers, 0, 0),  "b.dmp", "Renamed copy");
+    b.add(fileEntry(3, 3, PatchIndex::Format::tfi), rec(lfoDepthOnly, 0, 0),   "c.tfi", "LFO off copy");
+    b.add(fileEntry(4, 4, PatchIndex::Format::fui), rec(carrierDiffers, 0, 0), "d.fui", "Louder");
+    b.add(fileEntry(5, 5, PatchIndex::Format::fui), rec(lfoDepthOnly, 1, 4),   "e.fui", "LFO on");
+    check(b.size() == 5, "every file keeps its entry");
+    check(b.numRecords() == 3, "inaudible differences share one record");
+
+    const auto bytes = b.finish();
+    PatchIndex::View v;
+    check(v.open(bytes.data(), bytes.size()), "deduplicated index opens");
+    if (v.size() == 5) {
+        check(v.entry(0).record == v.entry(1).record && v.entry(0).record == v.entry(2).record,
+              "copies point at the same record");
+        check(v.entry(3).record != v.entry(0).record, "an audible difference gets its own record");
+        check(v.entry(4).record != v.entry(0).record && v.entry(4).record != v.entry(3).record,
+              "LFO on gets its own record");
+        check(v.name(1) == "Renamed copy" && v.path(2) == "c.tfi", "shared records keep per-entry names");
+    }
+}
+
+int main()
+{
+    const auto bytes = buildLibrary();
+    checkRoundTrip(bytes);
+    checkRejects(bytes);
+    checkDedup();
+
+    if (g_failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("PatchIndex: all checks pass (%zu-byte index, %d patches)\n", bytes.size(), kNumBuiltInPatches);
+    return 0;
+}
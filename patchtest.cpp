@@ -2,7 +2,7 @@
 #include <cmath>
 #include "ymfm.h"
 #include "ymfm_opn.h"
-#include "Source/BuiltInPatches.h"
+#include "Source/Core/BuiltInPatches.h"
 
 class YMInterface : public ymfm::ymfm_interface
 {